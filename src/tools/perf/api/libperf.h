@@ -41,6 +41,7 @@ typedef enum {
     UCX_PERF_CMD_TAG,
     UCX_PERF_CMD_TAG_SYNC,
     UCX_PERF_CMD_STREAM,
+    UCX_PERF_CMD_TAG_BATCH,
     UCX_PERF_CMD_LAST
 } ucx_perf_cmd_t;
 
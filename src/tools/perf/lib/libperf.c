@@ -391,6 +391,7 @@ static ucs_status_t ucx_perf_test_check_params(ucx_perf_params_t *params)
           (params->command != UCX_PERF_CMD_AM) &&
           (params->command != UCX_PERF_CMD_TAG) &&
           (params->command != UCX_PERF_CMD_TAG_SYNC) &&
+          (params->command != UCX_PERF_CMD_TAG_BATCH) &&
           (params->command != UCX_PERF_CMD_STREAM))) &&
         ucx_perf_get_message_size(params) < 1) {
         if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
@@ -941,6 +942,7 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
         break;
     case UCX_PERF_CMD_TAG:
     case UCX_PERF_CMD_TAG_SYNC:
+    case UCX_PERF_CMD_TAG_BATCH:
         ucp_params->features |= UCP_FEATURE_TAG;
         break;
     case UCX_PERF_CMD_STREAM:
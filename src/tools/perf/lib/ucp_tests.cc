@@ -14,6 +14,7 @@
 
 extern "C" {
 #include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/sys.h>
 }
@@ -34,10 +35,28 @@ public:
     ucp_perf_test_runner(ucx_perf_context_t &perf) :
         m_perf(perf),
         m_outstanding(0),
-        m_max_outstanding(m_perf.params.max_outstanding)
+        m_max_outstanding(m_perf.params.max_outstanding),
+        m_batch(NULL),
+        m_batch_reqs(NULL),
+        m_batch_count(0)
 
     {
         ucs_assert_always(m_max_outstanding > 0);
+
+        if (CMD == UCX_PERF_CMD_TAG_BATCH) {
+            m_batch      = (ucp_tag_batch_elem_t*)ucs_calloc(m_max_outstanding,
+                                                             sizeof(*m_batch),
+                                                             "perf_tag_batch");
+            m_batch_reqs = (ucs_status_ptr_t*)ucs_calloc(m_max_outstanding,
+                                                         sizeof(*m_batch_reqs),
+                                                         "perf_tag_batch_reqs");
+        }
+    }
+
+    ~ucp_perf_test_runner()
+    {
+        ucs_free(m_batch_reqs);
+        ucs_free(m_batch);
     }
 
     void create_iov_buffer(ucp_dt_iov_t *iov, void *buffer)
@@ -143,6 +162,18 @@ public:
         ucp_request_free(request);
     }
 
+    static void send_nbx_cb(void *request, ucs_status_t status, void *user_data)
+    {
+        send_cb(request, status);
+    }
+
+    static void tag_recv_nbx_cb(void *request, ucs_status_t status,
+                                const ucp_tag_recv_info_t *info,
+                                void *user_data)
+    {
+        tag_recv_cb(request, status, const_cast<ucp_tag_recv_info_t*>(info));
+    }
+
     void UCS_F_ALWAYS_INLINE wait_window(unsigned n, bool is_requestor)
     {
         while (m_outstanding >= (m_max_outstanding - n + 1)) {
@@ -190,6 +221,8 @@ public:
             reinterpret_cast<ucp_perf_request_t*>(request)->context = this;
             op_started();
             return UCS_OK;
+        case UCX_PERF_CMD_TAG_BATCH:
+            return batch_add(ep, buffer, length, datatype, true);
         case UCX_PERF_CMD_PUT:
             *((uint8_t*)buffer + length - 1) = sn;
             return ucp_put(ep, buffer, length, remote_addr, rkey);
@@ -263,6 +296,8 @@ public:
             reinterpret_cast<ucp_perf_request_t*>(request)->context = this;
             op_started();
             return UCS_OK;
+        case UCX_PERF_CMD_TAG_BATCH:
+            return batch_add(ep, buffer, length, datatype, false);
         case UCX_PERF_CMD_PUT:
             /* coverity[switch_selector_expr_is_constant] */
             switch (TYPE) {
@@ -423,6 +458,7 @@ public:
                 ucx_perf_update(&m_perf, 1, length);
                 ++sn;
             }
+            batch_post(recv_datatype, false);
         } else if (my_index == 1) {
             UCX_PERF_TEST_FOREACH(&m_perf) {
                 send(ep, send_buffer, send_length, send_datatype, sn,
@@ -430,6 +466,7 @@ public:
                 ucx_perf_update(&m_perf, 1, length);
                 ++sn;
             }
+            batch_post(send_datatype, true);
         }
 
         wait_window(m_max_outstanding, true);
@@ -445,6 +482,11 @@ public:
 
     ucs_status_t run()
     {
+        if ((CMD == UCX_PERF_CMD_TAG_BATCH) &&
+            ((m_batch == NULL) || (m_batch_reqs == NULL))) {
+            return UCS_ERR_NO_MEMORY;
+        }
+
         /* coverity[switch_selector_expr_is_constant] */
         switch (TYPE) {
         case UCX_PERF_TEST_TYPE_PINGPONG:
@@ -506,6 +548,80 @@ private:
         return UCS_OK;
     }
 
+    ucs_status_t UCS_F_ALWAYS_INLINE
+    batch_add(ucp_ep_h ep, void *buffer, unsigned length,
+              ucp_datatype_t datatype, bool is_send)
+    {
+        ucp_tag_batch_elem_t *elem = &m_batch[m_batch_count];
+
+        elem->ep       = ep;
+        elem->buffer   = buffer;
+        elem->count    = length;
+        elem->tag      = TAG;
+        elem->tag_mask = TAG_MASK;
+
+        if (++m_batch_count < m_max_outstanding) {
+            return UCS_OK;
+        }
+
+        return batch_post(datatype, is_send);
+    }
+
+    ucs_status_t batch_post(ucp_datatype_t datatype, bool is_send)
+    {
+        ucp_request_param_t param;
+        ucs_status_t status;
+        void *request;
+        unsigned i;
+
+        if ((CMD != UCX_PERF_CMD_TAG_BATCH) || (m_batch_count == 0)) {
+            return UCS_OK;
+        }
+
+        wait_window(m_batch_count, is_send);
+
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_DATATYPE |
+                             UCP_OP_ATTR_FIELD_CALLBACK;
+        param.datatype     = datatype;
+        if (is_send) {
+            param.cb.send = send_nbx_cb;
+            status        = ucp_tag_send_nbx_batch(m_perf.ucp.worker,
+                                                   m_batch, m_batch_count,
+                                                   &param, m_batch_reqs);
+        } else {
+            param.cb.recv = tag_recv_nbx_cb;
+            status        = ucp_tag_recv_nbx_batch(m_perf.ucp.worker,
+                                                   m_batch, m_batch_count,
+                                                   &param, m_batch_reqs);
+        }
+
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        for (i = 0; i < m_batch_count; ++i) {
+            request = m_batch_reqs[i];
+            if (ucs_likely(!UCS_PTR_IS_PTR(request))) {
+                if (UCS_PTR_IS_ERR(request)) {
+                    status = UCS_PTR_STATUS(request);
+                }
+                continue;
+            }
+
+            if (!is_send && ucp_request_is_completed(request)) {
+                /* request is already completed and callback was called */
+                ucp_request_free(request);
+                continue;
+            }
+
+            reinterpret_cast<ucp_perf_request_t*>(request)->context = this;
+            op_started();
+        }
+
+        m_batch_count = 0;
+        return status;
+    }
+
     void UCS_F_ALWAYS_INLINE op_started()
     {
         ++m_outstanding;
@@ -516,9 +632,12 @@ private:
         --m_outstanding;
     }
 
-    ucx_perf_context_t &m_perf;
-    unsigned           m_outstanding;
-    const unsigned     m_max_outstanding;
+    ucx_perf_context_t                &m_perf;
+    unsigned                          m_outstanding;
+    const unsigned                    m_max_outstanding;
+    ucp_tag_batch_elem_t              *m_batch;
+    ucs_status_ptr_t                  *m_batch_reqs;
+    unsigned                          m_batch_count;
 };
 
 
@@ -575,7 +694,8 @@ ucs_status_t ucp_perf_test_dispatch(ucx_perf_context_t *perf)
         (UCX_PERF_CMD_TAG,      UCX_PERF_TEST_TYPE_PINGPONG),
         (UCX_PERF_CMD_TAG,      UCX_PERF_TEST_TYPE_STREAM_UNI),
         (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_PINGPONG),
-        (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI)
+        (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI),
+        (UCX_PERF_CMD_TAG_BATCH, UCX_PERF_TEST_TYPE_STREAM_UNI)
         );
 
     UCS_PP_FOREACH(TEST_CASE_ALL_STREAM, perf,
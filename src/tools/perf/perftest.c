@@ -135,6 +135,9 @@ test_type_t tests[] = {
     {"tag_sync_bw", UCX_PERF_API_UCP, UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI,
      "tag sync match bandwidth", "overhead", 32},
 
+    {"tag_batch_bw", UCX_PERF_API_UCP, UCX_PERF_CMD_TAG_BATCH, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "tag match bandwidth with batched post (batch size = window)", "overhead", 32},
+
     {"ucp_put_lat", UCX_PERF_API_UCP, UCX_PERF_CMD_PUT, UCX_PERF_TEST_TYPE_PINGPONG,
      "put latency", "latency", 1},
 
@@ -15,6 +15,7 @@
 #include <ucs/type/thread_mode.h>
 #include <ucs/type/cpu_set.h>
 #include <ucs/config/types.h>
+#include <ucs/memory/memory_type.h>
 #include <ucs/sys/compiler_def.h>
 #include <stdio.h>
 #include <sys/types.h>
@@ -431,13 +432,15 @@ enum {
  * @ingroup UCP_WORKER
  * @brief Flags for a UCP Active Message callback.
  *
- * Flags that indicate how to handle UCP Active Messages
- * Currently only UCP_AM_FLAG_WHOLE_MSG is supported,
- * which indicates the entire message is handled in one
- * callback.
+ * Flags that indicate how to handle UCP Active Messages.
+ * UCP_AM_FLAG_WHOLE_MSG indicates the entire message is handled in one
+ * callback. UCP_AM_FLAG_RNDV indicates the callback accepts messages sent
+ * with the rendezvous protocol, and receives their payload by
+ * @ref ucp_am_recv_data_nb.
  */
 enum ucp_am_cb_flags {
-    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0)
+    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0),
+    UCP_AM_FLAG_RNDV      = UCS_BIT(1)
 };
 
 
@@ -464,9 +467,49 @@ enum ucp_send_am_flags {
  * returned from the callback, the data parameter will persist 
  * and the user has to call @ref ucp_am_data_release when data is
  * no longer needed.
+ * If UCP_CB_PARAM_FLAG_RNDV is set, the payload has not arrived yet, and
+ * data is a descriptor which should be passed to @ref ucp_am_recv_data_nb
+ * in order to receive the payload, or to @ref ucp_am_data_release in order
+ * to drop it.
  */
 enum ucp_cb_param_flags {
-    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0)
+    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0),
+    UCP_CB_PARAM_FLAG_RNDV = UCS_BIT(1)
+};
+
+
+/**
+ * @ingroup UCP_WORKER
+ * @brief UCP AM receive data parameter fields and flags.
+ *
+ * The enumeration allows specifying which fields in @ref ucp_am_recv_param_t
+ * are present and the properties of the received data.
+ */
+typedef enum {
+    UCP_AM_RECV_ATTR_FIELD_REPLY_EP = UCS_BIT(0),  /**< reply_ep field */
+
+    UCP_AM_RECV_ATTR_FLAG_DATA      = UCS_BIT(16), /**< The data may persist
+                                                        after the callback
+                                                        returns, see
+                                                        @ref ucp_am_recv_callback_t */
+    UCP_AM_RECV_ATTR_FLAG_RNDV      = UCS_BIT(17)  /**< The data is a rendezvous
+                                                        descriptor, see
+                                                        @ref ucp_am_recv_data_nbx */
+} ucp_am_recv_attr_t;
+
+
+/**
+ * @ingroup UCP_WORKER
+ * @brief UCP AM handler parameters field mask.
+ *
+ * The enumeration allows specifying which fields in
+ * @ref ucp_am_handler_param_t are present.
+ */
+enum ucp_am_handler_param_field {
+    UCP_AM_HANDLER_PARAM_FIELD_ID    = UCS_BIT(0), /**< id field */
+    UCP_AM_HANDLER_PARAM_FIELD_FLAGS = UCS_BIT(1), /**< flags field */
+    UCP_AM_HANDLER_PARAM_FIELD_CB    = UCS_BIT(2), /**< cb field */
+    UCP_AM_HANDLER_PARAM_FIELD_ARG   = UCS_BIT(3)  /**< arg field */
 };
 
 
@@ -506,6 +549,25 @@ typedef enum {
 } ucp_atomic_fetch_op_t;
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Atomic operation requested for ucp_atomic_op_nbx
+ *
+ * This enumeration defines which atomic memory operation should be
+ * performed by the @ref ucp_atomic_op_nbx routine. The operation fetches the
+ * previous remote value if a reply buffer is passed.
+ */
+typedef enum {
+    UCP_ATOMIC_OP_ADD,   /**< Atomic add                       */
+    UCP_ATOMIC_OP_SWAP,  /**< Atomic swap                      */
+    UCP_ATOMIC_OP_CSWAP, /**< Atomic conditional swap          */
+    UCP_ATOMIC_OP_AND,   /**< Atomic and                       */
+    UCP_ATOMIC_OP_OR,    /**< Atomic or                        */
+    UCP_ATOMIC_OP_XOR,   /**< Atomic xor                       */
+    UCP_ATOMIC_OP_LAST
+} ucp_atomic_op_t;
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Flags to define behavior of @ref ucp_stream_recv_nb function
@@ -522,6 +584,24 @@ typedef enum {
 } ucp_stream_recv_flags_t;
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Flags to define behavior of @ref ucp_stream_worker_poll function
+ *
+ * This enumeration defines behavior of @ref ucp_stream_worker_poll function.
+ */
+typedef enum {
+    UCP_STREAM_POLL_FLAG_EDGE_TRIGGERED = UCS_BIT(0) /**< Report an endpoint
+                                                          only once after it
+                                                          becomes ready. The
+                                                          endpoint is not
+                                                          reported again until
+                                                          all its data is
+                                                          consumed and new data
+                                                          arrives. */
+} ucp_stream_poll_flags_t;
+
+
 /**
  * @ingroup UCP_COMM
  * @brief UCP operation fields and flags
@@ -536,6 +616,9 @@ typedef enum {
     UCP_OP_ATTR_FIELD_USER_DATA     = UCS_BIT(2),  /**< user_data field */
     UCP_OP_ATTR_FIELD_DATATYPE      = UCS_BIT(3),  /**< datatype field */
     UCP_OP_ATTR_FIELD_FLAGS         = UCS_BIT(4),  /**< operation-specific flags */
+    UCP_OP_ATTR_FIELD_MEMORY_TYPE   = UCS_BIT(5),  /**< memory type field */
+    UCP_OP_ATTR_FIELD_RECV_INFO     = UCS_BIT(6),  /**< recv_info field */
+    UCP_OP_ATTR_FIELD_REPLY_BUFFER  = UCS_BIT(7),  /**< reply_buffer field */
 
     UCP_OP_ATTR_FLAG_NO_IMM_CMPL    = UCS_BIT(16), /**< deny immediate completion */
     UCP_OP_ATTR_FLAG_FAST_CMPL      = UCS_BIT(17), /**< expedite local completion,
@@ -611,6 +694,41 @@ typedef struct ucp_dt_iov {
 } ucp_dt_iov_t;
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Block of an indexed remote memory access.
+ *
+ * This structure describes one block of a non-contiguous remote memory access
+ * posted by @ref ucp_put_iov_nbi or @ref ucp_get_iov_nbi.
+ */
+typedef struct ucp_rma_iov {
+    void     *buffer;      /**< Local address of the block */
+    size_t   length;       /**< Length of the block in bytes */
+    uint64_t remote_addr;  /**< Remote address of the block */
+} ucp_rma_iov_t;
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Atomic operation of a vector posted by @ref ucp_atomic_vec_nb.
+ *
+ * This structure describes one atomic operation on a remote value.
+ */
+typedef struct ucp_atomic_vec_op {
+    ucp_atomic_fetch_op_t opcode;      /**< One of @ref ucp_atomic_fetch_op_t */
+    uint64_t              value;       /**< Source operand. In the case of
+                                            CSWAP this is the conditional for
+                                            the swap. */
+    uint64_t              remote_addr; /**< Remote address to operate on */
+    void                  *result;     /**< Local address to store the fetched
+                                            value to. In the case of CSWAP it
+                                            holds the value to swap in. NULL
+                                            means the result is not needed,
+                                            which is allowed for FADD, FAND,
+                                            FOR and FXOR only. */
+} ucp_atomic_vec_op_t;
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief UCP generic data type descriptor
@@ -1215,6 +1333,62 @@ struct ucp_tag_recv_info {
 };
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief Operation parameters provided in @ref ucp_am_recv_callback_t callback.
+ */
+struct ucp_am_recv_param {
+    /**
+     * Mask of valid fields in this structure and receive operation flags,
+     * using bits from @ref ucp_am_recv_attr_t. Fields not specified in this
+     * mask should be ignored.
+     */
+    uint64_t                               recv_attr;
+
+    /**
+     * Endpoint which can be used for the reply to this message.
+     */
+    ucp_ep_h                               reply_ep;
+};
+
+
+/**
+ * @ingroup UCP_WORKER
+ * @brief Active Message handler parameters passed to
+ *        @ref ucp_worker_set_am_recv_handler routine.
+ */
+typedef struct ucp_am_handler_param {
+    /**
+     * Mask of valid fields in this structure, using bits from
+     * @ref ucp_am_handler_param_field. Fields not specified in this mask will
+     * be ignored. Provides ABI compatibility with respect to adding new fields.
+     */
+    uint64_t                               field_mask;
+
+    /**
+     * Active Message id.
+     */
+    unsigned                               id;
+
+    /**
+     * Handler flags as defined by @ref ucp_am_cb_flags.
+     */
+    uint32_t                               flags;
+
+    /**
+     * Active Message callback. To clear the already set callback, this value
+     * should be set to NULL.
+     */
+    ucp_am_recv_callback_t                 cb;
+
+    /**
+     * Active Message argument, which will be passed in to every invocation of
+     * the callback as the arg argument.
+     */
+    void                                   *arg;
+} ucp_am_handler_param_t;
+
+
 /**
  * @ingroup UCP_CONTEXT
  * @brief Operation parameters passed to @ref ucp_tag_send_nbx.
@@ -1277,8 +1451,9 @@ typedef struct {
      * send or receive operation is completed.
      */
     union {
-        ucp_send_nbx_callback_t     send;
-        ucp_tag_recv_nbx_callback_t recv;
+        ucp_send_nbx_callback_t         send;
+        ucp_tag_recv_nbx_callback_t     recv;
+        ucp_am_recv_data_nbx_callback_t recv_am;
     }              cb;
 
     /**
@@ -1307,9 +1482,61 @@ typedef struct {
                                           Relevant for @a ucp_tag_recv_nbx
                                           function. */
     } recv_info;
+
+    /**
+     * Memory type of the buffer, see @ref ucs_memory_type_t for possible
+     * memory types. An optimization hint to avoid memory type detection
+     * for the buffer. Used if op_attr_mask & UCP_OP_ATTR_FIELD_MEMORY_TYPE.
+     */
+    ucs_memory_type_t memory_type;
+
+    /**
+     * Reply buffer of an atomic operation, which receives the previous remote
+     * value. Used if op_attr_mask & UCP_OP_ATTR_FIELD_REPLY_BUFFER.
+     */
+    void              *reply_buffer;
 } ucp_request_param_t;
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Tagged operation descriptor for batched post routines.
+ *
+ * The structure describes a single element of the array passed to
+ * @ref ucp_tag_send_nbx_batch or @ref ucp_tag_recv_nbx_batch. Parameters which
+ * are common to all elements of the batch (datatype, callback, user data and
+ * operation flags) are passed once in @ref ucp_request_param_t.
+ */
+typedef struct ucp_tag_batch_elem {
+    /**
+     * Destination endpoint. Relevant for @ref ucp_tag_send_nbx_batch only,
+     * ignored by @ref ucp_tag_recv_nbx_batch.
+     */
+    ucp_ep_h       ep;
+
+    /**
+     * Pointer to the message buffer.
+     */
+    void           *buffer;
+
+    /**
+     * Number of elements to send or receive.
+     */
+    size_t         count;
+
+    /**
+     * Message tag to send, or tag to expect for receive.
+     */
+    ucp_tag_t      tag;
+
+    /**
+     * Bit mask of the tag bits used for matching. Relevant for
+     * @ref ucp_tag_recv_nbx_batch only, ignored by @ref ucp_tag_send_nbx_batch.
+     */
+    ucp_tag_t      tag_mask;
+} ucp_tag_batch_elem_t;
+
+
 /**
  * @ingroup UCP_CONFIG
  * @brief Read UCP configuration descriptor
@@ -1674,12 +1901,22 @@ unsigned ucp_worker_progress(ucp_worker_h worker);
  *                         allocated by user.
  * @param [in]   max_eps   Maximal number of endpoints which should be filled
  *                         in @a poll_eps.
- * @param [in]   flags     Reserved for future use.
+ * @param [in]   flags     Flags defined in @ref ucp_stream_poll_flags_t.
  *
  * @return Negative value indicates an error according to @ref ucs_status_t.
  *         On success, non-negative value (less or equal @a max_eps) indicates
  *         actual number of endpoints filled in @a poll_eps array.
  *
+ * @note An endpoint is reported once no matter how many messages arrived on it
+ *       since the previous call. By default, an endpoint which still has data
+ *       is reported again when more data arrives. With
+ *       @ref UCP_STREAM_POLL_FLAG_EDGE_TRIGGERED it is reported again only
+ *       after the application consumed all its data, e.g. by calling
+ *       @ref ucp_stream_recv_data_nb until it returns NULL.
+ * @note If the worker was created with @ref UCP_FEATURE_WAKEUP,
+ *       @ref ucp_worker_arm returns UCS_ERR_BUSY while there are endpoints to
+ *       report, so the event file descriptor returned by
+ *       @ref ucp_worker_get_efd can be used to wait for ready endpoints.
  */
 ssize_t ucp_stream_worker_poll(ucp_worker_h worker,
                                ucp_stream_poll_ep_t *poll_eps, size_t max_eps,
@@ -2459,10 +2696,14 @@ void ucp_rkey_destroy(ucp_rkey_h rkey);
  *                          in to every invocation of the callback as the
  *                          arg argument.
  * @param [in]  flags       Dictates how an Active Message is handled on the
- *                          remote endpoint. Currently only
- *                          UCP_AM_FLAG_WHOLE_MSG is supported, which
+ *                          remote endpoint. UCP_AM_FLAG_WHOLE_MSG
  *                          indicates the callback will not be invoked
- *                          until all data has arrived.
+ *                          until all data has arrived. UCP_AM_FLAG_RNDV
+ *                          indicates that large messages, which are sent
+ *                          with the rendezvous protocol, are passed to the
+ *                          callback before their payload is transferred.
+ *                          Without this flag, UCP receives such messages to
+ *                          an internal buffer before invoking the callback.
  *
  * @return error code if the worker does not support Active Messages or
  *         requested callback flags.
@@ -2472,6 +2713,30 @@ ucs_status_t ucp_worker_set_am_handler(ucp_worker_h worker, uint16_t id,
                                        uint32_t flags);
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief Add user defined callback for Active Message with a user header.
+ *
+ * This routine installs a user defined callback to handle incoming Active
+ * Messages with a specific id. The callback is called whenever an Active
+ * Message that was sent from the remote peer by @ref ucp_am_send_nbx (or
+ * @ref ucp_am_send_nb, in which case the user header is empty) is received on
+ * this worker. Messages sent with the rendezvous protocol are always passed
+ * to the callback before their payload is transferred, with the
+ * UCP_AM_RECV_ATTR_FLAG_RNDV flag.
+ *
+ * @param [in]  worker      UCP worker on which to set the Active Message
+ *                          handler.
+ * @param [in]  param       Active Message handler parameters, as defined by
+ *                          @ref ucp_am_handler_param_t.
+ *
+ * @return error code if the worker does not support Active Messages or
+ *         requested callback flags.
+ */
+ucs_status_t ucp_worker_set_am_recv_handler(ucp_worker_h worker,
+                                            const ucp_am_handler_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Send Active Message.
@@ -2501,6 +2766,43 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
                                 ucp_send_callback_t cb, unsigned flags);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Send Active Message with a user header.
+ *
+ * This routine sends an Active Message to an ep. The user header is sent
+ * inline, along with the UCP protocol header, while the payload may be sent
+ * with zero-copy or rendezvous protocols, depending on its size. The header
+ * is passed to the receiver callback separately from the payload, so neither
+ * side has to stage the header and the payload into a single buffer.
+ *
+ * @param [in]  ep            UCP endpoint where the Active Message will be
+ *                            run.
+ * @param [in]  id            Active Message id. Specifies which registered
+ *                            callback to run.
+ * @param [in]  header        User defined Active Message header. NULL value
+ *                            is allowed if no header needed. The header must
+ *                            remain valid until the operation completes, and
+ *                            it must fit into a single network packet.
+ * @param [in]  header_length Active message header length in bytes.
+ * @param [in]  buffer        Pointer to the data to be sent to the target
+ *                            node of the Active Message.
+ * @param [in]  count         Number of elements to send.
+ * @param [in]  param         Operation parameters, see @ref
+ *                            ucp_request_param_t. UCP_AM_SEND_REPLY flag
+ *                            can be passed in @a param->flags.
+ *
+ * @return NULL                 Active Message was sent immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) Error sending Active Message.
+ * @return otherwise            Pointer to request, and Active Message is known
+ *                              to be completed after the callback is run.
+ */
+ucs_status_ptr_t ucp_am_send_nbx(ucp_ep_h ep, unsigned id,
+                                 const void *header, size_t header_length,
+                                 const void *buffer, size_t count,
+                                 const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Releases Active Message data.
@@ -2512,10 +2814,83 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
  * @param [in] data         Pointer to data that was passed into
  *                          the Active Message callback as the data
  *                          parameter.
+ *
+ * @note If the data is a rendezvous descriptor, the payload is dropped and
+ *       the sender is notified that the message was consumed.
  */
 void ucp_am_data_release(ucp_worker_h worker, void *data);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Receive the payload of a rendezvous Active Message.
+ *
+ * This routine receives the payload of an Active Message which was passed to
+ * the Active Message callback with the UCP_CB_PARAM_FLAG_RNDV flag. The data
+ * is fetched directly to the user buffer, using the same zero-copy protocols
+ * as tag-matched rendezvous. The routine may be called from the Active Message
+ * callback, or later, if the callback returned UCS_INPROGRESS. In any case,
+ * the descriptor is consumed by this routine and must not be used afterwards.
+ *
+ * @param [in]  worker      Worker which received the Active Message.
+ * @param [in]  data_desc   Data descriptor that was passed into the Active
+ *                          Message callback as the data parameter.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive into @a buffer.
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  cb          Callback that is invoked when the data is
+ *                          received, if the operation is not completed
+ *                          immediately.
+ *
+ * @return NULL             Data was received immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) Error receiving the data. If the status is
+ *                          UCS_ERR_MESSAGE_TRUNCATED, the descriptor was
+ *                          consumed and no data was received.
+ * @return otherwise        Pointer to request, which should be released by
+ *                          @ref ucp_request_free after it is completed.
+ */
+ucs_status_ptr_t ucp_am_recv_data_nb(ucp_worker_h worker, void *data_desc,
+                                     void *buffer, size_t count,
+                                     ucp_datatype_t datatype,
+                                     ucp_am_recv_data_callback_t cb);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Receive the data of an Active Message to a user buffer.
+ *
+ * This routine places the payload of an Active Message, which was passed to
+ * the @ref ucp_am_recv_callback_t callback, to the user buffer. If the
+ * callback got a rendezvous descriptor (UCP_AM_RECV_ATTR_FLAG_RNDV), the data
+ * is fetched directly to the user buffer, as by @ref ucp_am_recv_data_nb.
+ * Otherwise, the data which persists in a UCP descriptor
+ * (UCP_AM_RECV_ATTR_FLAG_DATA) is unpacked to the buffer and the operation
+ * completes immediately. In any case, the descriptor is consumed by this
+ * routine and must not be used afterwards.
+ *
+ * @param [in]  worker      Worker which received the Active Message.
+ * @param [in]  data_desc   Data descriptor that was passed into the Active
+ *                          Message callback as the data parameter.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive into @a buffer.
+ * @param [in]  param       Operation parameters, see @ref ucp_request_param_t.
+ *                          The completion callback is @a param->cb.recv_am.
+ *                          If the operation completes immediately and
+ *                          UCP_OP_ATTR_FIELD_RECV_INFO is set, the length of
+ *                          the received data is stored to
+ *                          @a param->recv_info.length.
+ *
+ * @return NULL                 Data was received immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) Error receiving the data. The descriptor is
+ *                              consumed in this case as well.
+ * @return otherwise            Pointer to request, which should be released by
+ *                              @ref ucp_request_free after it is completed.
+ */
+ucs_status_ptr_t ucp_am_recv_data_nbx(ucp_worker_h worker, void *data_desc,
+                                      void *buffer, size_t count,
+                                      const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking stream send operation.
@@ -2799,6 +3174,75 @@ ucs_status_ptr_t ucp_tag_send_sync_nbx(ucp_ep_h ep, const void *buffer,
                                        const ucp_request_param_t *param);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Post a batch of non-blocking tagged-send operations.
+ *
+ * This routine posts @a num_elems tagged sends described by the @a elems
+ * array, as if @ref ucp_tag_send_nbx was called for every element with the
+ * same @a param. The worker lock is taken once for the whole batch, which
+ * reduces the per-message overhead when many small messages are posted at
+ * once (for example, in a halo exchange). The status of every operation is
+ * returned in the matching entry of @a requests, with the same semantics as
+ * the return value of @ref ucp_tag_send_nbx.
+ *
+ * @note All endpoints in @a elems must belong to @a worker.
+ * @note @ref UCP_OP_ATTR_FIELD_REQUEST is not supported, since a single user
+ *       request cannot be shared by several operations.
+ *
+ * @param [in]  worker      UCP worker the endpoints belong to.
+ * @param [in]  elems       Array of send descriptors.
+ * @param [in]  num_elems   Number of elements in @a elems.
+ * @param [in]  param       Operation parameters, common to all the elements,
+ *                          see @ref ucp_request_param_t.
+ * @param [out] requests    Array of @a num_elems entries, filled with the
+ *                          status or request handle of every send.
+ *
+ * @return UCS_OK if the batch was posted (individual sends may still fail and
+ *         report an error in @a requests), or an error if the parameters are
+ *         invalid, in which case nothing is posted.
+ */
+ucs_status_t ucp_tag_send_nbx_batch(ucp_worker_h worker,
+                                    const ucp_tag_batch_elem_t *elems,
+                                    size_t num_elems,
+                                    const ucp_request_param_t *param,
+                                    ucs_status_ptr_t *requests);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Create a persistent tagged-send request.
+ *
+ * This routine creates an inactive send request, similar to MPI_Send_init,
+ * which sends the same @a buffer with the same @a tag to @a ep every time it
+ * is started by @ref ucp_request_start. The datatype setup, memory type
+ * detection and protocol thresholds are resolved once, here, and the
+ * registration of a contiguous buffer is kept between starts, which lowers
+ * the per-message overhead of codes which repeat the same communication
+ * pattern every iteration. The thresholds are updated automatically if the
+ * endpoint is reconfigured.
+ *
+ * The send callback, if set in @a param, is invoked only when a started
+ * operation does not complete immediately. The request must be released by
+ * @ref ucp_request_free "ucp_request_free()" when it is no longer needed.
+ *
+ * @note @ref UCP_OP_ATTR_FIELD_REQUEST is not supported, and generic datatypes
+ *       are not supported since their pack state cannot be reused.
+ *
+ * @param [in]  ep          Destination endpoint handle.
+ * @param [in]  buffer      Pointer to the message buffer (payload).
+ * @param [in]  count       Number of elements to send.
+ * @param [in]  tag         Message tag.
+ * @param [in]  param       Operation parameters, see @ref ucp_request_param_t.
+ *
+ * @return UCS_PTR_IS_ERR(_ptr) - The request could not be created.
+ * @return otherwise            - Persistent request handle.
+ */
+ucs_status_ptr_t ucp_tag_send_init_nbx(ucp_ep_h ep, const void *buffer,
+                                       size_t count, ucp_tag_t tag,
+                                       const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking stream receive operation of structured data into a
@@ -2881,6 +3325,30 @@ ucs_status_ptr_t ucp_stream_recv_nb(ucp_ep_h ep, void *buffer, size_t count,
 ucs_status_ptr_t ucp_stream_recv_data_nb(ucp_ep_h ep, size_t *length);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking stream receive of multiple UCP-supplied data buffers.
+ *
+ * This routine is equivalent to calling @ref ucp_stream_recv_data_nb up to
+ * @a max_iov times, and returns all data buffers which are immediately
+ * available on endpoint @a ep in one call. Each returned buffer must be
+ * released by @ref ucp_stream_data_release.
+ *
+ * @param [in]   ep       UCP endpoint that is used for the receive operation.
+ * @param [out]  iov      Array of at least @a max_iov elements, which is
+ *                        filled with the pointers to the received data and
+ *                        their lengths, in the order of arrival.
+ * @param [in]   max_iov  Maximal number of data buffers to return.
+ *
+ * @return Negative value indicates an error according to @ref ucs_status_t.
+ *         On success, non-negative value (less or equal @a max_iov) indicates
+ *         the number of data buffers filled in @a iov, zero if no data is
+ *         available on the @a ep.
+ */
+ssize_t ucp_stream_recv_data_nb_batch(ucp_ep_h ep, ucp_dt_iov_t *iov,
+                                      size_t max_iov);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking tagged-receive operation.
@@ -2998,6 +3466,72 @@ ucs_status_ptr_t ucp_tag_recv_nbx(ucp_worker_h worker, void *buffer, size_t coun
                                   const ucp_request_param_t *param);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Post a batch of non-blocking tagged-receive operations.
+ *
+ * This routine posts @a num_elems tagged receives described by the @a elems
+ * array, as if @ref ucp_tag_recv_nbx was called for every element with the
+ * same @a param. The worker lock is taken once for the whole batch. The
+ * request handle (or error) of every receive is returned in the matching
+ * entry of @a requests; the application is responsible for releasing each
+ * handle using @ref ucp_request_free "ucp_request_free()".
+ *
+ * @note @ref UCP_OP_ATTR_FIELD_REQUEST is not supported, since a single user
+ *       request cannot be shared by several operations.
+ *
+ * @param [in]  worker      UCP worker that is used for the receive operations.
+ * @param [in]  elems       Array of receive descriptors, the @a ep field is
+ *                          ignored.
+ * @param [in]  num_elems   Number of elements in @a elems.
+ * @param [in]  param       Operation parameters, common to all the elements,
+ *                          see @ref ucp_request_param_t.
+ * @param [out] requests    Array of @a num_elems entries, filled with the
+ *                          request handle or error of every receive.
+ *
+ * @return UCS_OK if the batch was posted, or an error if the parameters are
+ *         invalid, in which case nothing is posted.
+ */
+ucs_status_t ucp_tag_recv_nbx_batch(ucp_worker_h worker,
+                                    const ucp_tag_batch_elem_t *elems,
+                                    size_t num_elems,
+                                    const ucp_request_param_t *param,
+                                    ucs_status_ptr_t *requests);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Create a persistent tagged-receive request.
+ *
+ * This routine creates an inactive receive request, similar to MPI_Recv_init,
+ * which receives a message matching @a tag and @a tag_mask into @a buffer
+ * every time it is started by @ref ucp_request_start. The memory type of a
+ * contiguous buffer is detected once, here.
+ *
+ * The receive callback, if set in @a param, is invoked only when a started
+ * operation does not complete immediately. The request must be released by
+ * @ref ucp_request_free "ucp_request_free()" when it is no longer needed.
+ *
+ * @note @ref UCP_OP_ATTR_FIELD_REQUEST is not supported.
+ *
+ * @param [in]  worker      UCP worker that is used for the receive operation.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive.
+ * @param [in]  tag         Message tag to expect.
+ * @param [in]  tag_mask    Bit mask that indicates the bits that are used for
+ *                          the matching of the incoming tag
+ *                          against the expected tag.
+ * @param [in]  param       Operation parameters, see @ref ucp_request_param_t.
+ *
+ * @return UCS_PTR_IS_ERR(_ptr) - The request could not be created.
+ * @return otherwise            - Persistent request handle.
+ */
+ucs_status_ptr_t ucp_tag_recv_init_nbx(ucp_worker_h worker, void *buffer,
+                                       size_t count, ucp_tag_t tag,
+                                       ucp_tag_t tag_mask,
+                                       const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking probe and return a message.
@@ -3328,6 +3862,124 @@ ucs_status_ptr_t ucp_get_nbx(ucp_ep_h ep, void *buffer, size_t length,
                              const ucp_request_param_t *param);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking implicit strided remote memory put operation.
+ *
+ * This routine initiates a storage of @a count blocks of @a block_size bytes
+ * each. Block @e i is read from the local address
+ * @a buffer + @e i * @a stride and is written to the remote address
+ * @a remote_addr + @e i * @a remote_stride, in the memory region described by
+ * the @ref ucp_rkey_h "memory handle" @a rkey. The routine returns
+ * immediately and @b does @b not guarantee re-usability of the source
+ * buffers.
+ *
+ * Blocks which are adjacent in the remote memory are combined to a single
+ * transport operation, by gathering them from the local memory to a bounce
+ * buffer or to an I/O vector, so the call is much cheaper than a separate
+ * @ref ucp_put_nbi for every block.
+ *
+ * @note A user can use @ref ucp_worker_flush_nb "ucp_worker_flush_nb()"
+ * in order to guarantee re-usability of the source buffers.
+ *
+ * @param [in]  ep             Remote endpoint handle.
+ * @param [in]  buffer         Local address of the first block.
+ * @param [in]  stride         Distance between the local blocks, in bytes.
+ * @param [in]  remote_addr    Remote address of the first block.
+ * @param [in]  remote_stride  Distance between the remote blocks, in bytes.
+ * @param [in]  block_size     Size of every block, in bytes.
+ * @param [in]  count          Number of blocks.
+ * @param [in]  rkey           Remote memory key associated with the remote
+ *                             memory addresses.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_put_strided_nbi(ucp_ep_h ep, const void *buffer,
+                                 ptrdiff_t stride, uint64_t remote_addr,
+                                 ptrdiff_t remote_stride, size_t block_size,
+                                 size_t count, ucp_rkey_h rkey);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking implicit strided remote memory get operation.
+ *
+ * This routine initiates a load of @a count blocks of @a block_size bytes
+ * each. Block @e i is read from the remote address
+ * @a remote_addr + @e i * @a remote_stride, in the memory region described by
+ * the @ref ucp_rkey_h "memory handle" @a rkey, and is stored to the local
+ * address @a buffer + @e i * @a stride. The routine returns immediately and
+ * @b does @b not guarantee that remote data is loaded and stored under the
+ * local addresses.
+ *
+ * @note A user can use @ref ucp_worker_flush_nb "ucp_worker_flush_nb()" in
+ * order to guarantee that remote data is loaded and stored under the local
+ * addresses.
+ *
+ * @param [in]  ep             Remote endpoint handle.
+ * @param [in]  buffer         Local address of the first block.
+ * @param [in]  stride         Distance between the local blocks, in bytes.
+ * @param [in]  remote_addr    Remote address of the first block.
+ * @param [in]  remote_stride  Distance between the remote blocks, in bytes.
+ * @param [in]  block_size     Size of every block, in bytes.
+ * @param [in]  count          Number of blocks.
+ * @param [in]  rkey           Remote memory key associated with the remote
+ *                             memory addresses.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_get_strided_nbi(ucp_ep_h ep, void *buffer, ptrdiff_t stride,
+                                 uint64_t remote_addr, ptrdiff_t remote_stride,
+                                 size_t block_size, size_t count,
+                                 ucp_rkey_h rkey);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking implicit indexed remote memory put operation.
+ *
+ * This routine initiates a storage of the blocks described by @a iov, in the
+ * remote memory region described by the @ref ucp_rkey_h "memory handle"
+ * @a rkey. It is the indexed counterpart of @ref ucp_put_strided_nbi, and
+ * combines blocks which are adjacent in the remote memory in the same way.
+ * The @a iov array can be released or modified when the routine returns, but
+ * the source buffers can be reused only after the operation is flushed.
+ *
+ * @param [in]  ep      Remote endpoint handle.
+ * @param [in]  iov     Array of blocks to write.
+ * @param [in]  iovcnt  Number of elements in @a iov.
+ * @param [in]  rkey    Remote memory key associated with the remote memory
+ *                      addresses.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_put_iov_nbi(ucp_ep_h ep, const ucp_rma_iov_t *iov,
+                             size_t iovcnt, ucp_rkey_h rkey);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking implicit indexed remote memory get operation.
+ *
+ * This routine initiates a load of the blocks described by @a iov, from the
+ * remote memory region described by the @ref ucp_rkey_h "memory handle"
+ * @a rkey. It is the indexed counterpart of @ref ucp_get_strided_nbi. The
+ * @a iov array can be released or modified when the routine returns, but the
+ * data is stored under the local addresses only after the operation is
+ * flushed.
+ *
+ * @param [in]  ep      Remote endpoint handle.
+ * @param [in]  iov     Array of blocks to read.
+ * @param [in]  iovcnt  Number of elements in @a iov.
+ * @param [in]  rkey    Remote memory key associated with the remote memory
+ *                      addresses.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_get_iov_nbi(ucp_ep_h ep, const ucp_rma_iov_t *iov,
+                             size_t iovcnt, ucp_rkey_h rkey);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Post an atomic memory operation.
@@ -3406,6 +4058,102 @@ ucp_atomic_fetch_nb(ucp_ep_h ep, ucp_atomic_fetch_op_t opcode,
                     ucp_send_callback_t cb);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Post a vector of atomic operations.
+ *
+ * This routine posts @a count atomic operations, described by @a ops, to
+ * remote values accessible with the same @ref ucp_rkey_h "remote memory handle"
+ * @a rkey. The operations are executed in the order of the vector. When the
+ * atomic operations are emulated in software, many of them are carried by a
+ * single message and executed by the remote peer in one pass, and the fetched
+ * values are returned in a single reply.
+ * The operation is considered complete when all fetched values are stored in
+ * local memory. Operations without a result are completed locally, and a user
+ * must call @ref ucp_ep_flush_nb or @ref ucp_worker_flush_nb to guarantee that
+ * the remote values have been updated.
+ *
+ * @note The user should not modify @a ops, nor any of the result buffers,
+ *       until the operation completes.
+ *
+ * @param [in] ep          UCP endpoint.
+ * @param [in] ops         Array of atomic operations.
+ * @param [in] count       Number of entries in @a ops.
+ * @param [in] op_size     Size of the operands and results in bytes.
+ * @param [in] rkey        Remote key handle for all remote addresses.
+ * @param [in] cb          Call-back function that is invoked whenever the
+ *                         operation is completed. It is important to note
+ *                         that the call-back function is only invoked in a case
+ *                         when the operation cannot be completed in place.
+ *
+ * @return NULL                 - The operation was completed immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The operation failed.
+ * @return otherwise            - Operation was scheduled and can be
+ *                              completed at any point in time. The request handle
+ *                              is returned to the application in order to track
+ *                              progress of the operation. The application is
+ *                              responsible for releasing the handle using
+ *                              @ref ucp_request_free "ucp_request_free()" routine.
+ */
+ucs_status_ptr_t
+ucp_atomic_vec_nb(ucp_ep_h ep, const ucp_atomic_vec_op_t *ops, size_t count,
+                  size_t op_size, ucp_rkey_h rkey, ucp_send_callback_t cb);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Post an atomic memory operation.
+ *
+ * This routine posts an atomic memory operation to remote values, described by
+ * the combination of the remote memory address @a remote_addr and the
+ * @ref ucp_rkey_h "remote memory handle" @a rkey. The size of the operands is
+ * defined by the contiguous datatype passed in @a param, which is required,
+ * and may be 4, 8 or 16 bytes.
+ * If @a count is larger than 1, the operation is applied to an array of
+ * @a count consecutive remote values starting at @a remote_addr, each one with
+ * the respective operand from @a buffer, and the previous values are stored to
+ * the respective entries of the reply buffer. This is supported for all
+ * operations except @ref UCP_ATOMIC_OP_CSWAP.
+ * If a reply buffer is passed in @a param, the operation is considered complete
+ * when the previous remote values are stored to it. Otherwise, a user must
+ * call @ref ucp_ep_flush_nb or @ref ucp_worker_flush_nb to guarantee that
+ * the remote values have been updated.
+ *
+ * @note @ref UCP_ATOMIC_OP_SWAP and @ref UCP_ATOMIC_OP_CSWAP require a reply
+ *       buffer. In the case of CSWAP, @a buffer holds the value to compare, and
+ *       the reply buffer holds the value to swap in.
+ * @note 16-byte operands are supported for @ref UCP_ATOMIC_OP_CSWAP only, and
+ *       require @ref UCP_FEATURE_AMO64. Since transports do not support such
+ *       operations, they are always executed by the remote CPU, and are atomic
+ *       only with respect to other 16-byte operations. If the endpoint has no
+ *       active message transport, UCS_ERR_UNSUPPORTED is returned.
+ * @note The reply buffer must be accessible from the CPU; if the memory type is
+ *       passed in @a param, it applies to the reply buffer.
+ *
+ * @param [in] ep          UCP endpoint.
+ * @param [in] opcode      One of @ref ucp_atomic_op_t.
+ * @param [in] buffer      Address of the operands. The operands are copied
+ *                         before the routine returns.
+ * @param [in] count       Number of operands in @a buffer.
+ * @param [in] remote_addr Remote address to operate on.
+ * @param [in] rkey        Remote key handle for the remote memory address.
+ * @param [in] param       Operation parameters, see @ref ucp_request_param_t.
+ *                         The reply buffer is passed in
+ *                         @ref ucp_request_param_t.reply_buffer.
+ *
+ * @return NULL                 - The operation was completed immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The operation failed.
+ * @return otherwise            - Operation was scheduled and can be
+ *                              completed at any point in time. The request handle
+ *                              is returned to the application in order to track
+ *                              progress of the operation.
+ */
+ucs_status_ptr_t
+ucp_atomic_op_nbx(ucp_ep_h ep, ucp_atomic_op_t opcode, const void *buffer,
+                  size_t count, uint64_t remote_addr, ucp_rkey_h rkey,
+                  const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Check the status of non-blocking request.
@@ -3481,6 +4229,30 @@ ucs_status_t ucp_stream_recv_request_test(void *request, size_t *length_p);
 void ucp_request_cancel(ucp_worker_h worker, void *request);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Start a persistent communications request.
+ *
+ * @param [in]  request      Persistent request created by
+ *                           @ref ucp_tag_send_init_nbx or
+ *                           @ref ucp_tag_recv_init_nbx.
+ *
+ * This routine posts the operation described by a persistent request. The
+ * request can be started again once the previous operation has completed, as
+ * reported by @ref ucp_request_check_status or by the completion callback.
+ * The received tag and length of a receive request can be queried by
+ * @ref ucp_tag_recv_request_test.
+ *
+ * @return UCS_OK            - The operation completed immediately, the
+ *                             callback will not be invoked.
+ * @return UCS_INPROGRESS    - The operation was posted and will complete later.
+ * @return UCS_ERR_BUSY      - The previous operation is still in progress.
+ * @return Other error codes - The operation failed, the request may be started
+ *                             again.
+ */
+ucs_status_t ucp_request_start(void *request);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Release UCP data buffer returned by @ref ucp_stream_recv_data_nb.
@@ -3628,6 +4400,60 @@ ucs_status_ptr_t ucp_worker_flush_nb(ucp_worker_h worker, unsigned flags,
                                      ucp_send_callback_t cb);
 
 
+/**
+ * @ingroup UCP_COMM
+ *
+ * @brief Flush outstanding AMO and RMA operations which target a remote memory
+ * region.
+ *
+ * This routine flushes the AMO and RMA operations issued on the @a ep with the
+ * remote key @a rkey. When the flush completes, all such operations issued
+ * prior to this call are completed both at the origin and at the target.
+ * Unlike @ref ucp_ep_flush_nb "ucp_ep_flush_nb()", it flushes only the
+ * transport lanes the remote key was used on, and it does not wait for the
+ * remote completion of software-emulated operations issued with other remote
+ * keys.
+ *
+ * @param [in] ep        UCP endpoint the remote key was unpacked on.
+ * @param [in] rkey      Remote key of the memory region to flush. It must not
+ *                       be destroyed before the flush operation completes.
+ * @param [in] cb        Callback which will be called when the flush operation
+ *                       completes.
+ *
+ * @return NULL             - The flush operation was completed immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The flush operation failed.
+ * @return otherwise        - Flush operation was scheduled and can be completed
+ *                          in any point in time. The request handle is returned
+ *                          to the application in order to track progress. The
+ *                          application is responsible for releasing the handle
+ *                          using @ref ucp_request_free "ucp_request_free()"
+ *                          routine.
+ */
+ucs_status_ptr_t ucp_ep_rkey_flush_nb(ucp_ep_h ep, ucp_rkey_h rkey,
+                                      ucp_send_callback_t cb);
+
+
+/**
+ * @ingroup UCP_COMM
+ *
+ * @brief Test whether the operations which target a remote memory region are
+ * completed.
+ *
+ * This routine checks whether all AMO and RMA operations issued on the @a ep
+ * with the remote key @a rkey are completed both at the origin and at the
+ * target, without creating a request. The application should progress the
+ * worker and test again while the routine returns UCS_INPROGRESS.
+ *
+ * @param [in] ep        UCP endpoint the remote key was unpacked on.
+ * @param [in] rkey      Remote key of the memory region to test.
+ *
+ * @return UCS_OK           - All operations are completed.
+ * @return UCS_INPROGRESS   - Some operations are not completed yet.
+ * @return otherwise        - Error code as defined by @ref ucs_status_t.
+ */
+ucs_status_t ucp_ep_rkey_flush_test(ucp_ep_h ep, ucp_rkey_h rkey);
+
+
 /**
  * @example ucp_hello_world.c
  * UCP hello world client / server example utility.
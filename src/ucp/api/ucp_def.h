@@ -26,6 +26,7 @@
  * @ref ucp_tag_recv_callback_t callback argument.
  */
 typedef struct ucp_tag_recv_info             ucp_tag_recv_info_t;
+typedef struct ucp_am_recv_param              ucp_am_recv_param_t;
 
 
 /**
@@ -554,6 +555,88 @@ typedef ucs_status_t (*ucp_am_callback_t)(void *arg, void *data, size_t length,
                                           ucp_ep_h reply_ep, unsigned flags);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Completion callback for receiving the data of a rendezvous Active
+ * Message.
+ *
+ * This callback routine is invoked whenever the receive operation started by
+ * @ref ucp_am_recv_data_nb is completed.
+ *
+ * @param [in]  request   The completed receive request.
+ * @param [in]  status    Completion status. If the receive operation was
+ *                        completed successfully UCS_OK is returned. If the
+ *                        receive buffer was too small for the message,
+ *                        UCS_ERR_MESSAGE_TRUNCATED is returned.
+ * @param [in]  length    The size of the received data in bytes.
+ */
+typedef void (*ucp_am_recv_data_callback_t)(void *request, ucs_status_t status,
+                                            size_t length);
+
+
+/**
+ * @ingroup UCP_ENDPOINT
+ * @brief Callback to process incoming Active Message sent by
+ * @ref ucp_am_send_nbx routine.
+ *
+ * The callback is always called from the progress context, therefore calling
+ * @ref ucp_worker_progress() is not allowed. It is recommended to define
+ * callbacks with relatively short execution time to avoid blocking of
+ * communication progress.
+ *
+ * @param [in]  arg           User-defined argument.
+ * @param [in]  header        User defined active message header. The header
+ *                            is valid only during the callback.
+ * @param [in]  header_length Active message header length in bytes.
+ * @param [in]  data          Points to the received data if the
+ *                            @a UCP_AM_RECV_ATTR_FLAG_RNDV flag is not set
+ *                            in @ref ucp_am_recv_param_t.recv_attr. Otherwise
+ *                            it points to a rendezvous descriptor, which
+ *                            should be passed to @ref ucp_am_recv_data_nbx to
+ *                            fetch the data, or to @ref ucp_am_data_release
+ *                            to drop it.
+ * @param [in]  length        Length of data.
+ * @param [in]  param         Data receive parameters.
+ *
+ * @return UCS_OK         @a data will not persist after the callback returns.
+ *                        If a rendezvous descriptor was neither received nor
+ *                        released by the callback, the data is dropped.
+ *
+ * @return UCS_INPROGRESS Can only be returned if @a param->recv_attr has the
+ *                        @a UCP_AM_RECV_ATTR_FLAG_DATA or
+ *                        @a UCP_AM_RECV_ATTR_FLAG_RNDV flag. The data (or the
+ *                        descriptor) persists after the callback returns,
+ *                        and must be passed to @ref ucp_am_data_release or
+ *                        @ref ucp_am_recv_data_nbx later.
+ *
+ * @note This callback should be set and released
+ *       by @ref ucp_worker_set_am_recv_handler function.
+ */
+typedef ucs_status_t (*ucp_am_recv_callback_t)(void *arg, const void *header,
+                                               size_t header_length,
+                                               void *data, size_t length,
+                                               const ucp_am_recv_param_t *param);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Completion callback for @ref ucp_am_recv_data_nbx.
+ *
+ * @param [in]  request   The completed receive request.
+ * @param [in]  status    Completion status. If the receive operation was
+ *                        completed successfully UCS_OK is returned. If the
+ *                        receive buffer was too small for the message,
+ *                        UCS_ERR_MESSAGE_TRUNCATED is returned.
+ * @param [in]  length    The size of the received data in bytes.
+ * @param [in]  user_data User data passed to "user_data" value,
+ *                        see @ref ucp_request_param_t.
+ */
+typedef void (*ucp_am_recv_data_nbx_callback_t)(void *request,
+                                                ucs_status_t status,
+                                                size_t length,
+                                                void *user_data);
+
+
 /**
  * @ingroup UCP_ENDPOINT
  * @brief Tuning parameters for the UCP endpoint.
@@ -17,28 +17,82 @@
 #include <ucp/core/ucp_worker.h>
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto_am.inl>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
+#include <ucs/datastruct/mpool.inl>
 
 
-void ucp_am_ep_init(ucp_ep_h ep)
+static UCS_F_ALWAYS_INLINE ucp_recv_desc_t *
+ucp_am_frag_desc_get(ucp_worker_h worker, size_t size)
 {
-    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
-    
-    if (ep->worker->context->config.features & UCP_FEATURE_AM) {
-        ucs_list_head_init(&ep_ext->am.started_ams);
+    ucp_recv_desc_t *rdesc;
+    unsigned shift;
+
+    shift = (size <= UCS_BIT(UCP_AM_FRAG_MP_MIN_SHIFT)) ?
+            UCP_AM_FRAG_MP_MIN_SHIFT : (ucs_ilog2(size - 1) + 1);
+    if (ucs_likely(shift < (UCP_AM_FRAG_MP_MIN_SHIFT + UCP_AM_FRAG_MP_COUNT))) {
+        rdesc = ucs_mpool_get_inline(
+                    &worker->am_frag_mps[shift - UCP_AM_FRAG_MP_MIN_SHIFT]);
+        if (ucs_likely(rdesc != NULL)) {
+            rdesc->flags = 0;
+        }
+        return rdesc;
+    }
+
+    rdesc = ucs_malloc(size + sizeof(ucp_recv_desc_t),
+                       "ucp recv desc for long AM");
+    if (ucs_likely(rdesc != NULL)) {
+        rdesc->flags = UCP_RECV_DESC_FLAG_MALLOC;
+    }
+    return rdesc;
+}
+
+static UCS_F_ALWAYS_INLINE void ucp_am_frag_desc_put(ucp_recv_desc_t *rdesc)
+{
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
+        ucs_free(rdesc);
+    } else {
+        ucs_mpool_put_inline(rdesc);
     }
 }
 
 void ucp_am_ep_cleanup(ucp_ep_h ep)
 {
-    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_worker_h worker = ep->worker;
+    ucp_am_unfinished_t *unfinished;
+    khiter_t iter;
+
+    if (!(worker->context->config.features & UCP_FEATURE_AM)) {
+        return;
+    }
+
+    for (iter = kh_begin(&worker->am_frag_hash);
+         iter != kh_end(&worker->am_frag_hash); ++iter) {
+        if (!kh_exist(&worker->am_frag_hash, iter)) {
+            continue;
+        }
 
-    if (ep->worker->context->config.features & UCP_FEATURE_AM) {
-        if (ucs_unlikely(!ucs_list_is_empty(&ep_ext->am.started_ams))) {
-            ucs_warn("worker : %p not all UCP active messages have been" 
-                     "run to completion", ep->worker);
+        unfinished = &kh_val(&worker->am_frag_hash, iter);
+        if (unfinished->ep != ep) {
+            continue;
         }
+
+        ucs_warn("worker %p: ep %p is destroyed before UCP active message "
+                 "0x%"PRIx64" has arrived, %zu bytes missing", worker, ep,
+                 kh_key(&worker->am_frag_hash, iter), unfinished->left);
+        ucp_am_frag_desc_put(unfinished->all_data);
+        kh_del(ucp_am_frag_hash, &worker->am_frag_hash, iter);
+    }
+}
+
+static void ucp_am_rndv_desc_consume(ucp_recv_desc_t *desc)
+{
+    if (desc->flags & UCP_RECV_DESC_FLAG_AM_CB_INPROGRESS) {
+        /* released by the RTS handler after the user callback returns */
+        desc->flags |= UCP_RECV_DESC_FLAG_AM_CONSUMED;
+    } else {
+        ucp_recv_desc_release(desc);
     }
 }
 
@@ -49,32 +103,32 @@ UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
     ucp_recv_desc_t *rdesc = (ucp_recv_desc_t *)data - 1;
     ucp_recv_desc_t *desc;
 
-    if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV)) {
+        /* the payload is dropped, let the sender complete */
+        UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+        ucp_rndv_send_ats(worker, data, UCS_OK);
+        ucp_am_rndv_desc_consume(rdesc);
+        UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+        return;
+    } else if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
         ucs_free(rdesc);
         return;
-    } else if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_HDR) {
+    } else if (rdesc->flags & (UCP_RECV_DESC_FLAG_AM_HDR |
+                               UCP_RECV_DESC_FLAG_AM_REPLY)) {
+        /* The descriptor was put in place of the headers, move it back to
+         * the beginning of the UCT descriptor */
         desc = rdesc;
-        rdesc = UCS_PTR_BYTE_OFFSET(rdesc, -sizeof(ucp_am_hdr_t));
-        *rdesc = *desc;
-    } else if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_REPLY) {
-        desc = rdesc;
-        rdesc = UCS_PTR_BYTE_OFFSET(rdesc, -sizeof(ucp_am_reply_hdr_t));
+        rdesc = UCS_PTR_BYTE_OFFSET(rdesc, -(ptrdiff_t)rdesc->payload_offset);
         *rdesc = *desc;
     } 
     ucp_recv_desc_release(rdesc);
 }
 
-UCS_PROFILE_FUNC(ucs_status_t, ucp_worker_set_am_handler,
-                 (worker, id, cb, arg, flags),
-                 ucp_worker_h worker, uint16_t id, 
-                 ucp_am_callback_t cb, void *arg, 
-                 uint32_t flags)
+static void ucp_worker_set_am_cb(ucp_worker_h worker, uint16_t id,
+                                 ucp_worker_am_entry_t *entry)
 {
     size_t num_entries;
 
-    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
-                                    return UCS_ERR_INVALID_PARAM);
-
     if (id >= worker->am_cb_array_len) {
         num_entries = ucs_align_up_pow2(id + 1, UCP_AM_CB_BLOCK_SIZE);
         worker->am_cbs = ucs_realloc(worker->am_cbs, num_entries * 
@@ -87,32 +141,175 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_worker_set_am_handler,
         worker->am_cb_array_len = num_entries;
     }
 
-    worker->am_cbs[id].cb      = cb;
-    worker->am_cbs[id].context = arg;
-    worker->am_cbs[id].flags   = flags;
+    worker->am_cbs[id] = *entry;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_worker_set_am_handler,
+                 (worker, id, cb, arg, flags),
+                 ucp_worker_h worker, uint16_t id, 
+                 ucp_am_callback_t cb, void *arg, 
+                 uint32_t flags)
+{
+    ucp_worker_am_entry_t entry;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    entry.cb      = cb;
+    entry.context = arg;
+    entry.flags   = flags;
+    ucp_worker_set_am_cb(worker, id, &entry);
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_worker_set_am_recv_handler,
+                 (worker, param), ucp_worker_h worker,
+                 const ucp_am_handler_param_t *param)
+{
+    ucp_worker_am_entry_t entry;
+    uint32_t flags;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    if (!(param->field_mask & UCP_AM_HANDLER_PARAM_FIELD_ID) ||
+        (param->id > UINT16_MAX)) {
+        ucs_error("worker %p: invalid active message handler id", worker);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    flags = (param->field_mask & UCP_AM_HANDLER_PARAM_FIELD_FLAGS) ?
+            param->flags : 0;
+    if (flags & ~(UCP_AM_FLAG_WHOLE_MSG | UCP_AM_FLAG_RNDV)) {
+        ucs_error("worker %p: unsupported active message handler flags 0x%x",
+                  worker, flags);
+        return UCS_ERR_INVALID_PARAM;
+    }
 
+    /* Rendezvous messages are always passed to the callback as descriptors */
+    entry.cb_nbx  = (param->field_mask & UCP_AM_HANDLER_PARAM_FIELD_CB) ?
+                    param->cb : NULL;
+    entry.context = (param->field_mask & UCP_AM_HANDLER_PARAM_FIELD_ARG) ?
+                    param->arg : NULL;
+    entry.flags   = flags | UCP_AM_FLAG_RNDV | UCP_AM_CB_PRIV_FLAG_NBX;
+    ucp_worker_set_am_cb(worker, param->id, &entry);
     return UCS_OK;
 }
 
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_am_invoke_cb(ucp_worker_h worker, uint16_t am_id, const void *user_hdr,
+                 uint32_t user_hdr_length, void *data, size_t data_length,
+                 ucp_ep_h reply_ep, int is_rndv)
+{
+    ucp_worker_am_entry_t *am_cb = &worker->am_cbs[am_id];
+    ucp_am_recv_param_t param;
+    unsigned flags;
+
+    if (am_cb->flags & UCP_AM_CB_PRIV_FLAG_NBX) {
+        param.recv_attr = is_rndv ? UCP_AM_RECV_ATTR_FLAG_RNDV :
+                                    UCP_AM_RECV_ATTR_FLAG_DATA;
+        param.reply_ep  = reply_ep;
+        if (reply_ep != NULL) {
+            param.recv_attr |= UCP_AM_RECV_ATTR_FIELD_REPLY_EP;
+        }
+
+        return am_cb->cb_nbx(am_cb->context, user_hdr, user_hdr_length, data,
+                             data_length, &param);
+    }
+
+    flags = UCP_CB_PARAM_FLAG_DATA | (is_rndv ? UCP_CB_PARAM_FLAG_RNDV : 0);
+    return am_cb->cb(am_cb->context, data, data_length, reply_ep, flags);
+}
+
+/* Invoke the handler with the data in a receive descriptor. The data may be
+ * received by ucp_am_recv_data_nbx() from the callback, then the descriptor
+ * is released as if the callback returned UCS_OK. */
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_am_invoke_cb_data(ucp_worker_h worker, uint16_t am_id,
+                      const void *user_hdr, uint32_t user_hdr_length,
+                      ucp_recv_desc_t *rdesc, size_t data_length,
+                      ucp_ep_h reply_ep)
+{
+    ucs_status_t status;
+
+    rdesc->flags |= UCP_RECV_DESC_FLAG_AM_CB_INPROGRESS;
+    status        = ucp_am_invoke_cb(worker, am_id, user_hdr, user_hdr_length,
+                                     rdesc + 1, data_length, reply_ep, 0);
+    rdesc->flags &= ~UCP_RECV_DESC_FLAG_AM_CB_INPROGRESS;
+
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_CONSUMED) {
+        rdesc->flags &= ~UCP_RECV_DESC_FLAG_AM_CONSUMED;
+        return UCS_OK;
+    }
+
+    return status;
+}
+
+static UCS_F_ALWAYS_INLINE int
+ucp_am_is_cb_set(ucp_worker_h worker, uint16_t am_id)
+{
+    if (ucs_likely((am_id < worker->am_cb_array_len) &&
+                   (worker->am_cbs[am_id].cb != NULL))) {
+        return 1;
+    }
+
+    ucs_warn("UCP Active Message was received with id : %u, but there " 
+             "is no registered callback for that id", am_id);
+    return 0;
+}
+
+static UCS_F_ALWAYS_INLINE ucp_am_hdr_t
+ucp_am_make_header(const ucp_request_t *req)
+{
+    ucp_am_hdr_t hdr;
+
+    hdr.am_hdr.am_id         = req->send.msg_proto.am.am_id;
+    hdr.am_hdr.flags         = req->send.msg_proto.am.flags;
+    hdr.am_hdr.header_length = req->send.msg_proto.am.header_length;
+    return hdr;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_am_fill_long_header(ucp_am_long_hdr_t *hdr, ucp_request_t *req)
+{
+    hdr->total_size    = req->send.length;
+    hdr->msg_id        = req->send.msg_proto.message_id;
+    hdr->ep            = ucp_request_get_dest_ep_ptr(req);
+    hdr->offset        = req->send.state.dt.offset;
+    hdr->header_length = req->send.msg_proto.am.header_length;
+    hdr->am_id         = req->send.msg_proto.am.am_id;
+}
+
+/* Copy the user header to the packet, return a pointer to the payload */
+static UCS_F_ALWAYS_INLINE void *
+ucp_am_pack_user_header(void *dest, const ucp_request_t *req)
+{
+    if (ucs_unlikely(req->send.msg_proto.am.header_length != 0)) {
+        memcpy(dest, req->send.msg_proto.am.header,
+               req->send.msg_proto.am.header_length);
+    }
+
+    return UCS_PTR_BYTE_OFFSET(dest, req->send.msg_proto.am.header_length);
+}
+
 static size_t 
 ucp_am_bcopy_pack_args_single(void *dest, void *arg)
 {
     ucp_am_hdr_t *hdr = dest;
     ucp_request_t *req = arg;
+    void *payload;
     size_t length;
 
     ucs_assert(req->send.state.dt.offset == 0);
-    
-    hdr->am_hdr.am_id  = req->send.msg_proto.am.am_id;
-    hdr->am_hdr.length = req->send.length;
-    hdr->am_hdr.flags  = req->send.msg_proto.am.flags;
 
-    length = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
-                         UCS_MEMORY_TYPE_HOST, hdr + 1, req->send.buffer,
-                         &req->send.state.dt, req->send.length);
+    *hdr = ucp_am_make_header(req);
+    payload = ucp_am_pack_user_header(hdr + 1, req);
+    length  = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
+                          req->send.mem_type, payload, req->send.buffer,
+                          &req->send.state.dt, req->send.length);
     ucs_assert(length == req->send.length);
 
-    return sizeof(*hdr) + length;
+    return UCS_PTR_BYTE_DIFF(dest, payload) + length;
 }
 
 static size_t 
@@ -120,24 +317,21 @@ ucp_am_bcopy_pack_args_single_reply(void *dest, void *arg)
 {
     ucp_am_reply_hdr_t *reply_hdr = dest;
     ucp_request_t *req = arg;
+    void *payload;
     size_t length;
-    size_t hdr_size;
 
     ucs_assert(req->send.state.dt.offset == 0);
-    
-    reply_hdr->super.am_hdr.am_id  = req->send.msg_proto.am.am_id;
-    reply_hdr->super.am_hdr.length = req->send.length;
-    reply_hdr->super.am_hdr.flags  = req->send.msg_proto.am.flags;
-    reply_hdr->ep_ptr              = ucp_request_get_dest_ep_ptr(req);
-
-    length = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
-                         UCS_MEMORY_TYPE_HOST, reply_hdr + 1,
-                         req->send.buffer,
-                         &req->send.state.dt, req->send.length);
-    hdr_size = sizeof(*reply_hdr);
+
+    reply_hdr->super = ucp_am_make_header(req);
+    reply_hdr->ep_ptr = ucp_request_get_dest_ep_ptr(req);
+
+    payload = ucp_am_pack_user_header(reply_hdr + 1, req);
+    length  = ucp_dt_pack(req->send.ep->worker, req->send.datatype,
+                          req->send.mem_type, payload, req->send.buffer,
+                          &req->send.state.dt, req->send.length);
     ucs_assert(length == req->send.length);
 
-    return hdr_size + length;
+    return UCS_PTR_BYTE_DIFF(dest, payload) + length;
 }
 
 static size_t 
@@ -145,24 +339,23 @@ ucp_am_bcopy_pack_args_first(void *dest, void *arg)
 {
     ucp_am_long_hdr_t *hdr = dest;
     ucp_request_t *req = arg;
+    void *payload;
     size_t length;
-    
+
     length = ucp_ep_get_max_bcopy(req->send.ep, req->send.lane) -
-                                  sizeof(*hdr);
-    hdr->total_size = req->send.length;
-    hdr->am_id      = req->send.msg_proto.am.am_id;
-    hdr->msg_id     = req->send.msg_proto.message_id;
-    hdr->ep         = ucp_request_get_dest_ep_ptr(req);
-    hdr->offset     = req->send.state.dt.offset;
-    
+             sizeof(*hdr) - req->send.msg_proto.am.header_length;
+
     ucs_assert(req->send.state.dt.offset == 0);
     ucs_assert(req->send.length > length);
 
-    return sizeof(*hdr) + ucp_dt_pack(req->send.ep->worker, 
-                                      req->send.datatype, 
-                                      UCS_MEMORY_TYPE_HOST,
-                                      hdr + 1, req->send.buffer,
-                                      &req->send.state.dt, length);
+    /* The first fragment carries the user header */
+    ucp_am_fill_long_header(hdr, req);
+    payload = ucp_am_pack_user_header(hdr + 1, req);
+
+    return UCS_PTR_BYTE_DIFF(dest, payload) +
+           ucp_dt_pack(req->send.ep->worker, req->send.datatype,
+                       req->send.mem_type, payload, req->send.buffer,
+                       &req->send.state.dt, length);
 }
 
 static size_t 
@@ -177,15 +370,11 @@ ucp_am_bcopy_pack_args_mid(void *dest, void *arg)
     length    = ucs_min(max_bcopy - sizeof(*hdr),
                         req->send.length - req->send.state.dt.offset);
 
-    hdr->msg_id     = req->send.msg_proto.message_id;
-    hdr->offset     = req->send.state.dt.offset;
-    hdr->ep         = ucp_request_get_dest_ep_ptr(req);
-    hdr->am_id      = req->send.msg_proto.am.am_id;
-    hdr->total_size = req->send.length;
-    
+    ucp_am_fill_long_header(hdr, req);
+
     return sizeof(*hdr) + ucp_dt_pack(req->send.ep->worker,
                                       req->send.datatype,
-                                      UCS_MEMORY_TYPE_HOST,
+                                      req->send.mem_type,
                                       hdr + 1, req->send.buffer,
                                       &req->send.state.dt, length);
 }
@@ -196,9 +385,9 @@ static ucs_status_t ucp_am_send_short(ucp_ep_h ep, uint16_t id,
     uct_ep_h am_ep = ucp_ep_get_am_uct_ep(ep);
     ucp_am_hdr_t hdr;
 
-    hdr.am_hdr.am_id  = id;
-    hdr.am_hdr.length = length;
-    hdr.am_hdr.flags  = 0;
+    hdr.am_hdr.am_id         = id;
+    hdr.am_hdr.header_length = 0;
+    hdr.am_hdr.flags         = 0;
     ucs_assert(sizeof(ucp_am_hdr_t) == sizeof(uint64_t));
     
     return uct_ep_am_short(am_ep, UCP_AM_ID_SINGLE, hdr.u64, 
@@ -290,103 +479,206 @@ static ucs_status_t ucp_am_bcopy_multi_reply(uct_pending_req_t *self)
 static ucs_status_t ucp_am_zcopy_single(uct_pending_req_t *self)
 {
     ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
-    ucp_am_hdr_t hdr;
-    
-    hdr.am_hdr.am_id  = req->send.msg_proto.am.am_id;
-    hdr.am_hdr.length = req->send.length;
-    hdr.am_hdr.flags  = req->send.msg_proto.am.flags;
-    
-    return ucp_do_am_zcopy_single(self, UCP_AM_ID_SINGLE, &hdr,
-                                  sizeof(hdr), ucp_proto_am_zcopy_req_complete);
+    size_t hdr_size    = sizeof(ucp_am_hdr_t) +
+                         req->send.msg_proto.am.header_length;
+    ucp_am_hdr_t *hdr  = ucs_alloca(hdr_size);
+
+    /* The user header is sent inline, along with the UCP header */
+    *hdr = ucp_am_make_header(req);
+    ucp_am_pack_user_header(hdr + 1, req);
+
+    return ucp_do_am_zcopy_single(self, UCP_AM_ID_SINGLE, hdr, hdr_size,
+                                  ucp_proto_am_zcopy_req_complete);
 }
 
 static ucs_status_t ucp_am_zcopy_single_reply(uct_pending_req_t *self)
 {
     ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
-    ucp_am_reply_hdr_t reply_hdr;
+    size_t hdr_size    = sizeof(ucp_am_reply_hdr_t) +
+                         req->send.msg_proto.am.header_length;
+    ucp_am_reply_hdr_t *reply_hdr = ucs_alloca(hdr_size);
+
+    reply_hdr->super = ucp_am_make_header(req);
+    reply_hdr->ep_ptr = ucp_request_get_dest_ep_ptr(req);
+    ucp_am_pack_user_header(reply_hdr + 1, req);
 
-    reply_hdr.super.am_hdr.am_id  = req->send.msg_proto.am.am_id;
-    reply_hdr.super.am_hdr.length = req->send.length;
-    reply_hdr.super.am_hdr.flags  = req->send.msg_proto.am.flags;
-    reply_hdr.ep_ptr              = ucp_request_get_dest_ep_ptr(req);
-    
     return ucp_do_am_zcopy_single(self, UCP_AM_ID_SINGLE_REPLY, 
-                                  &reply_hdr, sizeof(reply_hdr), 
+                                  reply_hdr, hdr_size,
                                   ucp_proto_am_zcopy_req_complete);
 }
 
-static ucs_status_t ucp_am_zcopy_multi(uct_pending_req_t *self)
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_am_zcopy_multi_common(uct_pending_req_t *self, uint8_t am_id)
 {
-    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
-    ucp_am_long_hdr_t hdr;
-    
-    hdr.ep         = ucp_request_get_dest_ep_ptr(req);
-    hdr.msg_id     = req->send.msg_proto.message_id;
-    hdr.offset     = req->send.state.dt.offset;
-    hdr.am_id      = req->send.msg_proto.am.am_id;
-    hdr.total_size = req->send.length;
-    
-    return ucp_do_am_zcopy_multi(self, UCP_AM_ID_MULTI, 
-                                 UCP_AM_ID_MULTI,
-                                 &hdr, sizeof(hdr),
-                                 &hdr, sizeof(hdr),
+    ucp_request_t *req     = ucs_container_of(self, ucp_request_t, send.uct);
+    size_t hdr_size        = sizeof(ucp_am_long_hdr_t) +
+                             req->send.msg_proto.am.header_length;
+    ucp_am_long_hdr_t *hdr = ucs_alloca(hdr_size);
+
+    /* The first fragment carries the user header, the other ones use only
+     * the common part */
+    ucp_am_fill_long_header(hdr, req);
+    if (req->send.state.dt.offset == 0) {
+        ucp_am_pack_user_header(hdr + 1, req);
+    }
+
+    return ucp_do_am_zcopy_multi(self, am_id, am_id,
+                                 hdr, hdr_size,
+                                 hdr, sizeof(*hdr),
                                  ucp_proto_am_zcopy_req_complete, 1);
 }
 
+static ucs_status_t ucp_am_zcopy_multi(uct_pending_req_t *self)
+{
+    return ucp_am_zcopy_multi_common(self, UCP_AM_ID_MULTI);
+}
+
 static ucs_status_t ucp_am_zcopy_multi_reply(uct_pending_req_t *self)
 {
-    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
-    ucp_am_long_hdr_t hdr;
+    return ucp_am_zcopy_multi_common(self, UCP_AM_ID_MULTI_REPLY);
+}
 
-    hdr.ep         = ucp_request_get_dest_ep_ptr(req);
-    hdr.msg_id     = req->send.msg_proto.message_id;
-    hdr.offset     = req->send.state.dt.offset;
-    hdr.am_id      = req->send.msg_proto.am.am_id;
-    hdr.total_size = req->send.length;
-    
-    return ucp_do_am_zcopy_multi(self, UCP_AM_ID_MULTI_REPLY,
-                                 UCP_AM_ID_MULTI_REPLY,
-                                 &hdr, sizeof(hdr),
-                                 &hdr, sizeof(hdr),
-                                 ucp_proto_am_zcopy_req_complete, 1);
+static size_t ucp_am_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+    size_t rts_size;
+
+    /* The user header follows the RTS and the packed rkey */
+    rndv_rts_hdr->am = ucp_am_make_header(sreq);
+    rts_size = ucp_rndv_rts_pack(sreq, rndv_rts_hdr);
+    ucp_am_pack_user_header(UCS_PTR_BYTE_OFFSET(dest, rts_size), sreq);
+
+    return rts_size + sreq->send.msg_proto.am.header_length;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_am_progress_rndv_rts, (self),
+                 uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+
+    return ucp_rndv_progress_rts(self, UCP_AM_ID_AM_RNDV_RTS,
+                                 ucp_am_rndv_rts_pack,
+                                 sreq->send.msg_proto.am.header_length);
+}
+
+static ucs_status_t ucp_am_send_start_rndv(ucp_request_t *sreq)
+{
+    ucp_worker_h worker = sreq->send.ep->worker;
+    ucs_status_t status;
+
+    ucp_trace_req(sreq, "AM start_rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(sreq->send.ep), sreq->send.buffer,
+                  sreq->send.length);
+    UCS_PROFILE_REQUEST_EVENT(sreq, "am_start_rndv", sreq->send.length);
+
+    sreq->flags            |= UCP_REQUEST_FLAG_SEND_RNDV;
+    sreq->send.rndv_req_id  = worker->rndv_req_id++;
+    sreq->send.uct.func     = ucp_am_progress_rndv_rts;
+
+    /* the remote side refers to the request by its ID */
+    ucp_request_id_alloc(worker, sreq);
+
+    status = ucp_tag_rndv_reg_send_buffer(sreq);
+    if (status != UCS_OK) {
+        ucp_request_id_release(worker, sreq);
+    }
+
+    return status;
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_am_get_rndv_threshold(const ucp_request_t *req)
+{
+    const ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+
+    /* Same as tag rendezvous: RMA can be used for contiguous buffers only */
+    if (UCP_DT_IS_GENERIC(req->send.datatype)) {
+        return config->tag.rndv.am_thresh;
+    }
+
+    return ucs_min(config->tag.rndv.rma_thresh, config->tag.rndv.am_thresh);
 }
 
 static void ucp_am_send_req_init(ucp_request_t *req, ucp_ep_h ep,
+                                 const void *header, size_t header_length,
                                  const void *buffer, uintptr_t datatype,
-                                 size_t count, uint16_t flags, 
-                                 uint16_t am_id)
-{
-    req->flags                   = UCP_REQUEST_FLAG_SEND_AM;
-    req->send.ep                 = ep;
-    req->send.msg_proto.am.am_id = am_id;
-    req->send.msg_proto.am.flags = flags;
-    req->send.buffer             = (void *)buffer;
-    req->send.datatype           = datatype;
-    req->send.mem_type           = UCS_MEMORY_TYPE_HOST;
-    req->send.lane               = ep->am_lane;
+                                 size_t count, uint16_t flags,
+                                 uint16_t am_id, ucs_memory_type_t mem_type)
+{
+    req->flags                           = UCP_REQUEST_FLAG_SEND_AM;
+    req->send.ep                         = ep;
+    req->send.msg_proto.am.am_id         = am_id;
+    req->send.msg_proto.am.flags         = flags;
+    req->send.msg_proto.am.header        = header;
+    req->send.msg_proto.am.header_length = header_length;
+    req->send.buffer                     = (void *)buffer;
+    req->send.datatype                   = datatype;
+    req->send.lane                       = ep->am_lane;
 
     ucp_request_send_state_init(req, datatype, count);
     req->send.length = ucp_dt_length(req->send.datatype, count,
                                      req->send.buffer,
                                      &req->send.state.dt);
+    req->send.mem_type = (mem_type != UCS_MEMORY_TYPE_LAST) ? mem_type :
+                         ucp_memory_type_detect(ep->worker->context,
+                                                req->send.buffer,
+                                                req->send.length);
 }
 
 static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
 ucp_am_send_req(ucp_request_t *req, size_t count,
                 const ucp_ep_msg_config_t *msg_config,
-                ucp_send_callback_t cb, const ucp_request_send_proto_t *proto)
+                const ucp_request_param_t *param,
+                const ucp_request_send_proto_t *proto)
 {
-    
-    size_t zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
-                                                        count, SIZE_MAX);
-    ssize_t max_short   = ucp_am_get_short_max(req, msg_config);
+    size_t header_length = req->send.msg_proto.am.header_length;
+    size_t rndv_thresh   = ucp_am_get_rndv_threshold(req);
+    ucp_ep_msg_config_t hdr_msg_config;
+    ssize_t max_short;
+    size_t zcopy_thresh;
     ucs_status_t status;
-    
-    status = ucp_request_send_start(req, max_short, 
-                                    zcopy_thresh, SIZE_MAX,
-                                    count, msg_config,
-                                    proto);
-    if (status != UCS_OK) {
+
+    if (ucs_unlikely(header_length != 0)) {
+        /* The user header takes a part of every single-fragment message */
+        hdr_msg_config            = *msg_config;
+        hdr_msg_config.max_bcopy -= header_length;
+        hdr_msg_config.max_zcopy -= ucs_min(header_length,
+                                            hdr_msg_config.max_zcopy);
+        msg_config                = &hdr_msg_config;
+
+        /* The header has to fit the RTS packet */
+        if ((sizeof(ucp_rndv_rts_hdr_t) + header_length +
+             ucp_ep_config(req->send.ep)->tag.rndv.rkey_size) >
+            hdr_msg_config.max_bcopy) {
+            rndv_thresh = SIZE_MAX;
+        }
+    }
+
+    zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config, count,
+                                                 rndv_thresh);
+    if (ucs_unlikely((sizeof(ucp_am_long_hdr_t) + header_length) >
+                     ucp_ep_get_iface_attr(req->send.ep,
+                                           req->send.lane)->cap.am.max_hdr)) {
+        /* Zero-copy sends the user header inline, along with the UCP one */
+        zcopy_thresh = rndv_thresh;
+    }
+
+    max_short = ucp_am_get_short_max(req, msg_config);
+    status    = ucp_request_send_start(req, max_short,
+                                       zcopy_thresh, rndv_thresh,
+                                       count, msg_config,
+                                       proto);
+    if (status == UCS_ERR_NO_PROGRESS) {
+        /* RMA/AM rendezvous */
+        ucs_assert(req->send.length >= rndv_thresh);
+        status = ucp_am_send_start_rndv(req);
+        if (status != UCS_OK) {
+            return UCS_STATUS_PTR(status);
+        }
+
+        UCP_EP_STAT_TAG_OP(req->send.ep, RNDV);
+    } else if (status != UCS_OK) {
        return UCS_STATUS_PTR(status);
     }
 
@@ -398,41 +690,68 @@ ucp_am_send_req(ucp_request_t *req, size_t count,
     if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
         ucs_trace_req("releasing send request %p, returning status %s", req,
                       ucs_status_string(status));
-        ucp_request_put(req);
+        if (!(param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST)) {
+            ucp_request_put(req);
+        }
         return UCS_STATUS_PTR(status);
     }
 
-    ucp_request_set_callback(req, send.cb, (ucp_send_nbx_callback_t)cb);
-    
+    if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
+        req->user_data = (param->op_attr_mask & UCP_OP_ATTR_FIELD_USER_DATA) ?
+                         param->user_data : NULL;
+        ucp_request_set_callback(req, send.cb, param->cb.send);
+    }
+
     return req + 1;
 }
 
-UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_nb,
-                 (ep, id, payload, count, datatype, cb, flags),
-                 ucp_ep_h ep, uint16_t id, const void *payload, 
-                 size_t count, uintptr_t datatype, 
-                 ucp_send_callback_t cb, unsigned flags)
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_nbx,
+                 (ep, id, header, header_length, buffer, count, param),
+                 ucp_ep_h ep, unsigned id, const void *header,
+                 size_t header_length, const void *buffer, size_t count,
+                 const ucp_request_param_t *param)
 {
+    uint32_t flags = ucp_request_param_flags(param);
+    ucs_memory_type_t mem_type;
+    uintptr_t datatype;
     ucs_status_t status;
     ucs_status_ptr_t ret;
     ucp_request_t *req;
     size_t length;
-    
+
     UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_AM,
                                     return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
 
-    if (ucs_unlikely((flags != 0) && !(flags & UCP_AM_SEND_REPLY))) {
+    if (ENABLE_PARAMS_CHECK &&
+        ((flags & ~UCP_AM_SEND_REPLY) || (id > UINT16_MAX))) {
         return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
     }
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
 
-    if (ucs_likely(!(flags & UCP_AM_SEND_REPLY)) && 
-        (ucs_likely(UCP_DT_IS_CONTIG(datatype)))) {
+    if (ucs_unlikely((sizeof(ucp_am_long_hdr_t) + header_length) >=
+                     ucp_ep_config(ep)->am.max_bcopy)) {
+        ucs_error("ep %p: active message header length %zu is too large",
+                  ep, header_length);
+        ret = UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+        goto out;
+    }
+
+    datatype = (param->op_attr_mask & UCP_OP_ATTR_FIELD_DATATYPE) ?
+               param->datatype : ucp_dt_make_contig(1);
+    mem_type = (param->op_attr_mask & UCP_OP_ATTR_FIELD_MEMORY_TYPE) ?
+               param->memory_type : UCS_MEMORY_TYPE_LAST;
+
+    if (ucs_likely(!(flags & UCP_AM_SEND_REPLY) && (header_length == 0) &&
+                   UCP_DT_IS_CONTIG(datatype) &&
+                   !(param->op_attr_mask & UCP_OP_ATTR_FLAG_NO_IMM_CMPL) &&
+                   ((mem_type == UCS_MEMORY_TYPE_LAST) ?
+                    ucp_memory_type_cache_is_empty(ep->worker->context) :
+                    UCP_MEM_IS_ACCESSIBLE_FROM_CPU(mem_type)))) {
         length = ucp_contig_dt_length(datatype, count);
-        
+
         if (ucs_likely((ssize_t)length <= ucp_ep_config(ep)->am.max_short)) {
-            status = ucp_am_send_short(ep, id, payload, length);
+            status = ucp_am_send_short(ep, id, buffer, length);
             if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
                 UCP_EP_STAT_TAG_OP(ep, EAGER);
                 ret = UCS_STATUS_PTR(status);
@@ -441,24 +760,31 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_nb,
         }
     }
 
-    req = ucp_request_get(ep->worker, "am_send_nb");
-    if (ucs_unlikely(req == NULL)) {
-        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+    if (ucs_unlikely(param->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_RESOURCE);
         goto out;
     }
 
-    ucp_am_send_req_init(req, ep, payload, datatype, count, flags, id);
     status = ucp_ep_resolve_dest_ep_ptr(ep, ep->am_lane);
     if (ucs_unlikely(status != UCS_OK)) {
         ret = UCS_STATUS_PTR(status);
         goto out;
     }
 
+    req = ucp_request_get_param(ep->worker, param, "am_send_nbx",
+                                {
+                                    ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+                                    goto out;
+                                });
+
+    ucp_am_send_req_init(req, ep, header, header_length, buffer, datatype,
+                         count, flags, id, mem_type);
+
     if (flags & UCP_AM_SEND_REPLY) {
-        ret = ucp_am_send_req(req, count, &ucp_ep_config(ep)->am, cb,
+        ret = ucp_am_send_req(req, count, &ucp_ep_config(ep)->am, param,
                               ucp_ep_config(ep)->am_u.reply_proto);
     } else {
-        ret = ucp_am_send_req(req, count, &ucp_ep_config(ep)->am, cb,
+        ret = ucp_am_send_req(req, count, &ucp_ep_config(ep)->am, param,
                               ucp_ep_config(ep)->am_u.proto);
     }
 
@@ -467,33 +793,60 @@ out:
     return ret;
 }
 
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_nb,
+                 (ep, id, payload, count, datatype, cb, flags),
+                 ucp_ep_h ep, uint16_t id, const void *payload, 
+                 size_t count, uintptr_t datatype, 
+                 ucp_send_callback_t cb, unsigned flags)
+{
+    ucp_request_param_t param = {
+        .op_attr_mask = UCP_OP_ATTR_FIELD_DATATYPE |
+                        UCP_OP_ATTR_FIELD_CALLBACK |
+                        UCP_OP_ATTR_FIELD_FLAGS |
+                        UCP_OP_ATTR_FIELD_MEMORY_TYPE,
+        .cb.send      = (ucp_send_nbx_callback_t)cb,
+        .flags        = flags,
+        .datatype     = datatype,
+        .memory_type  = UCS_MEMORY_TYPE_HOST
+    };
+
+    if (ucs_unlikely((flags != 0) && !(flags & UCP_AM_SEND_REPLY))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    return ucp_am_send_nbx(ep, id, NULL, 0, payload, count, &param);
+}
+
 static ucs_status_t
 ucp_am_handler_common(ucp_worker_h worker, void *hdr_end,
-                      size_t hdr_size, size_t args_length,
-                      ucp_ep_h reply_ep, uint16_t am_id, 
-                      uint16_t desc_flag, unsigned am_flags) 
+                      size_t hdr_size, size_t total_length,
+                      ucp_ep_h reply_ep, uint16_t am_id,
+                      uint32_t user_hdr_length, uint16_t desc_flag,
+                      unsigned am_flags)
 {
+    void *data          = UCS_PTR_BYTE_OFFSET(hdr_end, user_hdr_length);
+    size_t data_length  = total_length - hdr_size - user_hdr_length;
+    void *user_hdr      = hdr_end;
     ucp_recv_desc_t *desc = NULL;
     uint16_t recv_flags = 0;
     ucs_status_t status;
 
-    if (ucs_unlikely((am_id >= worker->am_cb_array_len) ||
-                     (worker->am_cbs[am_id].cb == NULL))) {
-        ucs_warn("UCP Active Message was received with id : %u, but there" 
-                 "is no registered callback for that id", am_id);
+    if (ucs_unlikely(!ucp_am_is_cb_set(worker, am_id))) {
         return UCS_OK;
     }
 
     if (ucs_unlikely(am_flags & UCT_CB_PARAM_FLAG_DESC)) {
         recv_flags |= desc_flag;
+        if (user_hdr_length != 0) {
+            /* The descriptor is put in place of the user header */
+            user_hdr = ucs_alloca(user_hdr_length);
+            memcpy(user_hdr, hdr_end, user_hdr_length);
+        }
     }
 
-    /* TODO find way to do this without rewriting header if 
-     * UCT_CB_PARAM_FLAG_DESC flag is set
-     */
-    status = ucp_recv_desc_init(worker, hdr_end, hdr_size + args_length,
-                                0, am_flags, 0,
-                                recv_flags, 0, &desc);
+    status = ucp_recv_desc_init(worker, data, data_length, 0, am_flags,
+                                hdr_size + user_hdr_length, recv_flags, 0,
+                                &desc);
     if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
         ucs_error("worker %p  could not allocate descriptor for active message"
                   "on callback : %u", worker, am_id);
@@ -502,11 +855,8 @@ ucp_am_handler_common(ucp_worker_h worker, void *hdr_end,
 
     ucs_assert(desc != NULL);
 
-    status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
-                                      desc + 1,
-                                      args_length,
-                                      reply_ep,
-                                      UCP_CB_PARAM_FLAG_DATA);
+    status = ucp_am_invoke_cb_data(worker, am_id, user_hdr, user_hdr_length,
+                                   desc, data_length, reply_ep);
     if (ucs_unlikely(am_flags & UCT_CB_PARAM_FLAG_DESC)) {
         return status;
     }
@@ -535,10 +885,10 @@ ucp_am_handler_reply(void *am_arg, void *am_data, size_t am_length,
         return UCS_OK;
     }
  
-    return ucp_am_handler_common(worker, hdr + 1, sizeof(*hdr),
-                                 am_length - sizeof(*hdr), reply_ep,
-                                 am_id, UCP_RECV_DESC_FLAG_AM_REPLY, 
-                                 am_flags);
+    return ucp_am_handler_common(worker, hdr + 1, sizeof(*hdr), am_length,
+                                 reply_ep, am_id,
+                                 hdr->super.am_hdr.header_length,
+                                 UCP_RECV_DESC_FLAG_AM_REPLY, am_flags);
 }
 
 static ucs_status_t 
@@ -549,56 +899,59 @@ ucp_am_handler(void *am_arg, void *am_data, size_t am_length,
     ucp_am_hdr_t *hdr     = (ucp_am_hdr_t *)am_data;
     uint16_t am_id        = hdr->am_hdr.am_id;
 
-    return ucp_am_handler_common(worker, hdr + 1, sizeof(*hdr),
-                                 am_length - sizeof(*hdr), NULL,
-                                 am_id, UCP_RECV_DESC_FLAG_AM_HDR, 
-                                 am_flags);    
+    return ucp_am_handler_common(worker, hdr + 1, sizeof(*hdr), am_length,
+                                 NULL, am_id, hdr->am_hdr.header_length,
+                                 UCP_RECV_DESC_FLAG_AM_HDR, am_flags);
 }
 
-static ucp_am_unfinished_t *
-ucp_am_find_unfinished(ucp_worker_h worker, ucp_ep_h ep, 
-                       ucp_ep_ext_proto_t *ep_ext, 
-                       ucp_am_long_hdr_t *hdr, size_t am_length)
+/* Copy a fragment to the reassembly buffer, which holds the payload followed
+ * by the user header. Return the number of payload bytes copied. */
+static UCS_F_ALWAYS_INLINE size_t
+ucp_am_copy_fragment(ucp_recv_desc_t *all_data,
+                     const ucp_am_long_hdr_t *long_hdr, size_t am_length)
 {
-    ucp_am_unfinished_t *unfinished;
-    /* TODO make this hash table for faster lookup */
-    ucs_list_for_each(unfinished, &ep_ext->am.started_ams, list) {
-        if (unfinished->msg_id == hdr->msg_id) {
-            return unfinished;
-        }
+    const void *payload = long_hdr + 1;
+    size_t length       = am_length - sizeof(*long_hdr);
+
+    if (long_hdr->offset == 0) {
+        /* The first fragment carries the user header */
+        memcpy(UCS_PTR_BYTE_OFFSET(all_data + 1, long_hdr->total_size),
+               payload, long_hdr->header_length);
+        payload = UCS_PTR_BYTE_OFFSET(payload, long_hdr->header_length);
+        length -= long_hdr->header_length;
     }
-    
-    return NULL;
+
+    memcpy(UCS_PTR_BYTE_OFFSET(all_data + 1, long_hdr->offset), payload,
+           length);
+    return length;
 }
 
 static ucs_status_t
-ucp_am_handle_unfinished(ucp_worker_h worker,
-                         ucp_am_unfinished_t *unfinished, 
-                         ucp_am_long_hdr_t *long_hdr, 
-                         size_t am_length, ucp_ep_h reply_ep) 
+ucp_am_handle_unfinished(ucp_worker_h worker, khiter_t iter,
+                         ucp_am_long_hdr_t *long_hdr,
+                         size_t am_length, ucp_ep_h reply_ep)
 {
-    uint16_t am_id;
+    ucp_am_unfinished_t *unfinished = &kh_val(&worker->am_frag_hash, iter);
+    ucp_recv_desc_t *all_data       = unfinished->all_data;
     ucs_status_t status;
 
-    memcpy(UCS_PTR_BYTE_OFFSET(unfinished->all_data + 1, long_hdr->offset),
-           long_hdr + 1, am_length - sizeof(*long_hdr));
-    unfinished->left -= am_length - sizeof(*long_hdr);
-    if (unfinished->left == 0) {
-        am_id = long_hdr->am_id;
-        status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
-                                          unfinished->all_data + 1,
-                                          long_hdr->total_size,
-                                          reply_ep,
-                                          UCP_CB_PARAM_FLAG_DATA);
-
-        if (status != UCS_INPROGRESS) {
-            ucs_free(unfinished->all_data);
-        }
+    unfinished->left -= ucp_am_copy_fragment(all_data, long_hdr, am_length);
+    if (unfinished->left > 0) {
+        return UCS_OK;
+    }
+
+    /* Remove from the hash before the callback, which may send more AMs */
+    kh_del(ucp_am_frag_hash, &worker->am_frag_hash, iter);
 
-        ucs_list_del(&unfinished->list);
-        ucs_free(unfinished);
+    status = ucp_am_invoke_cb_data(worker, long_hdr->am_id,
+                                   UCS_PTR_BYTE_OFFSET(all_data + 1,
+                                                       long_hdr->total_size),
+                                   long_hdr->header_length, all_data,
+                                   long_hdr->total_size, reply_ep);
+    if (status != UCS_INPROGRESS) {
+        ucp_am_frag_desc_put(all_data);
     }
-    
+
     return UCS_OK;
 }
 
@@ -608,70 +961,52 @@ ucp_am_long_handler_common(void *am_arg, void *am_data, size_t am_length,
 {
     ucp_worker_h worker         = (ucp_worker_h)am_arg;
     ucp_am_long_hdr_t *long_hdr = (ucp_am_long_hdr_t *)am_data;
-    ucp_ep_ext_proto_t *ep_ext;
+    ucp_am_unfinished_t *unfinished;
     ucp_recv_desc_t *all_data;
-    size_t left;
+    khiter_t iter;
     ucp_ep_h ep;
-    ucp_am_unfinished_t *unfinished;
+    int ret;
 
     ep = ucp_worker_get_ep_by_ptr(worker, long_hdr->ep);
     if (ep == NULL) {
         return UCS_OK;
     }
 
-    ep_ext = ucp_ep_ext_proto(ep);
-
-    if (ucs_unlikely((long_hdr->am_id >= worker->am_cb_array_len) ||
-                     (worker->am_cbs[long_hdr->am_id].cb == NULL))) {
-        ucs_warn("UCP Active Message was received with id : %u, but there" 
-                 "is no registered callback for that id", long_hdr->am_id);
+    if (ucs_unlikely(!ucp_am_is_cb_set(worker, long_hdr->am_id))) {
         return UCS_OK;
     }
 
-    /* if there are multiple messages,
-     * we first check to see if any of the other messages
-     * have arrived. If any messages have arrived,
-     * we copy ourselves into the buffer and leave
+    /* If other fragments of this message have already arrived, copy this one
+     * to the common buffer; otherwise, allocate the buffer and add it to the
+     * hash, so the following fragments can find it.
      */
-    unfinished = ucp_am_find_unfinished(worker, ep, ep_ext, long_hdr, am_length);
-    
-    if (unfinished) {
-        return ucp_am_handle_unfinished(worker, unfinished, 
-                                        long_hdr, am_length,
-                                        reply_ep);
-    }
-    
-    /* If I am first, I make the buffer for everyone to go into,
-     * copy myself in, and put myself on the list so people can find me
-     */
-    all_data = ucs_malloc(long_hdr->total_size + sizeof(ucp_recv_desc_t),
-                          "ucp recv desc for long AM");
-    if (ucs_unlikely(all_data == NULL)) {
+    iter = kh_put(ucp_am_frag_hash, &worker->am_frag_hash, long_hdr->msg_id,
+                  &ret);
+    if (ucs_unlikely(ret < 0)) {
         return UCS_ERR_NO_MEMORY;
     }
 
-    all_data->flags = UCP_RECV_DESC_FLAG_MALLOC;
+    if (ret == 0) {
+        ucs_assert(kh_val(&worker->am_frag_hash, iter).ep == ep);
+        return ucp_am_handle_unfinished(worker, iter, long_hdr, am_length,
+                                        reply_ep);
+    }
 
-    left = long_hdr->total_size - (am_length -
-                                   sizeof(ucp_am_long_hdr_t));
-    
-    memcpy(UCS_PTR_BYTE_OFFSET(all_data + 1, long_hdr->offset),
-           long_hdr + 1, am_length - sizeof(ucp_am_long_hdr_t));
-    
-    /* Can't use a desc for this because of the buffer */
-    unfinished           = ucs_malloc(sizeof(ucp_am_unfinished_t),
-                                         "unfinished UCP AM");
-    if (ucs_unlikely(unfinished == NULL)) {
-        ucs_free(all_data);
+    all_data = ucp_am_frag_desc_get(worker, long_hdr->total_size +
+                                            long_hdr->header_length);
+    if (ucs_unlikely(all_data == NULL)) {
+        kh_del(ucp_am_frag_hash, &worker->am_frag_hash, iter);
         return UCS_ERR_NO_MEMORY;
     }
 
-    unfinished->all_data = all_data;
-    unfinished->left     = left;
-    unfinished->msg_id   = long_hdr->msg_id;
-
-    ucs_list_add_head(&ep_ext->am.started_ams, &unfinished->list);
+    all_data->length         = long_hdr->total_size;
+    all_data->payload_offset = 0;
 
+    unfinished           = &kh_val(&worker->am_frag_hash, iter);
+    unfinished->all_data = all_data;
+    unfinished->ep       = ep;
+    unfinished->left     = long_hdr->total_size -
+                           ucp_am_copy_fragment(all_data, long_hdr, am_length);
     return UCS_OK;
 }
 
@@ -699,6 +1034,306 @@ ucp_am_long_handler(void *am_arg, void *am_data, size_t am_length,
                                       NULL); 
 }
 
+static void ucp_am_rndv_recv_start(ucp_worker_h worker, ucp_request_t *req,
+                                   const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                                   uint64_t rts_seq, void *buffer,
+                                   size_t count, ucp_datatype_t datatype,
+                                   ucs_memory_type_t mem_type,
+                                   uint32_t req_flags,
+                                   ucp_am_recv_data_nbx_callback_t cb)
+{
+    req->flags              = UCP_REQUEST_FLAG_RECV | UCP_REQUEST_FLAG_RECV_AM |
+                              req_flags;
+    req->status             = UCS_OK;
+    req->recv.worker        = worker;
+    req->recv.buffer        = buffer;
+    req->recv.datatype      = datatype;
+    req->recv.req_id        = worker->rndv_req_id++;
+
+    ucp_dt_recv_state_init(&req->recv.state, buffer, datatype, count);
+
+    req->recv.length        = ucp_dt_length(datatype, count, buffer,
+                                            &req->recv.state);
+    req->recv.mem_type      = (mem_type != UCS_MEMORY_TYPE_LAST) ? mem_type :
+                              ucp_memory_type_detect(worker->context, buffer,
+                                                     req->recv.length);
+    req->recv.tag.am_cb     = cb;
+    req->recv.tag.rndv_req  = NULL;
+
+    ucp_rndv_matched(worker, req, rndv_rts_hdr, rts_seq);
+}
+
+static void ucp_am_rndv_recv_internal_completion(void *request,
+                                                 ucs_status_t status,
+                                                 size_t length,
+                                                 void *user_data)
+{
+    ucp_request_t *req     = (ucp_request_t*)request - 1;
+    ucp_worker_h worker    = req->recv.worker;
+    uint16_t am_id         = req->recv.tag.tag;
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t*)req->recv.buffer - 1;
+    ucp_ep_h reply_ep;
+
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucs_error("worker %p: failed to receive active message %u data: %s",
+                  worker, am_id, ucs_status_string(status));
+        goto out_free;
+    }
+
+    if (ucs_unlikely(!ucp_am_is_cb_set(worker, am_id))) {
+        goto out_free;
+    }
+
+    if (req->recv.tag.ep_ptr != 0) {
+        reply_ep = ucp_worker_get_ep_by_ptr(worker, req->recv.tag.ep_ptr);
+    } else {
+        reply_ep = NULL;
+    }
+
+    rdesc->length = length;
+    status        = ucp_am_invoke_cb_data(worker, am_id, NULL, 0, rdesc,
+                                          length, reply_ep);
+    if (status == UCS_INPROGRESS) {
+        /* released by ucp_am_data_release() */
+        return;
+    }
+
+out_free:
+    ucs_free(rdesc);
+}
+
+static ucs_status_t
+ucp_am_rndv_recv_internal(ucp_worker_h worker,
+                          const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                          uint64_t rts_seq)
+{
+    ucp_recv_desc_t *rdesc;
+    ucp_request_t *req;
+
+    /* The handler is not aware of rendezvous, so receive the whole message to
+     * an internal buffer and pass it to the handler once it is complete */
+    rdesc = ucs_malloc(rndv_rts_hdr->size + sizeof(ucp_recv_desc_t),
+                       "ucp recv desc for rndv AM");
+    if (ucs_unlikely(rdesc == NULL)) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    req = ucp_request_get(worker, "am_rndv_recv");
+    if (ucs_unlikely(req == NULL)) {
+        ucs_free(rdesc);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* tag matching fields are unused, so keep the handler id and the reply
+     * endpoint there until the data arrives */
+    rdesc->flags          = UCP_RECV_DESC_FLAG_MALLOC;
+    rdesc->length         = rndv_rts_hdr->size;
+    rdesc->payload_offset = 0;
+    req->user_data        = NULL;
+    req->recv.tag.tag     = rndv_rts_hdr->am.am_hdr.am_id;
+    req->recv.tag.ep_ptr  = (rndv_rts_hdr->am.am_hdr.flags & UCP_AM_SEND_REPLY) ?
+                            rndv_rts_hdr->sreq.ep_ptr : 0;
+
+    /* the request is released upon completion */
+    ucp_am_rndv_recv_start(worker, req, rndv_rts_hdr, rts_seq, rdesc + 1,
+                           rndv_rts_hdr->size, ucp_dt_make_contig(1),
+                           UCS_MEMORY_TYPE_HOST,
+                           UCP_REQUEST_FLAG_CALLBACK |
+                           UCP_REQUEST_FLAG_RELEASED,
+                           ucp_am_rndv_recv_internal_completion);
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucp_am_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                        unsigned am_flags)
+{
+    ucp_worker_h worker              = am_arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = am_data;
+    uint16_t am_id                   = rndv_rts_hdr->am.am_hdr.am_id;
+    uint32_t user_hdr_length         = rndv_rts_hdr->am.am_hdr.header_length;
+    uint64_t rts_seq                 = worker->rndv_rts_recv_seq++;
+    ucs_status_t status, desc_status;
+    ucp_recv_desc_t *desc;
+    ucp_ep_h reply_ep;
+
+    if (ucs_unlikely(!ucp_am_is_cb_set(worker, am_id))) {
+        ucp_rndv_send_ats(worker, rndv_rts_hdr, UCS_OK);
+        return UCS_OK;
+    }
+
+    if (!(worker->am_cbs[am_id].flags & UCP_AM_FLAG_RNDV)) {
+        status = ucp_am_rndv_recv_internal(worker, rndv_rts_hdr, rts_seq);
+        if (ucs_unlikely(status != UCS_OK)) {
+            ucp_rndv_send_ats(worker, rndv_rts_hdr, status);
+        }
+        return UCS_OK;
+    }
+
+    if (rndv_rts_hdr->am.am_hdr.flags & UCP_AM_SEND_REPLY) {
+        reply_ep = ucp_worker_get_ep_by_ptr(worker, rndv_rts_hdr->sreq.ep_ptr);
+    } else {
+        reply_ep = NULL;
+    }
+
+    /* The descriptor holds the RTS until the user receives or drops the data */
+    desc_status = ucp_recv_desc_init(worker, am_data, am_length, 0, am_flags,
+                                     sizeof(*rndv_rts_hdr),
+                                     UCP_RECV_DESC_FLAG_RNDV |
+                                     UCP_RECV_DESC_FLAG_AM_CB_INPROGRESS, 0,
+                                     &desc);
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(desc_status))) {
+        ucs_error("worker %p could not allocate descriptor for active message"
+                  " on callback : %u", worker, am_id);
+        ucp_rndv_send_ats(worker, rndv_rts_hdr, desc_status);
+        return UCS_OK;
+    }
+
+    desc->rndv_rts_seq = rts_seq;
+
+    /* The user header is at the end of the RTS, after the packed rkey */
+    status = ucp_am_invoke_cb(worker, am_id,
+                              UCS_PTR_BYTE_OFFSET(desc + 1,
+                                                  am_length - user_hdr_length),
+                              user_hdr_length, desc + 1, rndv_rts_hdr->size,
+                              reply_ep, 1);
+    desc->flags &= ~UCP_RECV_DESC_FLAG_AM_CB_INPROGRESS;
+
+    if (!(desc->flags & UCP_RECV_DESC_FLAG_AM_CONSUMED)) {
+        if (status == UCS_INPROGRESS) {
+            /* the user keeps the descriptor */
+            return desc_status;
+        }
+
+        /* the user did not ask for the data, so drop it */
+        ucp_rndv_send_ats(worker, rndv_rts_hdr, UCS_OK);
+    }
+
+    if (desc_status == UCS_INPROGRESS) {
+        /* let the transport release its own descriptor */
+        return UCS_OK;
+    }
+
+    ucp_recv_desc_release(desc);
+    return UCS_OK;
+}
+
+static ucs_status_ptr_t
+ucp_am_recv_data_eager(ucp_worker_h worker, ucp_recv_desc_t *desc,
+                       void *buffer, size_t count, ucp_datatype_t datatype,
+                       ucs_memory_type_t mem_type,
+                       const ucp_request_param_t *param)
+{
+    ucp_dt_state_t state;
+    ucs_status_t status;
+    size_t length;
+
+    if (mem_type == UCS_MEMORY_TYPE_LAST) {
+        ucp_dt_recv_state_init(&state, buffer, datatype, count);
+        length   = ucp_dt_length(datatype, count, buffer, &state);
+        mem_type = ucp_memory_type_detect(worker->context, buffer, length);
+    }
+
+    /* The data is already here, so unpack it and complete immediately */
+    status = ucp_dt_unpack_only(worker, buffer, count, datatype, mem_type,
+                                desc + 1, desc->length, 1);
+    if ((status == UCS_OK) &&
+        (param->op_attr_mask & UCP_OP_ATTR_FIELD_RECV_INFO)) {
+        *param->recv_info.length = desc->length;
+    }
+
+    if (desc->flags & UCP_RECV_DESC_FLAG_AM_CB_INPROGRESS) {
+        /* released by the handler after the user callback returns */
+        desc->flags |= UCP_RECV_DESC_FLAG_AM_CONSUMED;
+    } else {
+        ucp_am_data_release(worker, desc + 1);
+    }
+    return UCS_STATUS_PTR(status);
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_recv_data_nbx,
+                 (worker, data_desc, buffer, count, param),
+                 ucp_worker_h worker, void *data_desc, void *buffer,
+                 size_t count, const ucp_request_param_t *param)
+{
+    ucp_recv_desc_t *desc = (ucp_recv_desc_t*)data_desc - 1;
+    ucs_memory_type_t mem_type;
+    ucp_datatype_t datatype;
+    ucs_status_ptr_t ret;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    datatype = (param->op_attr_mask & UCP_OP_ATTR_FIELD_DATATYPE) ?
+               param->datatype : ucp_dt_make_contig(1);
+    mem_type = (param->op_attr_mask & UCP_OP_ATTR_FIELD_MEMORY_TYPE) ?
+               param->memory_type : UCS_MEMORY_TYPE_LAST;
+
+    if (!(desc->flags & UCP_RECV_DESC_FLAG_RNDV)) {
+        return ucp_am_recv_data_eager(worker, desc, buffer, count, datatype,
+                                      mem_type, param);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    req = ucp_request_get_param(worker, param, "am_recv_data_nbx",
+                                {
+                                    ucp_rndv_send_ats(worker, data_desc,
+                                                      UCS_ERR_NO_MEMORY);
+                                    ucp_am_rndv_desc_consume(desc);
+                                    ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+                                    goto out;
+                                });
+
+    ucp_am_rndv_recv_start(worker, req, data_desc, desc->rndv_rts_seq, buffer,
+                           count, datatype, mem_type, 0, NULL);
+    ucp_am_rndv_desc_consume(desc);
+
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        ret = UCS_STATUS_PTR(req->status);
+        if ((req->status == UCS_OK) &&
+            (param->op_attr_mask & UCP_OP_ATTR_FIELD_RECV_INFO)) {
+            *param->recv_info.length = req->recv.tag.info.length;
+        }
+        if (!(param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST)) {
+            ucp_request_put(req);
+        }
+    } else {
+        if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
+            req->user_data = (param->op_attr_mask & UCP_OP_ATTR_FIELD_USER_DATA) ?
+                             param->user_data : NULL;
+            ucp_request_set_callback(req, recv.tag.am_cb, param->cb.recv_am);
+        }
+        ret = req + 1;
+    }
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_recv_data_nb,
+                 (worker, data_desc, buffer, count, datatype, cb),
+                 ucp_worker_h worker, void *data_desc, void *buffer,
+                 size_t count, ucp_datatype_t datatype,
+                 ucp_am_recv_data_callback_t cb)
+{
+    ucp_recv_desc_t *desc     = (ucp_recv_desc_t*)data_desc - 1;
+    ucp_request_param_t param = {
+        .op_attr_mask = UCP_OP_ATTR_FIELD_DATATYPE |
+                        UCP_OP_ATTR_FIELD_CALLBACK,
+        .cb.recv_am   = (ucp_am_recv_data_nbx_callback_t)cb,
+        .datatype     = datatype
+    };
+
+    if (ucs_unlikely(!(desc->flags & UCP_RECV_DESC_FLAG_RNDV))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    return ucp_am_recv_data_nbx(worker, data_desc, buffer, count, &param);
+}
+
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE,
               ucp_am_handler, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI,
@@ -707,6 +1342,8 @@ UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE_REPLY,
               ucp_am_handler_reply, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI_REPLY,
               ucp_am_long_handler_reply, NULL, 0);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_RNDV_RTS,
+              ucp_am_rndv_rts_handler, NULL, 0);
 
 const ucp_request_send_proto_t ucp_am_proto = {
     .contig_short           = ucp_am_contig_short,
@@ -4,18 +4,29 @@
  * See file LICENSE for terms.
  */
 
+#ifndef UCP_AM_H_
+#define UCP_AM_H_
+
 #include "ucp_ep.h"
 
+#include <ucs/datastruct/khash.h>
+
 #define UCP_AM_CB_BLOCK_SIZE 16
 
+/* Size classes of the pools for reassembling multi-fragment AMs: 16KB..1MB.
+ * Larger messages are reassembled in malloc'ed buffers. */
+#define UCP_AM_FRAG_MP_MIN_SHIFT 14
+#define UCP_AM_FRAG_MP_COUNT     7
+
+
+/* Internal handler flag: the callback is ucp_am_recv_callback_t */
+#define UCP_AM_CB_PRIV_FLAG_NBX  UCS_BIT(15)
+
 
 typedef union {
     struct {
-        uint32_t     length;      /* length of an AM. Ideally it would be size_t
-                                   * but we want to keep this struct at 64 bits
-                                   * to fit in uct_ep_am_short header. MAX_SHORT
-                                   * or b/zcopy MTU
-                                   * should be much smaller than this anyway */
+        uint32_t     header_length; /* length of the user header, which
+                                     * follows this header */
         uint16_t     am_id;       /* Index into callback array */
         uint16_t     flags;       /* currently unused in this header 
                                      because replies require long header
@@ -38,16 +49,23 @@ typedef struct {
                                      of arrivals */
     size_t            offset;     /* how far this message goes into large
                                      the entire AM buffer */
+    uint32_t          header_length; /* length of the user header, which
+                                        follows the first fragment header */
     uint16_t          am_id;      /* index into callback array */
 } UCS_S_PACKED ucp_am_long_hdr_t;
 
 typedef struct {
-    ucs_list_link_t   list;       /* entry into list of unfinished AM's */
     ucp_recv_desc_t  *all_data;   /* buffer for all parts of the AM */
-    uint64_t          msg_id;     /* way to match up all parts of AM */
-    size_t            left;
+    ucp_ep_h          ep;         /* endpoint the AM is arriving on */
+    size_t            left;       /* number of bytes still expected */
 } ucp_am_unfinished_t;
 
-void ucp_am_ep_init(ucp_ep_h ep);
+
+/* Hash of partially arrived AMs, by message id */
+KHASH_INIT(ucp_am_frag_hash, uint64_t, ucp_am_unfinished_t, 1,
+           kh_int64_hash_func, kh_int64_hash_equal);
+
 
 void ucp_am_ep_cleanup(ucp_ep_h ep);
+
+#endif
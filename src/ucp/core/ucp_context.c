@@ -131,6 +131,12 @@ static ucs_config_field_t ucp_config_table[] = {
    "is zero or negative",
    ucs_offsetof(ucp_config_t, ctx.rndv_thresh_fallback), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"RNDV_THRESH_ADAPTIVE", "n",
+   "Adjust the rendezvous threshold at runtime, according to the measured completion\n"
+   "times of eager and rendezvous messages near the threshold.\n"
+   "Relevant only if UCX_RNDV_THRESH is set to \"auto\".",
+   ucs_offsetof(ucp_config_t, ctx.rndv_thresh_adaptive), UCS_CONFIG_TYPE_BOOL},
+
   {"RNDV_PERF_DIFF", "1",
    "The percentage allowed for performance difference between rendezvous and "
    "the eager_zcopy protocol",
@@ -238,6 +244,12 @@ static ucs_config_field_t ucp_config_table[] = {
    "mode will be used for messages sent with eager protocol only.",
    ucs_offsetof(ucp_config_t, ctx.tm_sw_rndv), UCS_CONFIG_TYPE_BOOL},
 
+  {"TM_SW_OFFLOAD", "n",
+   "Match tagged messages on a dedicated helper thread, when none of the\n"
+   "transports supports tag matching offload. The worker progress only completes\n"
+   "the matched requests, so a long unexpected queue does not stall it.",
+   ucs_offsetof(ucp_config_t, ctx.tm_sw_offload), UCS_CONFIG_TYPE_BOOL},
+
   {"NUM_EPS", "auto",
    "An optimization hint of how many endpoints would be created on this context.\n"
    "Does not affect semantics, but only transport selection criteria and the\n"
@@ -266,6 +278,13 @@ static ucs_config_field_t ucp_config_table[] = {
    "another thread, or incoming active messages, but consumes more resources.",
    ucs_offsetof(ucp_config_t, ctx.flush_worker_eps), UCS_CONFIG_TYPE_BOOL},
 
+  {"RMA_AGGR_THRESH", "64",
+   "Maximal size of a non-blocking put which is batched with other puts to the\n"
+   "same endpoint, when the remote memory is accessed by software emulation.\n"
+   "The batch is sent when it is full, or by a fence or a flush operation.\n"
+   "0 disables batching.",
+   ucs_offsetof(ucp_config_t, ctx.rma_aggr_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"UNIFIED_MODE", "n",
    "Enable various optimizations intended for homogeneous environment.\n"
    "Enabling this mode implies that the local transport resources/devices\n"
@@ -43,6 +43,8 @@ typedef struct ucp_context_config {
     /** Threshold for switching UCP to rendezvous protocol in case the calculated
      *  threshold is zero or negative */
     size_t                                 rndv_thresh_fallback;
+    /** Adjust the calculated rendezvous threshold at runtime */
+    int                                    rndv_thresh_adaptive;
     /** The percentage allowed for performance difference between rendezvous
      *  and the eager_zcopy protocol */
     double                                 rndv_perf_diff;
@@ -71,6 +73,8 @@ typedef struct ucp_context_config {
     size_t                                 tm_max_bb_size;
     /** Enabling SW rndv protocol with tag offload mode */
     int                                    tm_sw_rndv;
+    /** Match tags on a helper thread if there is no tag matching offload */
+    int                                    tm_sw_offload;
     /** Pack debug information in worker address */
     int                                    address_debug_info;
     /** Maximal size of worker name for debugging */
@@ -93,6 +97,8 @@ typedef struct ucp_context_config {
     int                                    enable_memtype_cache;
     /** Enable flushing endpoints while flushing a worker */
     int                                    flush_worker_eps;
+    /** Maximal size of a software RMA put which is batched with others */
+    size_t                                 rma_aggr_thresh;
     /** Enable optimizations suitable for homogeneous systems */
     int                                    unified_mode;
     /** Enable cm wireup-and-close protocol for client-server connections */
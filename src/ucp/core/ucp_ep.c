@@ -22,6 +22,7 @@
 #include <ucp/tag/offload.h>
 #include <ucp/tag/rndv.h>
 #include <ucp/stream/stream.h>
+#include <ucp/rma/rma.h>
 #include <ucp/core/ucp_listener.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/debug/memtrack_int.h>
@@ -33,6 +34,20 @@
 #include <ucp/tag/tag_match.inl>
 
 
+/* Minimal number of samples of each protocol to compare their cost */
+#define UCP_EP_RNDV_TUNE_WINDOW         32
+
+/* Relative cost difference below which the protocols are considered equal */
+#define UCP_EP_RNDV_TUNE_HYSTERESIS     0.1
+
+/* Number of windows in a row a protocol has to win to move the threshold */
+#define UCP_EP_RNDV_TUNE_VOTES          3
+
+/* Maximal number of steps the threshold can be moved from the calculated one;
+ * every step scales it by 5/4 up or 4/5 down */
+#define UCP_EP_RNDV_TUNE_MAX_LEVEL      12
+
+
 typedef struct {
     double reg_growth;
     double reg_overhead;
@@ -115,6 +130,7 @@ ucs_status_t ucp_ep_new(ucp_worker_h worker, const char *peer_name,
     ucp_ep_ext_gen(ep)->user_data   = NULL;
     ucp_ep_ext_gen(ep)->dest_ep_ptr = 0;
     ucp_ep_ext_gen(ep)->err_cb      = NULL;
+    ucp_ep_ext_gen(ep)->rma_aggr_req = NULL;
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen(ep)->ep_match) >=
                       sizeof(ucp_ep_ext_gen(ep)->listener));
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen(ep)->ep_match) >=
@@ -123,7 +139,6 @@ ucs_status_t ucp_ep_new(ucp_worker_h worker, const char *peer_name,
            sizeof(ucp_ep_ext_gen(ep)->ep_match));
 
     ucp_stream_ep_init(ep);
-    ucp_am_ep_init(ep);
 
     for (lane = 0; lane < UCP_MAX_LANES; ++lane) {
         ep->uct_eps[lane] = NULL;
@@ -784,6 +799,7 @@ static void ucp_destroyed_ep_pending_purge(uct_pending_req_t *self, void *arg)
 void ucp_ep_destroy_internal(ucp_ep_h ep)
 {
     ucs_debug("ep %p: destroy", ep);
+    ucp_rma_sw_aggr_cleanup(ep);
     ucp_ep_cleanup_lanes(ep);
     ucp_ep_delete(ep);
 }
@@ -840,6 +856,7 @@ static void ucp_ep_cleanup_unexp(ucp_ep_h ep)
 {
     ucp_tag_match_t *tm = &ep->worker->tm;
     const ucp_rndv_rts_hdr_t *rndv_rts_hdr;
+    ucp_tag_match_t *unexp_tm;
     const ucp_eager_middle_hdr_t *eager_mid_hdr;
     const ucp_eager_hdr_t *eager_hdr;
     ucp_recv_desc_t *rdesc, *tmp;
@@ -851,7 +868,8 @@ static void ucp_ep_cleanup_unexp(ucp_ep_h ep)
     ucs_debug("cleanup ep %p", ep);
 
     /* remove from unexpected queue */
-    ucs_list_for_each_safe(rdesc, tmp, &tm->unexpected.all,
+    unexp_tm = ucp_tag_offload_sw_unexp_get(ep->worker);
+    ucs_list_for_each_safe(rdesc, tmp, &unexp_tm->unexpected.all,
                            tag_list[UCP_RDESC_ALL_LIST]) {
         if (rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) {
             rndv_rts_hdr = (const void*)(rdesc + 1);
@@ -871,6 +889,7 @@ static void ucp_ep_cleanup_unexp(ucp_ep_h ep)
         ucp_tag_unexp_remove(rdesc);
         ucp_recv_desc_release(rdesc);
     }
+    ucp_tag_offload_sw_unexp_put(ep->worker);
 
     /* remove from fragments hash */
     kh_foreach_key(&tm->frag_hash, msg_id, {
@@ -1368,6 +1387,114 @@ static void ucp_ep_config_set_am_rndv_thresh(ucp_worker_h worker,
               config->tag.rndv.am_thresh, config->tag.rndv_send_nbr.am_thresh);
 }
 
+static size_t ucp_ep_rndv_tune_thresh(size_t base, int level, size_t min_thresh)
+{
+    size_t thresh = base;
+    int i;
+
+    if (base == SIZE_MAX) {
+        return SIZE_MAX;
+    }
+
+    for (i = 0; i < level; ++i) {
+        thresh += thresh / 4;
+    }
+    for (i = 0; i > level; --i) {
+        thresh -= thresh / 5;
+    }
+
+    return ucs_max(thresh, min_thresh);
+}
+
+static void ucp_ep_config_rndv_tune_init(ucp_worker_h worker,
+                                         ucp_ep_config_t *config)
+{
+    ucp_context_h context    = worker->context;
+    ucp_ep_rndv_tune_t *tune = &config->tag.rndv.tune;
+
+    /* Tune only the calculated thresholds, and only if the messages are
+     * matched in software, so the eager protocol does not depend on
+     * receive-side offload resources */
+    tune->enabled         = context->config.ext.rndv_thresh_adaptive &&
+                            (context->config.ext.rndv_thresh ==
+                             UCS_MEMUNITS_AUTO) &&
+                            !ucp_ep_is_tag_offload_enabled(config) &&
+                            (ucs_min(config->tag.rndv.rma_thresh,
+                                     config->tag.rndv.am_thresh) != SIZE_MAX);
+    tune->base_rma_thresh = config->tag.rndv.rma_thresh;
+    tune->base_am_thresh  = config->tag.rndv.am_thresh;
+    tune->min_thresh      = ucp_ep_tag_offload_min_rndv_thresh(config);
+    tune->level           = 0;
+    tune->votes           = 0;
+    tune->num_sends       = 0;
+    tune->num_updates     = 0;
+    tune->num_samples[0]  = tune->num_samples[1] = 0;
+    tune->cost[0]         = tune->cost[1]        = 0;
+}
+
+static void ucp_ep_config_rndv_tune_set_level(ucp_ep_config_t *config,
+                                              int level)
+{
+    ucp_ep_rndv_tune_t *tune = &config->tag.rndv.tune;
+
+    tune->level                 = level;
+    tune->votes                 = 0;
+    config->tag.rndv.rma_thresh = ucp_ep_rndv_tune_thresh(tune->base_rma_thresh,
+                                                          level,
+                                                          tune->min_thresh);
+    config->tag.rndv.am_thresh  = ucp_ep_rndv_tune_thresh(tune->base_am_thresh,
+                                                          level,
+                                                          tune->min_thresh);
+    ++tune->num_updates;
+
+    ucs_debug("ep_cfg %p: rndv threshold moved to rma %zu am %zu (level %d)",
+              config, config->tag.rndv.rma_thresh, config->tag.rndv.am_thresh,
+              level);
+}
+
+void ucp_ep_config_rndv_tune_sample(ucp_ep_config_t *config, size_t length,
+                                    int is_rndv, ucs_time_t elapsed)
+{
+    ucp_ep_rndv_tune_t *tune = &config->tag.rndv.tune;
+    double eager_cost, rndv_cost;
+
+    if (!tune->enabled || (length == 0)) {
+        return;
+    }
+
+    is_rndv              = !!is_rndv;
+    tune->cost[is_rndv] += (double)elapsed / length;
+    ++tune->num_samples[is_rndv];
+
+    if ((tune->num_samples[0] < UCP_EP_RNDV_TUNE_WINDOW) ||
+        (tune->num_samples[1] < UCP_EP_RNDV_TUNE_WINDOW)) {
+        return;
+    }
+
+    eager_cost = tune->cost[0] / tune->num_samples[0];
+    rndv_cost  = tune->cost[1] / tune->num_samples[1];
+
+    tune->num_samples[0] = tune->num_samples[1] = 0;
+    tune->cost[0]        = tune->cost[1]        = 0;
+
+    if (rndv_cost * (1.0 + UCP_EP_RNDV_TUNE_HYSTERESIS) < eager_cost) {
+        tune->votes = ucs_max(tune->votes, 0) + 1;
+    } else if (eager_cost * (1.0 + UCP_EP_RNDV_TUNE_HYSTERESIS) < rndv_cost) {
+        tune->votes = ucs_min(tune->votes, 0) - 1;
+    } else {
+        tune->votes = 0;
+    }
+
+    if ((tune->votes >= UCP_EP_RNDV_TUNE_VOTES) &&
+        (tune->level > -UCP_EP_RNDV_TUNE_MAX_LEVEL)) {
+        /* Rendezvous is cheaper, use it for smaller messages */
+        ucp_ep_config_rndv_tune_set_level(config, tune->level - 1);
+    } else if ((tune->votes <= -UCP_EP_RNDV_TUNE_VOTES) &&
+               (tune->level < UCP_EP_RNDV_TUNE_MAX_LEVEL)) {
+        ucp_ep_config_rndv_tune_set_level(config, tune->level + 1);
+    }
+}
+
 static void ucp_ep_config_set_rndv_thresh(ucp_worker_t *worker,
                                           ucp_ep_config_t *config,
                                           ucp_lane_index_t *lanes,
@@ -1539,6 +1666,7 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
     size_t rma_zcopy_thresh;
     double rndv_max_bw, scale, bw;
     ucs_status_t status;
+    int need_memh;
     size_t it;
 
     memset(config, 0, sizeof(*config));
@@ -1801,6 +1929,8 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
             ucp_ep_config_set_am_rndv_thresh(worker, iface_attr, md_attr, config,
                                              min_am_rndv_thresh,
                                              max_am_rndv_thresh);
+
+            ucp_ep_config_rndv_tune_init(worker, config);
         } else {
             /* Stub endpoint */
             config->am.max_bcopy        = UCP_MIN_BCOPY;
@@ -1831,6 +1961,10 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
 
         if (rsc_index != UCP_NULL_RESOURCE) {
             iface_attr = ucp_worker_iface_get_attr(worker, rsc_index);
+            /* Vector RMA posts user buffers as zcopy IOVs without registering
+             * them, so it can do it only if memory handles are not needed */
+            need_memh  = context->tl_mds[config->md_index[lane]].attr.cap.flags &
+                         UCT_MD_FLAG_NEED_MEMH;
             /* PUT */
             if (iface_attr->cap.flags & UCT_IFACE_FLAG_PUT_SHORT) {
                 rma_config->max_put_short = iface_attr->cap.put.max_short;
@@ -1848,6 +1982,9 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
                 }
                 rma_config->put_zcopy_thresh = ucs_max(rma_config->put_zcopy_thresh,
                                                        iface_attr->cap.put.min_zcopy);
+                if (!need_memh) {
+                    rma_config->max_put_iov  = iface_attr->cap.put.max_iov;
+                }
             }
             if (iface_attr->cap.flags & UCT_IFACE_FLAG_PUT_BCOPY) {
                 rma_config->max_put_bcopy = ucs_min(iface_attr->cap.put.max_bcopy,
@@ -1870,6 +2007,9 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
                 }
                 rma_config->get_zcopy_thresh = ucs_max(rma_config->get_zcopy_thresh,
                                                        iface_attr->cap.get.min_zcopy);
+                if (!need_memh) {
+                    rma_config->max_get_iov  = iface_attr->cap.get.max_iov;
+                }
             }
             if (iface_attr->cap.flags & UCT_IFACE_FLAG_GET_BCOPY) {
                 rma_config->max_get_bcopy = ucs_min(iface_attr->cap.get.max_bcopy,
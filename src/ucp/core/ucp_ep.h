@@ -16,6 +16,7 @@
 #include <ucs/stats/stats.h>
 #include <ucs/datastruct/strided_alloc.h>
 #include <ucs/debug/assert.h>
+#include <ucs/time/time_def.h>
 
 
 #define UCP_MAX_IOV                16UL
@@ -53,6 +54,8 @@ enum {
     UCP_EP_FLAG_CLOSE_REQ_VALID        = UCS_BIT(11),/* close protocol is started and
                                                         close_req is valid */
     UCP_EP_FLAG_ERR_HANDLER_INVOKED    = UCS_BIT(12),/* error handler was called */
+    UCP_EP_FLAG_STREAM_NOTIFIED        = UCS_BIT(13),/* EP was reported by edge-triggered
+                                                        stream poll and has data */
 
     /* DEBUG bits */
     UCP_EP_FLAG_CONNECT_REQ_SENT       = UCS_BIT(16),/* DEBUG: Connection request was sent */
@@ -168,6 +171,11 @@ typedef struct ucp_ep_rma_config {
     size_t                 max_get_zcopy;
     size_t                 put_zcopy_thresh;
     size_t                 get_zcopy_thresh;
+    size_t                 max_put_iov;      /* Maximal number of put_zcopy IOVs
+                                                without a memory handle, 0 if
+                                                the lane needs a memory handle */
+    size_t                 max_get_iov;      /* Maximal number of get_zcopy IOVs
+                                                without a memory handle */
 } ucp_ep_rma_config_t;
 
 
@@ -201,6 +209,39 @@ typedef struct ucp_memtype_thresh {
 } ucp_memtype_thresh_t;
 
 
+/* Messages up to this factor smaller or larger than the rendezvous threshold
+ * are sampled by the threshold tuning */
+#define UCP_EP_RNDV_TUNE_RANGE             4
+
+/* Every Nth sampled message is sent by the protocol which is not selected by
+ * the current threshold */
+#define UCP_EP_RNDV_TUNE_EXPLORE_INTERVAL  8
+
+
+/*
+ * Runtime tuning of the eager/rendezvous crossover point. Completion times of
+ * messages around the current threshold are sampled, and the threshold is
+ * moved towards the protocol which is cheaper per byte, once it wins several
+ * sampling windows in a row.
+ */
+typedef struct ucp_ep_rndv_tune {
+    size_t             base_rma_thresh; /* RMA threshold calculated on init */
+    size_t             base_am_thresh;  /* AM threshold calculated on init */
+    size_t             min_thresh;      /* Lowest allowed threshold */
+    int                enabled;         /* Whether tuning is active */
+    int                level;           /* Current step from the base */
+    int                votes;           /* Windows won in a row: >0 by
+                                           rendezvous, <0 by eager */
+    unsigned           num_sends;       /* Sends near the threshold */
+    unsigned           num_samples[2];  /* Eager/rendezvous samples in the
+                                           current window */
+    double             cost[2];         /* Accumulated time per byte of
+                                           eager/rendezvous samples */
+    unsigned           num_updates;     /* How many times the threshold
+                                           was moved */
+} ucp_ep_rndv_tune_t;
+
+
 typedef struct ucp_ep_config {
 
     /* A key which uniquely defines the configuration, and all other fields of
@@ -270,6 +311,8 @@ typedef struct ucp_ep_config {
             ucp_lane_index_t put_zcopy_lanes[UCP_MAX_LANES];
             /* BW based scale factor */
             double           scale[UCP_MAX_LANES];
+            /* Runtime adjustment of the rendezvous thresholds */
+            ucp_ep_rndv_tune_t tune;
         } rndv;
 
         /* special thresholds for the ucp_tag_send_nbr() */
@@ -358,6 +401,8 @@ typedef struct {
     void                          *user_data;    /* User data associated with ep */
     ucs_list_link_t               ep_list;       /* List entry in worker's all eps list */
     ucp_err_handler_cb_t          err_cb;        /* Error handler */
+    ucp_request_t                 *rma_aggr_req; /* Small software RMA puts
+                                                    which are not sent yet */
 
     /* Endpoint match context and remote completion status are mutually exclusive,
      * since remote completions are counted only after the endpoint is already
@@ -380,11 +425,11 @@ typedef struct {
         ucs_list_link_t           ready_list;    /* List entry in worker's EP list */
         ucs_queue_head_t          match_q;       /* Queue of receive data or requests,
                                                     depends on UCP_EP_FLAG_STREAM_HAS_DATA */
+        ucs_queue_head_t          rndv_q;        /* Data which arrived while rndv_req
+                                                    is in progress */
+        ucp_request_t             *rndv_req;     /* Rendezvous receive to an internal
+                                                    buffer, which blocks rndv_q */
     } stream;
-
-    struct {
-        ucs_list_link_t           started_ams;
-    } am;
 } ucp_ep_ext_proto_t;
 
 
@@ -514,6 +559,9 @@ unsigned ucp_ep_local_disconnect_progress(void *arg);
 
 size_t ucp_ep_tag_offload_min_rndv_thresh(ucp_ep_config_t *config);
 
+void ucp_ep_config_rndv_tune_sample(ucp_ep_config_t *config, size_t length,
+                                    int is_rndv, ucs_time_t elapsed);
+
 void ucp_ep_invoke_err_cb(ucp_ep_h ep, ucs_status_t status);
 
 int ucp_ep_config_test_rndv_support(const ucp_ep_config_t *config);
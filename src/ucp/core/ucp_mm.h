@@ -41,6 +41,15 @@ enum {
                                                    and must be retuned to pool, not free */
 };
 
+
+/**
+ * Flags of the operations issued with a remote key, for per-key flush
+ */
+enum {
+    UCP_RKEY_FLUSH_FLAG_SW        = UCS_BIT(0), /* Software operations were sent */
+    UCP_RKEY_FLUSH_FLAG_SW_AGGR   = UCS_BIT(1)  /* Puts were added to a batch */
+};
+
 /**
  * Remote memory key structure.
  * Contains remote keys for UCT MDs.
@@ -59,6 +68,13 @@ typedef struct ucp_rkey {
         ucp_amo_proto_t           *amo_proto;   /* Protocol for AMOs */
         ucp_rma_proto_t           *rma_proto;   /* Protocol for RMAs */
     } cache;
+    /* operations issued with the key, flushed by ucp_ep_rkey_flush_nb() */
+    struct {
+        uint32_t                  sw_sn;        /* Flush sequence number of the
+                                                   last software operation */
+        ucp_lane_map_t            lanes;        /* Lanes the key was used on */
+        uint8_t                   flags;        /* UCP_RKEY_FLUSH_FLAG_xx */
+    } flush;
     ucp_md_map_t                  md_map;       /* Which *remote* MDs have valid memory handles */
     ucs_memory_type_t             mem_type;     /* Memory type of remote key memory */
     uint8_t                       flags;        /* Rkey flags */
@@ -201,6 +217,8 @@ ucp_memh2uct(ucp_mem_h memh, ucp_md_index_t md_idx)
             ucs_error("remote memory is unreachable (remote md_map 0x%lx)", \
                       (_rkey)->md_map); \
             _status_nc = UCS_ERR_UNREACHABLE; \
+        } else { \
+            (_rkey)->flush.lanes |= UCS_BIT((_rkey)->cache._op_type##_lane); \
         } \
         _status_nc; \
     })
@@ -146,6 +146,12 @@ ucp_request_release_common(void *request, uint8_t cb_flag, const char *debug_nam
     ucs_assert(!(flags & UCP_REQUEST_FLAG_RELEASED));
 
     if (ucs_likely(flags & UCP_REQUEST_FLAG_COMPLETED)) {
+        if (ucs_unlikely(flags & UCP_REQUEST_FLAG_PERSISTENT) &&
+            !(flags & UCP_REQUEST_FLAG_RECV)) {
+            /* release the registration cached by a persistent send */
+            ucp_request_memory_dereg(worker->context, req->send.datatype,
+                                     &req->send.state.dt, req);
+        }
         ucp_request_put(req);
     } else {
         req->flags = (flags | UCP_REQUEST_FLAG_RELEASED) & ~cb_flag;
@@ -166,6 +172,38 @@ UCS_PROFILE_FUNC_VOID(ucp_request_free, (request), void *request)
     ucp_request_release_common(request, UCP_REQUEST_FLAG_CALLBACK, "free");
 }
 
+UCS_PROFILE_FUNC(ucs_status_t, ucp_request_start, (request), void *request)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+    ucp_worker_h UCS_V_UNUSED worker = ucs_container_of(ucs_mpool_obj_owner(req),
+                                                        ucp_worker_t, req_mp);
+    ucs_status_t status;
+
+    if (ENABLE_PARAMS_CHECK && !(req->flags & UCP_REQUEST_FLAG_PERSISTENT)) {
+        ucs_error("request %p is not persistent", req);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if (!(req->flags & UCP_REQUEST_FLAG_COMPLETED)) {
+        /* previous operation is still in progress */
+        return UCS_ERR_BUSY;
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("start persistent request %p (%p) "UCP_REQUEST_FLAGS_FMT,
+                  req, req + 1, UCP_REQUEST_FLAGS_ARG(req->flags));
+
+    if (req->flags & UCP_REQUEST_FLAG_RECV) {
+        status = ucp_tag_recv_persistent_start(req);
+    } else {
+        status = ucp_tag_send_persistent_start(req);
+    }
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return status;
+}
+
 UCS_PROFILE_FUNC(void*, ucp_request_alloc,
                  (worker),
                  ucp_worker_h worker)
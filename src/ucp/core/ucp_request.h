@@ -49,6 +49,11 @@ enum {
     UCP_REQUEST_FLAG_CANCELED             = UCS_BIT(17),
     UCP_REQUEST_FLAG_RNDV_MATCHED         = UCS_BIT(18),
     UCP_REQUEST_FLAG_FLUSH                = UCS_BIT(19),
+    UCP_REQUEST_FLAG_PERSISTENT           = UCS_BIT(20),
+    UCP_REQUEST_FLAG_SW_OFFLOADED         = UCS_BIT(21),
+    UCP_REQUEST_FLAG_RNDV_TUNE            = UCS_BIT(22),
+    UCP_REQUEST_FLAG_ID                   = UCS_BIT(23),
+    UCP_REQUEST_FLAG_RECV_AM              = UCS_BIT(24),
 #if UCS_ENABLE_ASSERT
     UCP_REQUEST_FLAG_STREAM_RECV          = UCS_BIT(29),
     UCP_REQUEST_DEBUG_FLAG_EXTERNAL       = UCS_BIT(30),
@@ -92,7 +97,12 @@ enum {
                                                        uct and the ucp level am header must
                                                        be accounted for when releasing
                                                        descriptors */
-    UCP_RECV_DESC_FLAG_AM_REPLY       = UCS_BIT(9)  /* AM that needed a reply */
+    UCP_RECV_DESC_FLAG_AM_REPLY       = UCS_BIT(9), /* AM that needed a reply */
+    UCP_RECV_DESC_FLAG_AM_CB_INPROGRESS = UCS_BIT(10), /* AM callback is in progress */
+    UCP_RECV_DESC_FLAG_AM_CONSUMED    = UCS_BIT(11) /* AM rendezvous descriptor was
+                                                       consumed from the callback,
+                                                       and must be released once
+                                                       the callback returns */
 };
 
 
@@ -112,6 +122,9 @@ struct ucp_request {
     ucs_status_t                  status;  /* Operation status */
     uint32_t                      flags;   /* Request flags */
     void                          *user_data;
+    uint64_t                      id;      /* ID by which the remote peer
+                                              refers to the request, valid if
+                                              UCP_REQUEST_FLAG_ID is set */
 
     union {
 
@@ -144,6 +157,8 @@ struct ucp_request {
                     struct {
                         uint16_t         am_id;
                         unsigned         flags;
+                        uint32_t         header_length; /* user header length */
+                        const void       *header;       /* user header */
                     } am;
                 } msg_proto;
 
@@ -152,6 +167,22 @@ struct ucp_request {
                     ucp_rkey_h    rkey;     /* Remote memory key */
                 } rma;
 
+                /* Strided or indexed RMA; send.buffer is the first local
+                 * block, send.length is the number of blocks and
+                 * send.state.dt.offset is the next block to post */
+                struct {
+                    ucp_rkey_h          rkey;          /* Remote memory key */
+                    const ucp_rma_iov_t *iov;          /* Indexed blocks, or NULL
+                                                          for strided blocks */
+                    ucp_rma_iov_t       *iov_copy;     /* Indexed blocks owned
+                                                          by the request */
+                    uint64_t            remote_addr;   /* Remote address of the
+                                                          first strided block */
+                    ptrdiff_t           stride;        /* Local stride */
+                    ptrdiff_t           remote_stride; /* Remote stride */
+                    size_t              block_size;    /* Strided block size */
+                } rma_vec;
+
                 struct {
                     uintptr_t     remote_request; /* pointer to the send request on receiver side */
                     ucp_request_t *sreq;       /* original send request of frag put */
@@ -202,6 +233,8 @@ struct ucp_request {
                 struct {
                     ucp_request_callback_t flushed_cb;/* Called when flushed */
                     ucp_request_t          *worker_req;
+                    ucp_rkey_h             rkey;      /* Flush only the operations
+                                                         with this key, or NULL */
                     ucs_queue_elem_t       queue;     /* Queue element in proto_status */
                     unsigned               uct_flags; /* Flags to pass to @ref uct_ep_flush */
                     uct_worker_cb_id_t     prog_id;   /* Progress callback ID */
@@ -210,6 +243,7 @@ struct ucp_request {
                     uint8_t                sw_started;
                     uint8_t                sw_done;
                     uint8_t                num_lanes; /* How many lanes are being flushed */
+                    ucp_lane_map_t         lane_map;  /* Which lanes to flush */
                     ucp_lane_map_t         started_lanes;/* Which lanes need were flushed */
                 } flush;
 
@@ -217,13 +251,36 @@ struct ucp_request {
                     uct_worker_cb_id_t        prog_id;/* Slow-path callback */
                 } disconnect;
 
+                /* send.length is the packed size of the batch */
+                struct {
+                    ucp_mem_desc_t    *mdesc;    /* Buffer of the batched puts */
+                    ucs_list_link_t   list;      /* Entry in worker's list of
+                                                    batches which are not sent */
+                } rma_aggr;
+
                 struct {
                     uint64_t              remote_addr; /* Remote address */
                     ucp_rkey_h            rkey;        /* Remote memory key */
-                    uint64_t              value;       /* Atomic argument */
+                    union {
+                        uint64_t          value;       /* Atomic argument */
+                        uint64_t          value128[2]; /* 128-bit argument */
+                    };
                     uct_atomic_op_t       uct_op;      /* Requested UCT AMO */
                 } amo;
 
+                /* Vector of atomic operations; send.length is the number of
+                 * operations and send.state.dt.offset is the next one to post */
+                struct {
+                    ucp_rkey_h                rkey;        /* Remote memory key */
+                    const ucp_atomic_vec_op_t *ops;        /* Operations */
+                    ucp_atomic_vec_op_t       *ops_copy;   /* Operations owned
+                                                              by the request */
+                    size_t                    op_size;     /* Operand size */
+                    size_t                    batch_count; /* Operations packed
+                                                              to the message
+                                                              being sent */
+                } amo_vec;
+
                 struct {
                     ucs_queue_elem_t  queue;     /* Elem in outgoing ssend reqs queue */
                     ucp_tag_t         ssend_tag; /* Tag in offload sync send */
@@ -260,6 +317,20 @@ struct ucp_request {
             };
 
             ucp_mem_desc_t        *mdesc;
+
+            /* Setup of a persistent request, kept across restarts */
+            struct {
+                ucp_tag_t          tag;          /* Tag to send */
+                size_t             dt_count;     /* Datatype element count */
+                size_t             zcopy_thresh; /* Cached zcopy threshold */
+                size_t             rndv_thresh;  /* Cached rendezvous threshold */
+                uint32_t           flags;        /* Protocol selection flags */
+                ucp_ep_cfg_index_t cfg_index;    /* Endpoint configuration the
+                                                    thresholds were taken from */
+            } persist;
+
+            ucs_time_t            tune_start; /* Send start time, sampled by the
+                                                 rendezvous threshold tuning */
         } send;
 
         /* "receive" part - used for tag_recv and stream_recv operations */
@@ -275,12 +346,24 @@ struct ucp_request {
             unsigned              prev_flags;
             uint64_t              req_id;
 
+            /* Setup of a persistent request, kept across restarts */
+            struct {
+                size_t            dt_count; /* Datatype element count */
+                ucs_memory_type_t mem_type; /* Detected buffer memory type */
+            } persist;
+
             union {
                 struct {
                     ucp_tag_t               tag;      /* Expected tag */
                     ucp_tag_t               tag_mask; /* Expected tag mask */
                     uint64_t                sn;       /* Tag match sequence */
-                    ucp_tag_recv_callback_t cb;       /* Completion callback */
+                    union {
+                        ucp_tag_recv_nbx_callback_t cb;    /* Completion callback */
+                        ucp_am_recv_data_nbx_callback_t am_cb; /* Completion
+                                                           callback of AM
+                                                           rendezvous data
+                                                           receive */
+                    };
                     ucp_tag_recv_info_t     info;     /* Completion info to fill */
                     ssize_t                 remaining; /* How much more data to be received */
 
@@ -292,6 +375,8 @@ struct ucp_request {
                                                                 multi-fragment
                                                                 non-contig unexpected
                                                                 message in tag offload flow. */
+                        ucp_recv_desc_t     *sw_rdesc; /* Descriptor matched by
+                                                          software tag offload */
                     };
                     ucp_worker_iface_t      *wiface;  /* Cached iface this request
                                                          is received on. Used in
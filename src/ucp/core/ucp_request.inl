@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_worker.h>
 #include <ucp/dt/dt.h>
 #include <ucs/profile/profile.h>
+#include <ucs/time/time.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucp/dt/dt.inl>
 #include <inttypes.h>
@@ -113,6 +114,44 @@ ucp_request_put(ucp_request_t *req)
     ucs_mpool_put_inline(req);
 }
 
+
+/*
+ * Assign an ID to the request, so that the remote peer can refer to it. The
+ * ID is released when the request is completed.
+ */
+static UCS_F_ALWAYS_INLINE void
+ucp_request_id_alloc(ucp_worker_h worker, ucp_request_t *req)
+{
+    ucs_assert(!(req->flags & UCP_REQUEST_FLAG_ID));
+    req->id     = ucs_ptr_array_id_insert(&worker->req_ids, req);
+    req->flags |= UCP_REQUEST_FLAG_ID;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_request_id_release(ucp_worker_h worker, ucp_request_t *req)
+{
+    ucs_assert(req->flags & UCP_REQUEST_FLAG_ID);
+    ucs_ptr_array_id_remove(&worker->req_ids, req->id);
+    req->flags &= ~UCP_REQUEST_FLAG_ID;
+}
+
+/*
+ * Find a request by the ID received from the remote peer.
+ * Return NULL if the request was already released.
+ */
+static UCS_F_ALWAYS_INLINE ucp_request_t*
+ucp_request_get_by_id(ucp_worker_h worker, uint64_t id)
+{
+    ucp_request_t *req;
+
+    if (ucs_unlikely(!ucs_ptr_array_id_lookup(&worker->req_ids, id, req) ||
+                     (req->id != id))) {
+        return NULL;
+    }
+
+    return req;
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_request_complete_send(ucp_request_t *req, ucs_status_t status)
 {
@@ -120,6 +159,16 @@ ucp_request_complete_send(ucp_request_t *req, ucs_status_t status)
                   req, req + 1, UCP_REQUEST_FLAGS_ARG(req->flags),
                   ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(req, "complete_send", status);
+    if (req->flags & UCP_REQUEST_FLAG_ID) {
+        ucp_request_id_release(req->send.ep->worker, req);
+    }
+    if (ucs_unlikely(req->flags & UCP_REQUEST_FLAG_RNDV_TUNE) &&
+        (status == UCS_OK)) {
+        ucp_ep_config_rndv_tune_sample(ucp_ep_config(req->send.ep),
+                                       req->send.length,
+                                       req->flags & UCP_REQUEST_FLAG_SEND_RNDV,
+                                       ucs_get_time() - req->send.tune_start);
+    }
     ucp_request_complete(req, send.cb, status, req->user_data);
 }
 
@@ -144,18 +193,21 @@ ucp_request_complete_tag_recv(ucp_worker_h worker, ucp_request_t *req,
      }
 
     UCS_PROFILE_REQUEST_EVENT(req, "complete_recv", status);
-    ucp_request_complete(req, recv.tag.cb, status, &req->recv.tag.info);
+    if (ucs_unlikely(req->flags & UCP_REQUEST_FLAG_RECV_AM)) {
+        /* AM or stream rendezvous data receive, see ucp_am_recv_data_nbx() */
+        ucp_request_complete(req, recv.tag.am_cb, status,
+                             req->recv.tag.info.length, req->user_data);
+        return;
+    }
+
+    ucp_request_complete(req, recv.tag.cb, status, &req->recv.tag.info,
+                         req->user_data);
 }
 
 static UCS_F_ALWAYS_INLINE void
-ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
-                                 ucs_status_t status)
+ucp_request_complete_stream_recv_dequeued(ucp_request_t *req,
+                                          ucs_status_t status)
 {
-    /* dequeue request before complete */
-    ucp_request_t *check_req UCS_V_UNUSED =
-            ucs_queue_pull_elem_non_empty(&ep_ext->stream.match_q, ucp_request_t,
-                                          recv.queue);
-    ucs_assert(check_req               == req);
     ucs_assert((req->recv.stream.offset > 0) || UCS_STATUS_IS_ERR(status));
 
     req->recv.stream.length = req->recv.stream.offset;
@@ -167,6 +219,18 @@ ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
     ucp_request_complete(req, recv.stream.cb, status, req->recv.stream.length);
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
+                                 ucs_status_t status)
+{
+    /* dequeue request before complete */
+    ucp_request_t *check_req UCS_V_UNUSED =
+            ucs_queue_pull_elem_non_empty(&ep_ext->stream.match_q, ucp_request_t,
+                                          recv.queue);
+    ucs_assert(check_req               == req);
+    ucp_request_complete_stream_recv_dequeued(req, status);
+}
+
 static UCS_F_ALWAYS_INLINE int
 ucp_request_can_complete_stream_recv(ucp_request_t *req)
 {
@@ -452,6 +516,15 @@ ucp_request_recv_buffer_reg(ucp_request_t *req, ucp_md_map_t md_map,
 
 static UCS_F_ALWAYS_INLINE void ucp_request_send_buffer_dereg(ucp_request_t *req)
 {
+    if (ucs_unlikely((req->flags & (UCP_REQUEST_FLAG_PERSISTENT |
+                                    UCP_REQUEST_FLAG_RELEASED)) ==
+                     UCP_REQUEST_FLAG_PERSISTENT) &&
+        UCP_DT_IS_CONTIG(req->send.datatype)) {
+        /* keep the registration for the next start of a persistent request,
+         * it is released when the request is freed */
+        return;
+    }
+
     ucp_request_memory_dereg(req->send.ep->worker->context, req->send.datatype,
                              &req->send.state.dt, req);
 }
@@ -595,6 +668,8 @@ ucp_recv_desc_release(ucp_recv_desc_t *rdesc)
         uct_iface_release_desc(UCS_PTR_BYTE_OFFSET(rdesc,
                                                    -(UCP_WORKER_HEADROOM_PRIV_SIZE -
                                                      rdesc->priv_length)));
+    } else if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC)) {
+        ucs_free(rdesc);
     } else {
         ucs_mpool_put_inline(rdesc);
     }
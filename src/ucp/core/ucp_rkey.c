@@ -228,6 +228,9 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_ep_rkey_unpack, (ep, rkey_buffer, rkey_p),
     rkey->md_map   = md_map;
     rkey->mem_type = mem_type;
     rkey->flags    = flags;
+    rkey->flush.sw_sn = 0;
+    rkey->flush.lanes = 0;
+    rkey->flush.flags = 0;
 #if ENABLE_PARAMS_CHECK
     rkey->ep       = ep;
 #endif
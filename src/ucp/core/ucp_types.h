@@ -92,6 +92,13 @@ enum {
     UCP_AM_ID_SINGLE_REPLY      =  25, /* For user defined AM when a reply
                                           is needed */
     UCP_AM_ID_MULTI_REPLY       =  26,
+    UCP_AM_ID_AM_RNDV_RTS       =  27, /* Ready-to-Send of a user defined AM
+                                          which is sent with rendezvous */
+    UCP_AM_ID_STREAM_RNDV_RTS   =  28, /* Ready-to-Send of a STREAM send
+                                          which is sent with rendezvous */
+    UCP_AM_ID_PUT_BATCH         =  29, /* Batch of small remote memory writes */
+    UCP_AM_ID_ATOMIC_BATCH_REQ  =  30, /* Batch of remote memory atomic requests */
+    UCP_AM_ID_ATOMIC_BATCH_REP  =  31, /* Reply to a batch of atomic requests */
     UCP_AM_ID_LAST
 };
 
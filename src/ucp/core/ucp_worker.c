@@ -19,6 +19,7 @@
 #include <ucp/wireup/wireup_ep.h>
 #include <ucp/tag/eager.h>
 #include <ucp/tag/offload.h>
+#include <ucp/tag/offload_sw.h>
 #include <ucp/stream/stream.h>
 #include <ucs/config/parser.h>
 #include <ucs/datastruct/mpool.inl>
@@ -1562,6 +1563,43 @@ static void ucp_worker_print_used_tls(const ucp_ep_config_key_t *key,
     ucs_info("%s", info);
 }
 
+static void ucp_worker_cleanup_am_frag_mpools(ucp_worker_h worker,
+                                              unsigned count, int leak_check)
+{
+    unsigned i;
+
+    for (i = 0; i < count; ++i) {
+        ucs_mpool_cleanup(&worker->am_frag_mps[i], leak_check);
+    }
+}
+
+static ucs_status_t ucp_worker_init_am_frag_mpools(ucp_worker_h worker)
+{
+    size_t       elem_size;
+    ucs_status_t status;
+    unsigned     i;
+
+    if (!(worker->context->config.features & UCP_FEATURE_AM)) {
+        return UCS_OK;
+    }
+
+    /* Buffers are allocated on first use, so unused size classes cost nothing */
+    for (i = 0; i < UCP_AM_FRAG_MP_COUNT; ++i) {
+        elem_size = sizeof(ucp_recv_desc_t) +
+                    UCS_BIT(UCP_AM_FRAG_MP_MIN_SHIFT + i);
+        status    = ucs_mpool_init(&worker->am_frag_mps[i], 0, elem_size, 0,
+                                   UCS_SYS_CACHE_LINE_SIZE,
+                                   ucs_max(UCS_MBYTE / elem_size, 1), UINT_MAX,
+                                   &ucp_am_mpool_ops, "ucp_am_frag_bufs");
+        if (status != UCS_OK) {
+            ucp_worker_cleanup_am_frag_mpools(worker, i, 0);
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
 static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
 {
     size_t           max_mp_entry_size = 0;
@@ -1604,8 +1642,15 @@ static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
         goto err_release_reg_mpool;
     }
 
+    status = ucp_worker_init_am_frag_mpools(worker);
+    if (status != UCS_OK) {
+        goto err_release_frag_mpool;
+    }
+
     return UCS_OK;
 
+err_release_frag_mpool:
+    ucs_mpool_cleanup(&worker->rndv_frag_mp, 0);
 err_release_reg_mpool:
     ucs_mpool_cleanup(&worker->reg_mp, 0);
 err_release_am_mpool:
@@ -1745,9 +1790,11 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     ucs_list_head_init(&worker->stream_ready_eps);
     ucs_list_head_init(&worker->all_eps);
     kh_init_inplace(ucp_worker_ep_ptrs, &worker->ep_ptrs);
-    kh_init_inplace(ucp_worker_rndv_req_ptrs, &worker->rndv_req_ptrs);
+    kh_init_inplace(ucp_am_frag_hash, &worker->am_frag_hash);
+    ucs_ptr_array_init(&worker->req_ids, 0, "ucp_req_ids");
     ucp_ep_match_init(&worker->ep_match_ctx);
     ucs_list_head_init(&worker->rndv_reqs_list);
+    ucs_list_head_init(&worker->rma_aggr_reqs);
 
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen_t) <= sizeof(ucp_ep_t));
     if (context->config.features & (UCP_FEATURE_STREAM | UCP_FEATURE_AM)) {
@@ -1864,6 +1911,12 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     /* Select atomic resources */
     ucp_worker_init_atomic_tls(worker);
 
+    /* Start software tag matching, if there is no tag offload */
+    status = ucp_tag_offload_sw_init(worker);
+    if (status != UCS_OK) {
+        goto err_close_cms;
+    }
+
     /* At this point all UCT memory domains and interfaces are already created
      * so print used environment variables and warn about unused ones.
      */
@@ -1896,8 +1949,9 @@ err_free_stats:
     UCS_STATS_NODE_FREE(worker->stats);
 err_free:
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
-    kh_destroy_inplace(ucp_worker_rndv_req_ptrs, &worker->rndv_req_ptrs);
+    ucs_ptr_array_cleanup(&worker->req_ids);
     kh_destroy_inplace(ucp_worker_ep_ptrs, &worker->ep_ptrs);
+    kh_destroy_inplace(ucp_am_frag_hash, &worker->am_frag_hash);
     ucs_free(worker);
     return status;
 }
@@ -1934,10 +1988,14 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucp_worker_close_cms(worker);
     UCS_ASYNC_UNBLOCK(&worker->async);
 
+    ucp_tag_offload_sw_cleanup(worker);
     ucp_worker_destroy_ep_configs(worker);
     ucs_mpool_cleanup(&worker->am_mp, 1);
     ucs_mpool_cleanup(&worker->reg_mp, 1);
     ucs_mpool_cleanup(&worker->rndv_frag_mp, 1);
+    if (worker->context->config.features & UCP_FEATURE_AM) {
+        ucp_worker_cleanup_am_frag_mpools(worker, UCP_AM_FRAG_MP_COUNT, 1);
+    }
     ucp_worker_close_ifaces(worker);
     ucp_tag_match_cleanup(&worker->tm);
     ucp_worker_wakeup_cleanup(worker);
@@ -1945,8 +2003,9 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucs_mpool_cleanup(&worker->req_mp, 1);
     uct_worker_destroy(worker->uct);
     ucs_async_context_cleanup(&worker->async);
-    kh_destroy_inplace(ucp_worker_rndv_req_ptrs, &worker->rndv_req_ptrs);
+    ucs_ptr_array_cleanup(&worker->req_ids);
     kh_destroy_inplace(ucp_worker_ep_ptrs, &worker->ep_ptrs);
+    kh_destroy_inplace(ucp_am_frag_hash, &worker->am_frag_hash);
     ucp_ep_match_cleanup(&worker->ep_match_ctx);
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
     UCS_STATS_NODE_FREE(worker->tm_offload_stats);
@@ -2033,6 +2092,10 @@ ssize_t ucp_stream_worker_poll(ucp_worker_h worker,
     while ((count < max_eps) && !ucs_list_is_empty(&worker->stream_ready_eps)) {
         ep_ext                    = ucp_stream_worker_dequeue_ep_head(worker);
         ep                        = ucp_ep_from_ext_proto(ep_ext);
+        if (flags & UCP_STREAM_POLL_FLAG_EDGE_TRIGGERED) {
+            /* do not report again until all data is consumed */
+            ep->flags            |= UCP_EP_FLAG_STREAM_NOTIFIED;
+        }
         poll_eps[count].ep        = ep;
         poll_eps[count].user_data = ucp_ep_ext_gen(ep)->user_data;
         ++count;
@@ -2096,6 +2159,12 @@ ucs_status_t ucp_worker_arm(ucp_worker_h worker)
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
 
+    /* Endpoints with stream data are waiting for ucp_stream_worker_poll() */
+    if (!ucs_list_is_empty(&worker->stream_ready_eps)) {
+        status = UCS_ERR_BUSY;
+        goto out_unlock;
+    }
+
     /* Go over arm_list of active interfaces which support events and arm them */
     ucs_list_for_each(wiface, &worker->arm_ifaces, arm_list) {
         ucs_assert(wiface->activate_count > 0);
@@ -2222,6 +2291,10 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
     size_t address_length;
     ucs_status_t status;
     ucp_rsc_index_t rsc_index;
+    ucp_ep_config_t *ep_config;
+    ucp_ep_rndv_tune_t *tune;
+    char rma_str[32], am_str[32];
+    unsigned cfg_index;
     int first;
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
@@ -2254,6 +2327,24 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
         fprintf(stream, "\n");
     }
 
+    if (context->config.features & UCP_FEATURE_TAG) {
+        for (cfg_index = 0; cfg_index < worker->ep_config_count; ++cfg_index) {
+            ep_config = &worker->ep_config[cfg_index];
+            tune      = &ep_config->tag.rndv.tune;
+            ucs_memunits_to_str(ep_config->tag.rndv.rma_thresh, rma_str,
+                                sizeof(rma_str));
+            ucs_memunits_to_str(ep_config->tag.rndv.am_thresh, am_str,
+                                sizeof(am_str));
+            fprintf(stream, "#          rndv_thresh[%u]: rma %s am %s", cfg_index,
+                    rma_str, am_str);
+            if (tune->enabled) {
+                fprintf(stream, " (adaptive, level %d, %u updates)",
+                        tune->level, tune->num_updates);
+            }
+            fprintf(stream, "\n");
+        }
+    }
+
     fprintf(stream, "#\n");
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
@@ -9,12 +9,14 @@
 #define UCP_WORKER_H_
 
 #include "ucp_ep.h"
+#include "ucp_am.h"
 #include "ucp_context.h"
 #include "ucp_thread.h"
 
 #include <ucp/tag/tag_match.h>
 #include <ucp/wireup/ep_match.h>
 #include <ucs/datastruct/mpool.h>
+#include <ucs/datastruct/ptr_array.h>
 #include <ucs/datastruct/queue_types.h>
 #include <ucs/datastruct/strided_alloc.h>
 #include <ucs/arch/bitops.h>
@@ -193,13 +195,15 @@ struct ucp_worker_cm {
  * Data that is stored about each callback registered with a worker
  */
 typedef struct ucp_worker_am_entry {
-    ucp_am_callback_t     cb;
+    union {
+        ucp_am_callback_t      cb;
+        ucp_am_recv_callback_t cb_nbx; /* if UCP_AM_CB_PRIV_FLAG_NBX is set */
+    };
     void                 *context;
     uint32_t              flags;
 } ucp_worker_am_entry_t;
 
 KHASH_SET_INIT_INT64(ucp_worker_ep_ptrs)
-KHASH_MAP_INIT_INT64(ucp_worker_rndv_req_ptrs, uintptr_t)
 
 /**
  * UCP worker (thread context).
@@ -231,8 +235,9 @@ typedef struct ucp_worker {
     ucs_list_link_t               all_eps;       /* List of all endpoints */
 
     khash_t(ucp_worker_ep_ptrs)   ep_ptrs;
-    khash_t(ucp_worker_rndv_req_ptrs) rndv_req_ptrs;
-    uint64_t                          rndv_req_id;
+    ucs_ptr_array_t               req_ids;       /* Requests which are referred
+                                                    by remote peers, by ID */
+    uint64_t                      rndv_req_id;
 
     uint64_t                      rndv_rts_send_seq;
     uint64_t                      rndv_rts_recv_seq;
@@ -252,7 +257,12 @@ typedef struct ucp_worker {
     uct_worker_cb_id_t            rkey_ptr_cb_id;/* RKEY PTR worker callback queue ID */
     ucp_tag_match_t               tm;            /* Tag-matching queues and offload info */
     ucs_list_link_t               rndv_reqs_list;
+    ucs_list_link_t               rma_aggr_reqs; /* Batches of small software
+                                                    RMA puts which are not sent */
     uint64_t                      am_message_id; /* For matching long am's */
+    khash_t(ucp_am_frag_hash)     am_frag_hash;  /* Long AMs being reassembled */
+    ucs_mpool_t                   am_frag_mps[UCP_AM_FRAG_MP_COUNT]; /* Size-classed
+                                                    pools for long AM reassembly */
     ucp_ep_h                      mem_type_ep[UCS_MEMORY_TYPE_LAST];/* memory type eps */
 
     UCS_STATS_NODE_DECLARE(stats)
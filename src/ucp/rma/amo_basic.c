@@ -97,8 +97,75 @@ static ucs_status_t ucp_amo_basic_progress_fetch(uct_pending_req_t *self)
     return ucp_amo_check_send_status(req, status);
 }
 
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_amo_basic_vec_op(ucp_request_t *req, uct_ep_h uct_ep, uct_rkey_t uct_rkey,
+                     const ucp_atomic_vec_op_t *op)
+{
+    uct_completion_t *comp = &req->send.state.uct_comp;
+    uct_atomic_op_t uct_op = ucp_uct_fop_table[op->opcode];
+
+    if (req->send.amo_vec.op_size == sizeof(uint64_t)) {
+        if (op->result == NULL) {
+            return uct_ep_atomic64_post(uct_ep, uct_op, op->value,
+                                        op->remote_addr, uct_rkey);
+        } else if (uct_op != UCT_ATOMIC_OP_CSWAP) {
+            return uct_ep_atomic64_fetch(uct_ep, uct_op, op->value, op->result,
+                                         op->remote_addr, uct_rkey, comp);
+        } else {
+            return uct_ep_atomic_cswap64(uct_ep, op->value,
+                                         *(uint64_t*)op->result,
+                                         op->remote_addr, uct_rkey, op->result,
+                                         comp);
+        }
+    } else {
+        ucs_assert(req->send.amo_vec.op_size == sizeof(uint32_t));
+        if (op->result == NULL) {
+            return uct_ep_atomic32_post(uct_ep, uct_op, op->value,
+                                        op->remote_addr, uct_rkey);
+        } else if (uct_op != UCT_ATOMIC_OP_CSWAP) {
+            return uct_ep_atomic32_fetch(uct_ep, uct_op, op->value, op->result,
+                                         op->remote_addr, uct_rkey, comp);
+        } else {
+            return uct_ep_atomic_cswap32(uct_ep, op->value,
+                                         *(uint32_t*)op->result,
+                                         op->remote_addr, uct_rkey, op->result,
+                                         comp);
+        }
+    }
+}
+
+static ucs_status_t ucp_amo_basic_progress_vec(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_rkey_h rkey    = req->send.amo_vec.rkey;
+    ucp_ep_t *ep       = req->send.ep;
+    const ucp_atomic_vec_op_t *op;
+    ucs_status_t status;
+    uct_ep_h uct_ep;
+
+    req->send.lane = rkey->cache.amo_lane;
+    uct_ep         = ep->uct_eps[req->send.lane];
+
+    while (req->send.state.dt.offset < req->send.length) {
+        op     = &req->send.amo_vec.ops[req->send.state.dt.offset];
+        status = ucp_amo_basic_vec_op(req, uct_ep, rkey->cache.amo_rkey, op);
+        if (status == UCS_INPROGRESS) {
+            ++req->send.state.uct_comp.count;
+        } else if (status == UCS_ERR_NO_RESOURCE) {
+            return status;
+        } else if (status != UCS_OK) {
+            return ucp_rma_vec_request_posted(req, status);
+        }
+
+        ++req->send.state.dt.offset;
+    }
+
+    return ucp_rma_vec_request_posted(req, UCS_OK);
+}
+
 ucp_amo_proto_t ucp_amo_basic_proto = {
     .name           = "basic_amo",
     .progress_fetch = ucp_amo_basic_progress_fetch,
-    .progress_post  = ucp_amo_basic_progress_post
+    .progress_post  = ucp_amo_basic_progress_post,
+    .progress_vec   = ucp_amo_basic_progress_vec
 };
@@ -14,8 +14,10 @@
 
 #include <ucp/core/ucp_mm.h>
 #include <ucp/core/ucp_ep.inl>
+#include <ucp/dt/dt_contig.h>
 #include <ucs/profile/profile.h>
 #include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
 #include <ucs/sys/stubs.h>
 
 #include <inttypes.h>
@@ -57,7 +59,7 @@ static uct_atomic_op_t ucp_uct_op_table[] = {
     [UCP_ATOMIC_POST_OP_XOR]    = UCT_ATOMIC_OP_XOR
 };
 
-static uct_atomic_op_t ucp_uct_fop_table[] = {
+uct_atomic_op_t ucp_uct_fop_table[] = {
     [UCP_ATOMIC_FETCH_OP_FADD]  = UCT_ATOMIC_OP_ADD,
     [UCP_ATOMIC_FETCH_OP_FAND]  = UCT_ATOMIC_OP_AND,
     [UCP_ATOMIC_FETCH_OP_FOR]   = UCT_ATOMIC_OP_OR,
@@ -67,6 +69,26 @@ static uct_atomic_op_t ucp_uct_fop_table[] = {
 };
 
 
+static uct_atomic_op_t ucp_uct_atomic_op_table[] = {
+    [UCP_ATOMIC_OP_ADD]         = UCT_ATOMIC_OP_ADD,
+    [UCP_ATOMIC_OP_SWAP]        = UCT_ATOMIC_OP_SWAP,
+    [UCP_ATOMIC_OP_CSWAP]       = UCT_ATOMIC_OP_CSWAP,
+    [UCP_ATOMIC_OP_AND]         = UCT_ATOMIC_OP_AND,
+    [UCP_ATOMIC_OP_OR]          = UCT_ATOMIC_OP_OR,
+    [UCP_ATOMIC_OP_XOR]         = UCT_ATOMIC_OP_XOR
+};
+
+/* Operations applied to an array of remote values */
+static ucp_atomic_fetch_op_t ucp_atomic_bulk_op_table[] = {
+    [UCP_ATOMIC_OP_ADD]         = UCP_ATOMIC_FETCH_OP_FADD,
+    [UCP_ATOMIC_OP_SWAP]        = UCP_ATOMIC_FETCH_OP_SWAP,
+    [UCP_ATOMIC_OP_CSWAP]       = UCP_ATOMIC_FETCH_OP_LAST,
+    [UCP_ATOMIC_OP_AND]         = UCP_ATOMIC_FETCH_OP_FAND,
+    [UCP_ATOMIC_OP_OR]          = UCP_ATOMIC_FETCH_OP_FOR,
+    [UCP_ATOMIC_OP_XOR]         = UCP_ATOMIC_FETCH_OP_FXOR
+};
+
+
 static void ucp_amo_completed_single(uct_completion_t *self,
                                      ucs_status_t status)
 {
@@ -76,6 +98,19 @@ static void ucp_amo_completed_single(uct_completion_t *self,
     ucp_request_complete_send(req, status);
 }
 
+void ucp_amo_vec_request_completion(uct_completion_t *self,
+                                    ucs_status_t status)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t,
+                                          send.state.uct_comp);
+
+    if (ucs_likely(req->send.length == req->send.state.dt.offset)) {
+        ucp_trace_req(req, "invoking completion");
+        ucs_free(req->send.amo_vec.ops_copy);
+        ucp_request_complete_send(req, status);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_amo_init_common(ucp_request_t *req, ucp_ep_h ep, uct_atomic_op_t op,
                     uint64_t remote_addr, ucp_rkey_h rkey, uint64_t value,
@@ -115,6 +150,29 @@ void ucp_amo_init_post(ucp_request_t *req, ucp_ep_h ep, uct_atomic_op_t op,
     req->send.uct.func = proto->progress_post;
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_amo_init_vec(ucp_request_t *req, ucp_ep_h ep,
+                 const ucp_atomic_vec_op_t *ops, size_t count, size_t op_size,
+                 ucp_rkey_h rkey)
+{
+    req->flags                       = 0;
+    req->send.ep                     = ep;
+    req->send.length                 = count;
+    req->send.amo_vec.rkey           = rkey;
+    req->send.amo_vec.ops            = ops;
+    req->send.amo_vec.ops_copy       = NULL;
+    req->send.amo_vec.op_size        = op_size;
+    req->send.amo_vec.batch_count    = 0;
+    req->send.state.dt.offset        = 0;
+    req->send.state.uct_comp.count   = 0;
+    req->send.state.uct_comp.status  = UCS_OK;
+    req->send.state.uct_comp.func    = ucp_amo_vec_request_completion;
+    req->send.uct.func               = rkey->cache.amo_proto->progress_vec;
+#if UCS_ENABLE_ASSERT
+    req->send.lane                   = UCP_NULL_LANE;
+#endif
+}
+
 ucs_status_ptr_t ucp_atomic_fetch_nb(ucp_ep_h ep, ucp_atomic_fetch_op_t opcode,
                                      uint64_t value, void *result, size_t op_size,
                                      uint64_t remote_addr, ucp_rkey_h rkey,
@@ -200,6 +258,227 @@ out:
     return status;
 }
 
+ucs_status_ptr_t ucp_atomic_vec_nb(ucp_ep_h ep, const ucp_atomic_vec_op_t *ops,
+                                   size_t count, size_t op_size,
+                                   ucp_rkey_h rkey, ucp_send_callback_t cb)
+{
+    ucs_status_ptr_t status_p;
+    ucs_status_t status;
+    ucp_request_t *req;
+    size_t i;
+
+    for (i = 0; i < count; ++i) {
+        UCP_AMO_CHECK_PARAM(ep->worker->context, ops[i].remote_addr, op_size,
+                            ops[i].opcode, UCP_ATOMIC_FETCH_OP_LAST,
+                            return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+        if (ENABLE_PARAMS_CHECK && (ops[i].result == NULL) &&
+            ((ops[i].opcode == UCP_ATOMIC_FETCH_OP_SWAP) ||
+             (ops[i].opcode == UCP_ATOMIC_FETCH_OP_CSWAP))) {
+            ucs_error("atomic swap operation %zu requires a result buffer", i);
+            return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+        }
+    }
+
+    if (count == 0) {
+        return NULL;
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ucs_trace_req("atomic_vec_nb ops %p count %zu size %zu rkey %p to %s cb %p",
+                  ops, count, op_size, rkey, ucp_ep_peer_name(ep), cb);
+
+    status = UCP_RKEY_RESOLVE(rkey, ep, amo);
+    if (status != UCS_OK) {
+        status_p = UCS_STATUS_PTR(UCS_ERR_UNREACHABLE);
+        goto out;
+    }
+
+    req = ucp_request_get(ep->worker, "atomic_vec_nb");
+    if (ucs_unlikely(NULL == req)) {
+        status_p = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    ucp_amo_init_vec(req, ep, ops, count, op_size, rkey);
+    status_p = ucp_rma_send_request_cb(req, (ucp_send_nbx_callback_t)cb);
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status_p;
+}
+
+static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
+ucp_amo_send_request_param(ucp_request_t *req, const ucp_request_param_t *param)
+{
+    ucs_status_t status = ucp_request_send(req, 0);
+
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        ucs_trace_req("releasing send request %p, returning status %s", req,
+                      ucs_status_string(status));
+        if (!(param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST)) {
+            ucp_request_put(req);
+        }
+        return UCS_STATUS_PTR(status);
+    }
+
+    if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
+        req->user_data = (param->op_attr_mask & UCP_OP_ATTR_FIELD_USER_DATA) ?
+                         param->user_data : NULL;
+        ucp_request_set_callback(req, send.cb, param->cb.send);
+    }
+
+    ucs_trace_req("returning request %p, status %s", req,
+                  ucs_status_string(status));
+    return req + 1;
+}
+
+static ucs_status_t
+ucp_amo_init_bulk(ucp_request_t *req, ucp_ep_h ep, ucp_atomic_op_t opcode,
+                  const void *buffer, size_t count, size_t op_size,
+                  uint64_t remote_addr, ucp_rkey_h rkey, void *reply_buffer)
+{
+    ucp_atomic_vec_op_t *ops;
+    size_t i;
+
+    ops = ucs_malloc(count * sizeof(*ops), "ucp_atomic_bulk");
+    if (ops == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    for (i = 0; i < count; ++i) {
+        ops[i].opcode      = ucp_atomic_bulk_op_table[opcode];
+        ops[i].value       = (op_size == sizeof(uint32_t)) ?
+                             ((const uint32_t*)buffer)[i] :
+                             ((const uint64_t*)buffer)[i];
+        ops[i].remote_addr = remote_addr + (i * op_size);
+        ops[i].result      = (reply_buffer == NULL) ? NULL :
+                             UCS_PTR_BYTE_OFFSET(reply_buffer, i * op_size);
+    }
+
+    ucp_amo_init_vec(req, ep, ops, count, op_size, rkey);
+    req->send.amo_vec.ops_copy = ops;
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_atomic_op_nbx,
+                 (ep, opcode, buffer, count, remote_addr, rkey, param),
+                 ucp_ep_h ep, ucp_atomic_op_t opcode, const void *buffer,
+                 size_t count, uint64_t remote_addr, ucp_rkey_h rkey,
+                 const ucp_request_param_t *param)
+{
+    ucs_status_ptr_t status_p;
+    ucs_status_t status;
+    ucp_request_t *req;
+    void *reply_buffer;
+    uint64_t value;
+    size_t op_size;
+
+    if (ucs_unlikely(!(param->op_attr_mask & UCP_OP_ATTR_FIELD_DATATYPE) ||
+                     !UCP_DT_IS_CONTIG(param->datatype))) {
+        ucs_error("atomic operation requires a contiguous datatype");
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    op_size      = ucp_contig_dt_elem_size(param->datatype);
+    reply_buffer = (param->op_attr_mask & UCP_OP_ATTR_FIELD_REPLY_BUFFER) ?
+                   param->reply_buffer : NULL;
+
+    if (op_size == 2 * sizeof(uint64_t)) {
+        /* 128-bit compare-swap, executed by the remote CPU */
+        UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_AMO64,
+                                        return UCS_STATUS_PTR(
+                                                UCS_ERR_INVALID_PARAM));
+        if (ENABLE_PARAMS_CHECK &&
+            ((opcode != UCP_ATOMIC_OP_CSWAP) || (count != 1) ||
+             ((remote_addr % op_size) != 0))) {
+            ucs_error("only a single naturally aligned compare-swap is "
+                      "supported for 128-bit atomics");
+            return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+        }
+    } else {
+        UCP_AMO_CHECK_PARAM(ep->worker->context, remote_addr, op_size, opcode,
+                            UCP_ATOMIC_OP_LAST,
+                            return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+    }
+
+    if (ENABLE_PARAMS_CHECK &&
+        ((count == 0) ||
+         ((reply_buffer == NULL) && ((opcode == UCP_ATOMIC_OP_SWAP) ||
+                                     (opcode == UCP_ATOMIC_OP_CSWAP))) ||
+         ((count > 1) && (opcode == UCP_ATOMIC_OP_CSWAP)))) {
+        ucs_error("invalid atomic operation %d count %zu reply buffer %p",
+                  opcode, count, reply_buffer);
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    if ((param->op_attr_mask & UCP_OP_ATTR_FIELD_MEMORY_TYPE) &&
+        !UCP_MEM_IS_ACCESSIBLE_FROM_CPU(param->memory_type)) {
+        ucs_error("atomic reply buffer must be accessible from the CPU");
+        return UCS_STATUS_PTR(UCS_ERR_UNSUPPORTED);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ucs_trace_req("atomic_op_nbx opcode %d buffer %p count %zu size %zu "
+                  "remote_addr %"PRIx64" rkey %p reply %p to %s",
+                  opcode, buffer, count, op_size, remote_addr, rkey,
+                  reply_buffer, ucp_ep_peer_name(ep));
+
+    status = UCP_RKEY_RESOLVE(rkey, ep, amo);
+    if (status != UCS_OK) {
+        status_p = UCS_STATUS_PTR(UCS_ERR_UNREACHABLE);
+        goto out;
+    }
+
+    if ((op_size > sizeof(uint64_t)) &&
+        (ucp_ep_config(ep)->key.am_lane == UCP_NULL_LANE)) {
+        status_p = UCS_STATUS_PTR(UCS_ERR_UNSUPPORTED);
+        goto out;
+    }
+
+    req = ucp_request_get_param(ep->worker, param, "atomic_op_nbx",
+                                {
+                                    status_p = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+                                    goto out;
+                                });
+
+    if (count > 1) {
+        status = ucp_amo_init_bulk(req, ep, opcode, buffer, count, op_size,
+                                   remote_addr, rkey, reply_buffer);
+        if (status != UCS_OK) {
+            if (!(param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST)) {
+                ucp_request_put(req);
+            }
+            status_p = UCS_STATUS_PTR(status);
+            goto out;
+        }
+    } else if (op_size > sizeof(uint64_t)) {
+        ucp_amo_init_fetch(req, ep, reply_buffer, UCT_ATOMIC_OP_CSWAP, op_size,
+                           remote_addr, rkey, 0, &ucp_amo_sw_proto);
+        memcpy(req->send.amo.value128, buffer, op_size);
+    } else {
+        value = (op_size == sizeof(uint32_t)) ? *(const uint32_t*)buffer :
+                                                *(const uint64_t*)buffer;
+        if (reply_buffer != NULL) {
+            ucp_amo_init_fetch(req, ep, reply_buffer,
+                               ucp_uct_atomic_op_table[opcode], op_size,
+                               remote_addr, rkey, value,
+                               rkey->cache.amo_proto);
+        } else {
+            ucp_amo_init_post(req, ep, ucp_uct_atomic_op_table[opcode],
+                              op_size, remote_addr, rkey, value,
+                              rkey->cache.amo_proto);
+        }
+    }
+
+    status_p = ucp_amo_send_request_param(req, param);
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status_p;
+}
+
 static inline ucs_status_t
 ucp_atomic_fetch_b(ucp_ep_h ep, ucp_atomic_fetch_op_t opcode, uint64_t value,
                    void *result, size_t size, uint64_t remote_addr,
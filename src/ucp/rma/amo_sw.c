@@ -13,6 +13,7 @@
 
 #include <ucs/arch/atomic.h>
 #include <ucs/profile/profile.h>
+#include <pthread.h>
 
 
 static size_t ucp_amo_sw_pack(void *dest, void *arg, uint8_t fetch)
@@ -63,7 +64,7 @@ static ucs_status_t ucp_amo_sw_progress(uct_pending_req_t *self,
     packed_len = uct_ep_am_bcopy(ep->uct_eps[req->send.lane],
                                  UCP_AM_ID_ATOMIC_REQ, pack_cb, req, 0);
     if (packed_len > 0) {
-        ucp_ep_rma_remote_request_sent(ep);
+        ucp_ep_rma_remote_request_sent(ep, req->send.amo.rkey);
         if (!fetch) {
             ucp_request_complete_send(req, UCS_OK);
         }
@@ -88,10 +89,125 @@ static ucs_status_t ucp_amo_sw_progress_fetch(uct_pending_req_t *self)
     return ucp_amo_sw_progress(self, ucp_amo_sw_fetch_pack_cb, 1);
 }
 
+static UCS_F_ALWAYS_INLINE size_t
+ucp_amo_sw_batch_entry_size(const ucp_atomic_vec_op_t *op, size_t op_size)
+{
+    /* compare-swap has two arguments */
+    return sizeof(ucp_atomic_batch_entry_t) +
+           ((op->opcode == UCP_ATOMIC_FETCH_OP_CSWAP) ? (2 * op_size) : op_size);
+}
+
+static size_t ucp_amo_sw_batch_pack_cb(void *dest, void *arg)
+{
+    ucp_request_t *req                 = arg;
+    ucp_atomic_batch_req_hdr_t *batchh = dest;
+    size_t op_size                     = req->send.amo_vec.op_size;
+    const ucp_atomic_vec_op_t *op      = &req->send.amo_vec.ops[
+                                                 req->send.state.dt.offset];
+    ucp_atomic_batch_entry_t *entry    = (ucp_atomic_batch_entry_t*)(batchh + 1);
+    int fetch                          = 0;
+    void *operands;
+    size_t i;
+
+    for (i = 0; i < req->send.amo_vec.batch_count; ++i, ++op) {
+        entry->address = op->remote_addr;
+        entry->opcode  = ucp_uct_fop_table[op->opcode];
+        entry->fetch   = (op->result != NULL);
+        fetch         |= entry->fetch;
+
+        operands = entry + 1;
+        memcpy(operands, &op->value, op_size);
+        if (entry->opcode == UCT_ATOMIC_OP_CSWAP) {
+            memcpy(UCS_PTR_BYTE_OFFSET(operands, op_size), op->result,
+                   op_size);
+        }
+
+        entry = UCS_PTR_BYTE_OFFSET(entry,
+                                    ucp_amo_sw_batch_entry_size(op, op_size));
+    }
+
+    batchh->req.ep_ptr = ucp_ep_dest_ep_ptr(req->send.ep);
+    batchh->req.reqptr = fetch ? (uintptr_t)req : 0;
+    batchh->index      = req->send.state.dt.offset;
+    batchh->count      = req->send.amo_vec.batch_count;
+    batchh->length     = op_size;
+
+    return UCS_PTR_BYTE_DIFF(dest, entry);
+}
+
+/*
+ * Send the vector of atomic operations in as few messages as possible. Each
+ * message is executed by the remote peer in one pass, and acknowledged by a
+ * single reply with the fetched values, or by a completion message if none of
+ * its operations fetches.
+ */
+static ucs_status_t ucp_amo_sw_progress_vec(uct_pending_req_t *self)
+{
+    ucp_request_t *req            = ucs_container_of(self, ucp_request_t,
+                                                     send.uct);
+    ucp_ep_t *ep                  = req->send.ep;
+    size_t max_length             = ucp_ep_config(ep)->am.max_bcopy;
+    size_t op_size                = req->send.amo_vec.op_size;
+    size_t seg_size               = ep->worker->context->config.ext.seg_size;
+    size_t max_count;
+    const ucp_atomic_vec_op_t *op;
+    size_t length, count;
+    ssize_t packed_len;
+    int fetch;
+
+    req->send.lane = ucp_ep_get_am_lane(ep);
+
+    /* the fetched values are replied from a buffer of the segment size */
+    max_count = ucs_min(UINT16_MAX,
+                        (seg_size - sizeof(ucp_atomic_batch_rep_hdr_t)) /
+                        op_size);
+
+    while (req->send.state.dt.offset < req->send.length) {
+        op     = &req->send.amo_vec.ops[req->send.state.dt.offset];
+        length = sizeof(ucp_atomic_batch_req_hdr_t);
+        count  = 0;
+        fetch  = 0;
+        while (((req->send.state.dt.offset + count) < req->send.length) &&
+               (count < max_count)) {
+            length += ucp_amo_sw_batch_entry_size(&op[count], op_size);
+            if (length > max_length) {
+                break;
+            }
+
+            fetch |= (op[count].result != NULL);
+            ++count;
+        }
+
+        ucs_assert(count > 0);
+        req->send.amo_vec.batch_count = count;
+
+        packed_len = uct_ep_am_bcopy(ep->uct_eps[req->send.lane],
+                                     UCP_AM_ID_ATOMIC_BATCH_REQ,
+                                     ucp_amo_sw_batch_pack_cb, req, 0);
+        if (packed_len < 0) {
+            if (packed_len == UCS_ERR_NO_RESOURCE) {
+                return UCS_ERR_NO_RESOURCE;
+            }
+
+            return ucp_rma_vec_request_posted(req, (ucs_status_t)packed_len);
+        }
+
+        ucp_ep_rma_remote_request_sent(ep, req->send.amo_vec.rkey);
+        if (fetch) {
+            ++req->send.state.uct_comp.count;
+        }
+
+        req->send.state.dt.offset += count;
+    }
+
+    return ucp_rma_vec_request_posted(req, UCS_OK);
+}
+
 ucp_amo_proto_t ucp_amo_sw_proto = {
     .name           = "sw_amo",
     .progress_fetch = ucp_amo_sw_progress_fetch,
-    .progress_post  = ucp_amo_sw_progress_post
+    .progress_post  = ucp_amo_sw_progress_post,
+    .progress_vec   = ucp_amo_sw_progress_vec
 };
 
 static size_t ucp_amo_sw_pack_atomic_reply(void *dest, void *arg)
@@ -108,6 +224,10 @@ static size_t ucp_amo_sw_pack_atomic_reply(void *dest, void *arg)
     case sizeof(uint64_t):
         *(uint64_t*)(hdr + 1) = req->send.atomic_reply.data.reply64;
         break;
+    case 2 * sizeof(uint64_t):
+        memcpy(hdr + 1, req->send.atomic_reply.data.reply128,
+               req->send.length);
+        break;
     default:
         ucs_fatal("invalid atomic length: %zu", req->send.length);
     }
@@ -134,13 +254,42 @@ static ucs_status_t ucp_progress_atomic_reply(uct_pending_req_t *self)
     return UCS_OK;
 }
 
+static size_t ucp_amo_sw_pack_atomic_batch_reply(void *dest, void *arg)
+{
+    ucp_request_t *req = arg;
+
+    memcpy(dest, req->send.mdesc + 1, req->send.length);
+    return req->send.length;
+}
+
+static ucs_status_t ucp_progress_atomic_batch_reply(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_t *ep       = req->send.ep;
+    ssize_t packed_len;
+
+    req->send.lane = ucp_ep_get_am_lane(ep);
+    packed_len = uct_ep_am_bcopy(ep->uct_eps[req->send.lane],
+                                 UCP_AM_ID_ATOMIC_BATCH_REP,
+                                 ucp_amo_sw_pack_atomic_batch_reply, req, 0);
+    if (packed_len < 0) {
+        return (ucs_status_t)packed_len;
+    }
+
+    ucs_assert(packed_len == req->send.length);
+    ucs_mpool_put_inline(req->send.mdesc);
+    ucp_request_put(req);
+    return UCS_OK;
+}
+
 #define DEFINE_AMO_SW_OP(_bits) \
-    static void ucp_amo_sw_do_op##_bits(const ucp_atomic_req_hdr_t *atomicreqh) \
+    static void ucp_amo_sw_do_op##_bits(uint64_t address, uint8_t opcode, \
+                                        const void *operands) \
     { \
-        uint##_bits##_t *ptr  = (void*)atomicreqh->address; \
-        uint##_bits##_t *args = (void*)(atomicreqh + 1); \
+        uint##_bits##_t *ptr        = (void*)address; \
+        const uint##_bits##_t *args = operands; \
         \
-       switch (atomicreqh->opcode) { \
+       switch (opcode) { \
         case UCT_ATOMIC_OP_ADD: \
             ucs_atomic_add##_bits(ptr, args[0]); \
             break; \
@@ -154,18 +303,19 @@ static ucs_status_t ucp_progress_atomic_reply(uct_pending_req_t *self)
             ucs_atomic_xor##_bits(ptr, args[0]); \
             break; \
         default: \
-            ucs_fatal("invalid opcode: %d", atomicreqh->opcode); \
+            ucs_fatal("invalid opcode: %d", opcode); \
         } \
     }
 
 #define DEFINE_AMO_SW_FOP(_bits) \
-    static void ucp_amo_sw_do_fop##_bits(const ucp_atomic_req_hdr_t *atomicreqh, \
+    static void ucp_amo_sw_do_fop##_bits(uint64_t address, uint8_t opcode, \
+                                         const void *operands, \
                                          ucp_atomic_reply_t *result) \
     { \
-        uint##_bits##_t *ptr  = (void*)atomicreqh->address; \
-        uint##_bits##_t *args = (void*)(atomicreqh + 1); \
+        uint##_bits##_t *ptr        = (void*)address; \
+        const uint##_bits##_t *args = operands; \
         \
-        switch (atomicreqh->opcode) { \
+        switch (opcode) { \
         case UCT_ATOMIC_OP_ADD: \
             result->reply##_bits = ucs_atomic_fadd##_bits(ptr, args[0]); \
             break; \
@@ -185,7 +335,7 @@ static ucs_status_t ucp_progress_atomic_reply(uct_pending_req_t *self)
             result->reply##_bits = ucs_atomic_cswap##_bits(ptr, args[0], args[1]); \
             break; \
         default: \
-            ucs_fatal("invalid opcode: %d", atomicreqh->opcode); \
+            ucs_fatal("invalid opcode: %d", opcode); \
         } \
     }
 
@@ -194,6 +344,35 @@ DEFINE_AMO_SW_OP(64)
 DEFINE_AMO_SW_FOP(32)
 DEFINE_AMO_SW_FOP(64)
 
+#ifndef UCS_HAVE_ATOMIC_CSWAP128
+static pthread_mutex_t ucp_amo_sw_cswap128_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* Transports have no 128-bit atomics, so only compare-swap is supported */
+static void ucp_amo_sw_do_fop128(uint64_t address, uint8_t opcode,
+                                 const void *operands,
+                                 ucp_atomic_reply_t *result)
+{
+    uint64_t args[4]; /* compare and swap values */
+
+    if (opcode != UCT_ATOMIC_OP_CSWAP) {
+        ucs_fatal("invalid 128-bit opcode: %d", opcode);
+    }
+
+    memcpy(args, operands, sizeof(args));
+#ifdef UCS_HAVE_ATOMIC_CSWAP128
+    ucs_atomic_cswap128((uint64_t*)address, &args[0], &args[2],
+                        result->reply128);
+#else
+    pthread_mutex_lock(&ucp_amo_sw_cswap128_lock);
+    memcpy(result->reply128, (void*)address, sizeof(result->reply128));
+    if (!memcmp(result->reply128, &args[0], sizeof(result->reply128))) {
+        memcpy((void*)address, &args[2], sizeof(result->reply128));
+    }
+    pthread_mutex_unlock(&ucp_amo_sw_cswap128_lock);
+#endif
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_flags),
                  void *arg, void *data, size_t length, unsigned am_flags)
 {
@@ -208,7 +387,9 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_fl
         return UCS_OK;
     }
 
-    if (ucs_unlikely((amo_rsc_idx != UCP_MAX_RESOURCES) &&
+    /* 128-bit operations are always executed by the CPU */
+    if (ucs_unlikely((atomicreqh->length <= sizeof(uint64_t)) &&
+                     (amo_rsc_idx != UCP_MAX_RESOURCES) &&
                      (ucp_worker_iface_get_attr(worker,
                                                 amo_rsc_idx)->cap.flags &
                       UCT_IFACE_FLAG_ATOMIC_DEVICE))) {
@@ -224,10 +405,12 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_fl
         /* atomic operation without result */
         switch (atomicreqh->length) {
         case sizeof(uint32_t):
-            ucp_amo_sw_do_op32(atomicreqh);
+            ucp_amo_sw_do_op32(atomicreqh->address, atomicreqh->opcode,
+                               atomicreqh + 1);
             break;
         case sizeof(uint64_t):
-            ucp_amo_sw_do_op64(atomicreqh);
+            ucp_amo_sw_do_op64(atomicreqh->address, atomicreqh->opcode,
+                               atomicreqh + 1);
             break;
         default:
             ucs_fatal("invalid atomic length: %u", atomicreqh->length);
@@ -243,10 +426,19 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_fl
 
         switch (atomicreqh->length) {
         case sizeof(uint32_t):
-            ucp_amo_sw_do_fop32(atomicreqh, &req->send.atomic_reply.data);
+            ucp_amo_sw_do_fop32(atomicreqh->address, atomicreqh->opcode,
+                                atomicreqh + 1,
+                                &req->send.atomic_reply.data);
             break;
         case sizeof(uint64_t):
-            ucp_amo_sw_do_fop64(atomicreqh, &req->send.atomic_reply.data);
+            ucp_amo_sw_do_fop64(atomicreqh->address, atomicreqh->opcode,
+                                atomicreqh + 1,
+                                &req->send.atomic_reply.data);
+            break;
+        case 2 * sizeof(uint64_t):
+            ucp_amo_sw_do_fop128(atomicreqh->address, atomicreqh->opcode,
+                                 atomicreqh + 1,
+                                 &req->send.atomic_reply.data);
             break;
         default:
             ucs_fatal("invalid atomic length: %u", atomicreqh->length);
@@ -276,12 +468,152 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_rep_handler, (arg, data, length, am_fl
     return UCS_OK;
 }
 
+/*
+ * Execute one operation of a batch, and store the fetched value to @a result
+ * if the operation fetches. Returns the size of the entry.
+ */
+static size_t ucp_amo_sw_batch_do(const ucp_atomic_batch_entry_t *entry,
+                                  size_t op_size, void *result)
+{
+    uint64_t operands[2]; /* aligned copy of the operands */
+    size_t operands_size = (entry->opcode == UCT_ATOMIC_OP_CSWAP) ?
+                           (2 * op_size) : op_size;
+    ucp_atomic_reply_t reply;
+
+    memcpy(operands, entry + 1, operands_size);
+
+    switch (op_size) {
+    case sizeof(uint32_t):
+        if (entry->fetch) {
+            ucp_amo_sw_do_fop32(entry->address, entry->opcode, operands,
+                                &reply);
+            memcpy(result, &reply.reply32, op_size);
+        } else {
+            ucp_amo_sw_do_op32(entry->address, entry->opcode, operands);
+        }
+        break;
+    case sizeof(uint64_t):
+        if (entry->fetch) {
+            ucp_amo_sw_do_fop64(entry->address, entry->opcode, operands,
+                                &reply);
+            memcpy(result, &reply.reply64, op_size);
+        } else {
+            ucp_amo_sw_do_op64(entry->address, entry->opcode, operands);
+        }
+        break;
+    default:
+        ucs_fatal("invalid atomic length: %zu", op_size);
+    }
+
+    return sizeof(*entry) + operands_size;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_batch_req_handler,
+                 (arg, data, length, am_flags),
+                 void *arg, void *data, size_t length, unsigned am_flags)
+{
+    ucp_atomic_batch_req_hdr_t *batchh = data;
+    ucp_atomic_batch_entry_t *entry    = (ucp_atomic_batch_entry_t*)(batchh + 1);
+    ucp_worker_h worker                = arg;
+    ucp_atomic_batch_rep_hdr_t *reph;
+    ucp_mem_desc_t *mdesc;
+    ucp_request_t *req;
+    void *result;
+    ucp_ep_h ep;
+    unsigned i;
+    int fetch;
+
+    ep = ucp_worker_get_ep_by_ptr(worker, batchh->req.ep_ptr);
+    if (ep == NULL) {
+        return UCS_OK;
+    }
+
+    if (batchh->req.reqptr == 0) {
+        /* none of the operations fetches */
+        for (i = 0; i < batchh->count; ++i) {
+            entry = UCS_PTR_BYTE_OFFSET(entry,
+                                        ucp_amo_sw_batch_do(entry,
+                                                            batchh->length,
+                                                            NULL));
+        }
+        ucp_rma_sw_send_cmpl(ep);
+        return UCS_OK;
+    }
+
+    req = ucp_request_get(worker, "atomic_batch_req_handler");
+    if (req == NULL) {
+        ucs_error("failed to allocate atomic batch reply");
+        return UCS_OK;
+    }
+
+    mdesc = ucp_worker_mpool_get(&worker->reg_mp);
+    if (mdesc == NULL) {
+        ucs_error("failed to allocate atomic batch reply buffer");
+        ucp_request_put(req);
+        return UCS_OK;
+    }
+
+    ucs_assert((sizeof(*reph) + (batchh->count * batchh->length)) <=
+               worker->context->config.ext.seg_size);
+    reph   = (ucp_atomic_batch_rep_hdr_t*)(mdesc + 1);
+    result = reph + 1;
+    for (i = 0; i < batchh->count; ++i) {
+        fetch = entry->fetch;
+        entry = UCS_PTR_BYTE_OFFSET(entry,
+                                    ucp_amo_sw_batch_do(entry, batchh->length,
+                                                        result));
+        if (fetch) {
+            result = UCS_PTR_BYTE_OFFSET(result, batchh->length);
+        }
+    }
+
+    reph->req          = batchh->req.reqptr;
+    reph->index        = batchh->index;
+    reph->count        = batchh->count;
+    req->send.ep       = ep;
+    req->send.mdesc    = mdesc;
+    req->send.length   = UCS_PTR_BYTE_DIFF(reph, result);
+    req->send.uct.func = ucp_progress_atomic_batch_reply;
+    ucp_request_send(req, 0);
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_batch_rep_handler,
+                 (arg, data, length, am_flags),
+                 void *arg, void *data, size_t length, unsigned am_flags)
+{
+    ucp_atomic_batch_rep_hdr_t *reph = data;
+    ucp_request_t *req               = (ucp_request_t*)reph->req;
+    ucp_ep_h ep                      = req->send.ep;
+    size_t op_size                   = req->send.amo_vec.op_size;
+    const ucp_atomic_vec_op_t *op    = &req->send.amo_vec.ops[reph->index];
+    uct_completion_t *comp           = &req->send.state.uct_comp;
+    const void *result               = reph + 1;
+    unsigned i;
+
+    for (i = 0; i < reph->count; ++i, ++op) {
+        if (op->result != NULL) {
+            memcpy(op->result, result, op_size);
+            result = UCS_PTR_BYTE_OFFSET(result, op_size);
+        }
+    }
+
+    ucs_assert(UCS_PTR_BYTE_DIFF(data, result) == length);
+    ucp_ep_rma_remote_request_completed(ep);
+    if (--comp->count == 0) {
+        comp->func(comp, comp->status);
+    }
+    return UCS_OK;
+}
+
 static void ucp_amo_sw_dump_packet(ucp_worker_h worker, uct_am_trace_type_t type,
                                    uint8_t id, const void *data, size_t length,
                                    char *buffer, size_t max)
 {
     const ucp_atomic_req_hdr_t *atomich;
     const ucp_rma_rep_hdr_t *reph;
+    const ucp_atomic_batch_req_hdr_t *batchh;
+    const ucp_atomic_batch_rep_hdr_t *batch_reph;
     size_t header_len;
     char *p;
 
@@ -299,6 +631,20 @@ static void ucp_amo_sw_dump_packet(ucp_worker_h worker, uct_am_trace_type_t type
         snprintf(buffer, max, "ATOMIC_REP [reqptr 0x%lx]", reph->req);
         header_len = sizeof(*reph);
         break;
+    case UCP_AM_ID_ATOMIC_BATCH_REQ:
+        batchh = data;
+        snprintf(buffer, max,
+                 "ATOMIC_BATCH_REQ [index %u count %u len %u reqptr 0x%lx "
+                 "ep 0x%lx]", batchh->index, batchh->count, batchh->length,
+                 batchh->req.reqptr, batchh->req.ep_ptr);
+        header_len = sizeof(*batchh);
+        break;
+    case UCP_AM_ID_ATOMIC_BATCH_REP:
+        batch_reph = data;
+        snprintf(buffer, max, "ATOMIC_BATCH_REP [index %u count %u reqptr 0x%lx]",
+                 batch_reph->index, batch_reph->count, batch_reph->req);
+        header_len = sizeof(*batch_reph);
+        break;
     default:
         return;
     }
@@ -314,4 +660,10 @@ UCP_DEFINE_AM(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_REQ, ucp_atomic_req_handler,
 UCP_DEFINE_AM(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_REP, ucp_atomic_rep_handler,
               ucp_amo_sw_dump_packet, 0);
 
+UCP_DEFINE_AM(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_BATCH_REQ,
+              ucp_atomic_batch_req_handler, ucp_amo_sw_dump_packet, 0);
+UCP_DEFINE_AM(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_BATCH_REP,
+              ucp_atomic_batch_rep_handler, ucp_amo_sw_dump_packet, 0);
+
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_ATOMIC_REQ);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_ATOMIC_BATCH_REQ);
@@ -33,30 +33,77 @@ static int ucp_ep_flush_is_completed(ucp_request_t *req)
     return (req->send.state.uct_comp.count == 0) && req->send.flush.sw_done;
 }
 
+static UCS_F_ALWAYS_INLINE ucp_lane_map_t
+ucp_ep_flush_lanes(ucp_request_t *req, unsigned num_lanes)
+{
+    return UCS_MASK(num_lanes) & req->send.flush.lane_map;
+}
+
+/*
+ * Return the flush sequence number of the last software operation issued with
+ * the remote key. Batched puts are not tracked per key, so wait for everything
+ * which was sent on the endpoint.
+ */
+static uint32_t ucp_ep_rkey_flush_sw_sn(ucp_ep_h ep, ucp_rkey_h rkey)
+{
+    if (rkey->flush.flags & UCP_RKEY_FLUSH_FLAG_SW_AGGR) {
+        rkey->flush.sw_sn  = ucp_ep_flush_state(ep)->send_sn;
+        rkey->flush.flags |= UCP_RKEY_FLUSH_FLAG_SW;
+        if (ucp_ep_ext_gen(ep)->rma_aggr_req == NULL) {
+            /* all batches are sent, so sw_sn covers them */
+            rkey->flush.flags &= ~UCP_RKEY_FLUSH_FLAG_SW_AGGR;
+        }
+    }
+
+    return rkey->flush.sw_sn;
+}
+
+static uint32_t ucp_ep_flush_sw_sn(ucp_request_t *req)
+{
+    ucp_ep_h ep     = req->send.ep;
+    ucp_rkey_h rkey = req->send.flush.rkey;
+
+    if (rkey == NULL) {
+        return ucp_ep_flush_state(ep)->send_sn;
+    }
+
+    return ucp_ep_rkey_flush_sw_sn(ep, rkey);
+}
+
+static int ucp_ep_flush_sw_required(ucp_request_t *req)
+{
+    ucp_rkey_h rkey = req->send.flush.rkey;
+
+    return (rkey == NULL) ||
+           (rkey->flush.flags & (UCP_RKEY_FLUSH_FLAG_SW |
+                                 UCP_RKEY_FLUSH_FLAG_SW_AGGR));
+}
+
 static void ucp_ep_flush_progress(ucp_request_t *req)
 {
     ucp_ep_h ep              = req->send.ep;
     unsigned num_lanes       = ucp_ep_num_lanes(ep);
-    ucp_lane_map_t all_lanes = UCS_MASK(num_lanes);
+    ucp_lane_map_t all_lanes = ucp_ep_flush_lanes(req, num_lanes);
     ucp_ep_flush_state_t *flush_state;
     ucp_lane_index_t lane;
     ucs_status_t status;
     uct_ep_h uct_ep;
     int diff;
-    ucp_lane_map_t destroyed_lanes;
+    ucp_lane_map_t destroyed_lanes, new_lanes;
 
     /* If the number of lanes changed since flush operation was submitted, adjust
      * the number of expected completions */
     if (ucs_unlikely(req->send.flush.num_lanes != num_lanes)) {
         ucp_trace_req(req, "ep %p: number of lanes changed from %d to %d",
                       ep, req->send.flush.num_lanes, num_lanes);
-        diff                      = num_lanes - req->send.flush.num_lanes;
+        diff      = num_lanes - req->send.flush.num_lanes;
+        new_lanes = all_lanes & ~UCS_MASK(req->send.flush.num_lanes);
         req->send.flush.num_lanes = num_lanes;
         if (diff >= 0) {
             ucp_trace_req(req,
                           "ep %p: adjusting expected flush completion count by %d",
-                          ep, diff);
-            req->send.state.uct_comp.count += diff;
+                          ep, ucs_popcount(new_lanes));
+            req->send.state.uct_comp.count += ucs_popcount(new_lanes);
         } else {
             /* If we have less lanes, it means we are in error flow:
              * - if count == 0, we have completed the flush on all lanes
@@ -144,20 +191,25 @@ static void ucp_ep_flush_progress(ucp_request_t *req)
          * - The endpoint is either not used or did not resolve the peer endpoint,
          *   which means we didn't have any user operations which require remote
          *   completion. In this case, the flush state may not even be initialized.
+         * - The flushed remote key was not used by software operations.
          */
         if ((req->send.flush.uct_flags & UCT_FLUSH_FLAG_CANCEL) ||
-            !ucs_test_all_flags(ep->flags, UCP_EP_FLAG_USED|UCP_EP_FLAG_DEST_EP)) {
+            !ucs_test_all_flags(ep->flags, UCP_EP_FLAG_USED|UCP_EP_FLAG_DEST_EP) ||
+            !ucp_ep_flush_sw_required(req)) {
             ucs_trace_req("flush request %p not waiting for remote completions",
                           req);
             req->send.flush.sw_done = 1;
         } else {
-            /* All pending requests were sent, so 'send_sn' value is up-to-date */
-            flush_state = ucp_ep_flush_state(ep);
-            if (flush_state->send_sn == flush_state->cmpl_sn) {
+            /* All pending requests were sent, so 'send_sn' value is up-to-date.
+             * A request added to the queue after one with a larger sequence
+             * number may be completed later than needed, but never earlier. */
+            flush_state             = ucp_ep_flush_state(ep);
+            req->send.flush.cmpl_sn = ucp_ep_flush_sw_sn(req);
+            if (UCS_CIRCULAR_COMPARE32(flush_state->cmpl_sn, >=,
+                                       req->send.flush.cmpl_sn)) {
                 req->send.flush.sw_done = 1;
                 ucs_trace_req("flush request %p remote completions done", req);
             } else {
-                req->send.flush.cmpl_sn = flush_state->send_sn;
                 ucs_queue_push(&flush_state->reqs, &req->send.flush.queue);
                 ucs_trace_req("added flush request %p to ep remote completion queue"
                               " with sn %d", req, req->send.flush.cmpl_sn);
@@ -224,7 +276,8 @@ static ucs_status_t ucp_ep_flush_progress_pending(uct_pending_req_t *self)
     /* If the operation has not completed, and not started on all lanes, add
      * slow-path progress to resume */
     if (!completed &&
-        (req->send.flush.started_lanes != UCS_MASK(ucp_ep_num_lanes(ep)))) {
+        (req->send.flush.started_lanes !=
+         ucp_ep_flush_lanes(req, ucp_ep_num_lanes(ep)))) {
         ucs_trace("ep %p: adding slow-path callback to resume flush", ep);
         uct_worker_progress_register_safe(ep->worker->uct,
                                           ucp_ep_flush_resume_slow_path_callback,
@@ -279,17 +332,20 @@ void ucp_ep_flush_remote_completed(ucp_request_t *req)
     }
 }
 
-ucs_status_ptr_t ucp_ep_flush_internal(ucp_ep_h ep, unsigned uct_flags,
-                                       ucp_send_callback_t req_cb,
-                                       unsigned req_flags,
-                                       ucp_request_t *worker_req,
-                                       ucp_request_callback_t flushed_cb,
-                                       const char *debug_name)
+static ucs_status_ptr_t
+ucp_ep_flush_lanes_internal(ucp_ep_h ep, ucp_rkey_h rkey,
+                            ucp_lane_map_t lane_map, unsigned uct_flags,
+                            ucp_send_callback_t req_cb, unsigned req_flags,
+                            ucp_request_t *worker_req,
+                            ucp_request_callback_t flushed_cb,
+                            const char *debug_name)
 {
     ucs_status_t status;
     ucp_request_t *req;
 
-    ucs_debug("%s ep %p", debug_name, ep);
+    ucs_debug("%s ep %p rkey %p lanes 0x%x", debug_name, ep, rkey, lane_map);
+
+    ucp_rma_sw_aggr_flush(ep);
 
     req = ucp_request_get(ep->worker, debug_name);
     if (req == NULL) {
@@ -312,15 +368,18 @@ ucs_status_ptr_t ucp_ep_flush_internal(ucp_ep_h ep, unsigned uct_flags,
     req->send.flush.prog_id       = UCS_CALLBACKQ_ID_NULL;
     req->send.flush.uct_flags     = uct_flags;
     req->send.flush.worker_req    = worker_req;
+    req->send.flush.rkey          = rkey;
     req->send.flush.sw_started    = 0;
     req->send.flush.sw_done       = 0;
-    req->send.flush.num_lanes     = ucp_ep_num_lanes(ep);;
+    req->send.flush.num_lanes     = ucp_ep_num_lanes(ep);
+    req->send.flush.lane_map      = lane_map;
     req->send.flush.started_lanes = 0;
 
     req->send.lane              = UCP_NULL_LANE;
     req->send.uct.func          = ucp_ep_flush_progress_pending;
     req->send.state.uct_comp.func   = ucp_ep_flush_completion;
-    req->send.state.uct_comp.count  = ucp_ep_num_lanes(ep);
+    req->send.state.uct_comp.count  =
+            ucs_popcount(ucp_ep_flush_lanes(req, ucp_ep_num_lanes(ep)));
     req->send.state.uct_comp.status = UCS_OK;
 
     ucp_ep_flush_progress(req);
@@ -338,6 +397,18 @@ ucs_status_ptr_t ucp_ep_flush_internal(ucp_ep_h ep, unsigned uct_flags,
     return req + 1;
 }
 
+ucs_status_ptr_t ucp_ep_flush_internal(ucp_ep_h ep, unsigned uct_flags,
+                                       ucp_send_callback_t req_cb,
+                                       unsigned req_flags,
+                                       ucp_request_t *worker_req,
+                                       ucp_request_callback_t flushed_cb,
+                                       const char *debug_name)
+{
+    return ucp_ep_flush_lanes_internal(ep, NULL, UCS_MASK(UCP_MAX_LANES),
+                                       uct_flags, req_cb, req_flags, worker_req,
+                                       flushed_cb, debug_name);
+}
+
 static void ucp_ep_flushed_callback(ucp_request_t *req)
 {
     ucp_request_complete_send(req, req->status);
@@ -359,6 +430,86 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_ep_flush_nb, (ep, flags, cb),
     return request;
 }
 
+static UCS_F_ALWAYS_INLINE ucp_lane_map_t
+ucp_ep_rkey_flush_lanes(ucp_ep_h ep, ucp_rkey_h rkey)
+{
+    if (rkey->flush.flags & UCP_RKEY_FLUSH_FLAG_SW_AGGR) {
+        /* Puts which were batched before the flush must be sent before it */
+        ucp_rma_sw_aggr_flush(ep);
+    }
+
+    return rkey->flush.lanes & UCS_MASK(ucp_ep_num_lanes(ep));
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_ep_rkey_flush_nb, (ep, rkey, cb),
+                 ucp_ep_h ep, ucp_rkey_h rkey, ucp_send_callback_t cb)
+{
+    ucp_lane_map_t lanes;
+    void *request;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    lanes = ucp_ep_rkey_flush_lanes(ep, rkey);
+    if ((lanes == 0) && !(rkey->flush.flags & (UCP_RKEY_FLUSH_FLAG_SW |
+                                               UCP_RKEY_FLUSH_FLAG_SW_AGGR))) {
+        /* the key was not used on the endpoint */
+        request = NULL;
+    } else {
+        request = ucp_ep_flush_lanes_internal(ep, rkey, lanes,
+                                              UCT_FLUSH_FLAG_LOCAL, cb,
+                                              UCP_REQUEST_FLAG_CALLBACK, NULL,
+                                              ucp_ep_flushed_callback,
+                                              "rkey_flush_nb");
+    }
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+
+    return request;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_ep_rkey_flush_test, (ep, rkey),
+                 ucp_ep_h ep, ucp_rkey_h rkey)
+{
+    ucp_ep_flush_state_t *flush_state;
+    ucp_lane_index_t lane;
+    ucp_lane_map_t lanes;
+    ucs_status_t status;
+    uint32_t sw_sn;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    lanes = ucp_ep_rkey_flush_lanes(ep, rkey);
+    ucs_for_each_bit(lane, lanes) {
+        if (ep->uct_eps[lane] == NULL) {
+            continue;
+        }
+
+        /* without a completion, only check the state of the transport */
+        status = uct_ep_flush(ep->uct_eps[lane], 0, NULL);
+        if (status == UCS_ERR_NO_RESOURCE) {
+            status = UCS_INPROGRESS;
+        }
+        if (status != UCS_OK) {
+            goto out;
+        }
+    }
+
+    status = UCS_OK;
+    if ((rkey->flush.flags & (UCP_RKEY_FLUSH_FLAG_SW |
+                              UCP_RKEY_FLUSH_FLAG_SW_AGGR)) &&
+        ucs_test_all_flags(ep->flags, UCP_EP_FLAG_USED|UCP_EP_FLAG_DEST_EP)) {
+        flush_state = ucp_ep_flush_state(ep);
+        sw_sn       = ucp_ep_rkey_flush_sw_sn(ep, rkey);
+        if (!UCS_CIRCULAR_COMPARE32(flush_state->cmpl_sn, >=, sw_sn)) {
+            status = UCS_INPROGRESS;
+        }
+    }
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
 static ucs_status_t ucp_worker_flush_check(ucp_worker_h worker)
 {
     ucp_rsc_index_t iface_id;
@@ -467,6 +618,8 @@ static ucs_status_ptr_t ucp_worker_flush_nb_internal(ucp_worker_h worker,
     ucs_status_t status;
     ucp_request_t *req;
 
+    ucp_rma_sw_aggr_send_all(worker);
+
     status = ucp_worker_flush_check(worker);
     if ((status != UCS_INPROGRESS) && (status != UCS_ERR_NO_RESOURCE)) {
         return UCS_STATUS_PTR(status);
@@ -550,6 +703,9 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_worker_fence, (worker), ucp_worker_h worker)
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
 
+    /* Puts which were batched before the fence must be sent before it */
+    ucp_rma_sw_aggr_send_all(worker);
+
     ucs_for_each_bit(rsc_index, worker->context->tl_bitmap) {
         wiface = ucp_worker_iface(worker, rsc_index);
         if (wiface->iface == NULL) {
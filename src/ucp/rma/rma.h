@@ -12,6 +12,11 @@
 #include <uct/api/uct.h>
 
 
+/* Maximal number of blocks of a strided or indexed RMA which are combined to
+ * a single transport operation */
+#define UCP_RMA_VEC_MAX_IOV 64
+
+
 /**
  * Defines functions for RMA protocol
  */
@@ -19,6 +24,10 @@ struct ucp_rma_proto {
     const char                 *name;
     uct_pending_callback_t     progress_put;
     uct_pending_callback_t     progress_get;
+    uct_pending_callback_t     progress_put_vec; /* Strided or indexed put,
+                                                    NULL if not supported */
+    uct_pending_callback_t     progress_get_vec; /* Strided or indexed get,
+                                                    NULL if not supported */
 };
 
 
@@ -29,6 +38,7 @@ struct ucp_amo_proto {
     const char                 *name;
     uct_pending_callback_t     progress_fetch;
     uct_pending_callback_t     progress_post;
+    uct_pending_callback_t     progress_vec;  /* Vector of atomic operations */
 };
 
 
@@ -36,8 +46,9 @@ struct ucp_amo_proto {
  * Atomic reply data
  */
 typedef union {
-    uint32_t           reply32; /* 32-bit reply */
-    uint64_t           reply64; /* 64-bit reply */
+    uint32_t           reply32;     /* 32-bit reply */
+    uint64_t           reply64;     /* 64-bit reply */
+    uint64_t           reply128[2]; /* 128-bit reply */
 } ucp_atomic_reply_t;
 
 
@@ -52,6 +63,21 @@ typedef struct {
 } UCS_S_PACKED ucp_cmpl_hdr_t;
 
 
+/*
+ * Batch of small puts, followed by entries of ucp_put_batch_entry_t, each one
+ * followed by its data
+ */
+typedef struct {
+    uintptr_t                 ep_ptr;
+} UCS_S_PACKED ucp_put_batch_hdr_t;
+
+
+typedef struct {
+    uint64_t                  address;
+    uint32_t                  length;
+} UCS_S_PACKED ucp_put_batch_entry_t;
+
+
 typedef struct {
     uint64_t                  address;
     uint64_t                  length;
@@ -72,17 +98,62 @@ typedef struct {
 } UCS_S_PACKED ucp_atomic_req_hdr_t;
 
 
+/*
+ * Batch of atomic operations, followed by entries of ucp_atomic_batch_entry_t,
+ * each one followed by its operands
+ */
+typedef struct {
+    ucp_request_hdr_t         req;    /* NULL if no operation fetches */
+    uint32_t                  index;  /* Index of the first operation */
+    uint16_t                  count;  /* Number of operations */
+    uint8_t                   length; /* Operand size */
+} UCS_S_PACKED ucp_atomic_batch_req_hdr_t;
+
+
+typedef struct {
+    uint64_t                  address;
+    uint8_t                   opcode;
+    uint8_t                   fetch;
+} UCS_S_PACKED ucp_atomic_batch_entry_t;
+
+
+/*
+ * Reply to a batch of atomic operations, followed by the fetched values
+ */
+typedef struct {
+    uintptr_t                 req;
+    uint32_t                  index;  /* Index of the first operation */
+    uint16_t                  count;  /* Number of operations */
+} UCS_S_PACKED ucp_atomic_batch_rep_hdr_t;
+
+
 extern ucp_rma_proto_t ucp_rma_basic_proto;
 extern ucp_rma_proto_t ucp_rma_sw_proto;
 extern ucp_amo_proto_t ucp_amo_basic_proto;
 extern ucp_amo_proto_t ucp_amo_sw_proto;
+extern uct_atomic_op_t ucp_uct_fop_table[];
 
 
 ucs_status_t ucp_rma_request_advance(ucp_request_t *req, ssize_t frag_length,
                                      ucs_status_t status);
 
+void ucp_rma_vec_request_completion(uct_completion_t *self,
+                                    ucs_status_t status);
+
+void ucp_amo_vec_request_completion(uct_completion_t *self,
+                                    ucs_status_t status);
+
 void ucp_ep_flush_remote_completed(ucp_request_t *req);
 
 void ucp_rma_sw_send_cmpl(ucp_ep_h ep);
 
+ucs_status_t ucp_rma_sw_aggr_put(ucp_ep_h ep, const void *buffer,
+                                 size_t length, uint64_t remote_addr);
+
+void ucp_rma_sw_aggr_send(ucp_ep_h ep);
+
+void ucp_rma_sw_aggr_send_all(ucp_worker_h worker);
+
+void ucp_rma_sw_aggr_cleanup(ucp_ep_h ep);
+
 #endif
@@ -55,10 +55,74 @@ static inline ucs_status_t ucp_rma_wait(ucp_worker_h worker, void *user_req,
     }
 }
 
-static inline void ucp_ep_rma_remote_request_sent(ucp_ep_t *ep)
+static UCS_F_ALWAYS_INLINE void
+ucp_rma_vec_block(const ucp_request_t *req, size_t index, void **buffer,
+                  uint64_t *remote_addr, size_t *length)
 {
-    ++ucp_ep_flush_state(ep)->send_sn;
+    const ucp_rma_iov_t *iov = req->send.rma_vec.iov;
+
+    if (iov != NULL) {
+        *buffer      = iov[index].buffer;
+        *remote_addr = iov[index].remote_addr;
+        *length      = iov[index].length;
+    } else {
+        *buffer      = UCS_PTR_BYTE_OFFSET(req->send.buffer,
+                                           (ptrdiff_t)index *
+                                           req->send.rma_vec.stride);
+        *remote_addr = req->send.rma_vec.remote_addr +
+                       (ptrdiff_t)index * req->send.rma_vec.remote_stride;
+        *length      = req->send.rma_vec.block_size;
+    }
+}
+
+/*
+ * Called when all blocks of a strided or indexed RMA are posted, or when the
+ * operation failed. The request is completed when the last UCT operation is.
+ */
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_rma_vec_request_posted(ucp_request_t *req, ucs_status_t status)
+{
+    uct_completion_t *comp = &req->send.state.uct_comp;
+
+    if (ucs_unlikely(status != UCS_OK) && (comp->status == UCS_OK)) {
+        comp->status = status;
+    }
+
+    req->send.state.dt.offset = req->send.length;
+    if (comp->count == 0) {
+        comp->func(comp, comp->status);
+    }
+
+    return UCS_OK;
+}
+
+/*
+ * Send the batch of small puts which are pending on the endpoint, to keep them
+ * ordered before other operations
+ */
+static UCS_F_ALWAYS_INLINE void ucp_rma_sw_aggr_flush(ucp_ep_h ep)
+{
+    if (ucs_unlikely(ucp_ep_ext_gen(ep)->rma_aggr_req != NULL)) {
+        ucp_rma_sw_aggr_send(ep);
+    }
+}
+
+/*
+ * Called when a software operation which requires remote completion is sent.
+ * @a rkey is the key the operation was issued with, or NULL for a batch of puts
+ * which is tracked by UCP_RKEY_FLUSH_FLAG_SW_AGGR instead.
+ */
+static inline void ucp_ep_rma_remote_request_sent(ucp_ep_t *ep, ucp_rkey_h rkey)
+{
+    ucp_ep_flush_state_t *flush_state = ucp_ep_flush_state(ep);
+
+    ++flush_state->send_sn;
     ++ep->worker->flush_ops_count;
+
+    if (rkey != NULL) {
+        rkey->flush.sw_sn  = flush_state->send_sn;
+        rkey->flush.flags |= UCP_RKEY_FLUSH_FLAG_SW;
+    }
 }
 
 static inline void ucp_ep_rma_remote_request_completed(ucp_ep_t *ep)
@@ -11,6 +11,7 @@
 #endif
 
 #include "rma.h"
+#include "rma.inl"
 
 #include <ucp/proto/proto_am.inl>
 
@@ -120,8 +121,212 @@ static ucs_status_t ucp_rma_basic_progress_get(uct_pending_req_t *self)
     return ucp_rma_request_advance(req, frag_length, status);
 }
 
+typedef struct {
+    const uct_iov_t *iov;
+    size_t          iovcnt;
+} ucp_rma_basic_vec_pack_ctx_t;
+
+static size_t ucp_rma_basic_vec_pack(void *dest, void *arg)
+{
+    ucp_rma_basic_vec_pack_ctx_t *ctx = arg;
+    size_t length                     = 0;
+    size_t i;
+
+    for (i = 0; i < ctx->iovcnt; ++i) {
+        memcpy(UCS_PTR_BYTE_OFFSET(dest, length), ctx->iov[i].buffer,
+               ctx->iov[i].length);
+        length += ctx->iov[i].length;
+    }
+
+    return length;
+}
+
+/*
+ * Collect the next blocks of a strided or indexed request which are adjacent
+ * in the remote memory, up to max_iov non-empty blocks and max_length bytes.
+ * Returns the number of blocks consumed from the request.
+ */
+static size_t
+ucp_rma_basic_vec_collect(ucp_request_t *req, uct_iov_t *iov, size_t max_iov,
+                          size_t max_length, size_t *iovcnt_p,
+                          uint64_t *remote_addr_p, size_t *length_p)
+{
+    size_t index   = req->send.state.dt.offset;
+    size_t iovcnt  = 0;
+    size_t length  = 0;
+    size_t nblocks = 0;
+    uint64_t remote_addr;
+    size_t block_length;
+    void *buffer;
+
+    do {
+        ucp_rma_vec_block(req, index + nblocks, &buffer, &remote_addr,
+                          &block_length);
+        if (block_length > 0) {
+            if (iovcnt == 0) {
+                *remote_addr_p = remote_addr;
+            } else if ((remote_addr != (*remote_addr_p + length)) ||
+                       ((length + block_length) > max_length)) {
+                break;
+            }
+
+            iov[iovcnt].buffer = buffer;
+            iov[iovcnt].length = block_length;
+            iov[iovcnt].count  = 1;
+            iov[iovcnt].stride = 0;
+            iov[iovcnt].memh   = UCT_MEM_HANDLE_NULL;
+            length            += block_length;
+            ++iovcnt;
+        }
+        ++nblocks;
+    } while ((iovcnt < max_iov) &&
+             ((index + nblocks) < req->send.length));
+
+    *iovcnt_p = iovcnt;
+    *length_p = length;
+    return nblocks;
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_rma_basic_vec_block_length(ucp_request_t *req)
+{
+    uint64_t remote_addr;
+    size_t length;
+    void *buffer;
+
+    ucp_rma_vec_block(req, req->send.state.dt.offset, &buffer, &remote_addr,
+                      &length);
+    return length;
+}
+
+static ucs_status_t ucp_rma_basic_progress_put_vec(uct_pending_req_t *self)
+{
+    ucp_request_t *req              = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_t *ep                    = req->send.ep;
+    ucp_rkey_h rkey                 = req->send.rma_vec.rkey;
+    ucp_lane_index_t lane           = req->send.lane;
+    ucp_ep_rma_config_t *rma_config = &ucp_ep_config(ep)->rma[lane];
+    uct_iov_t iov[UCP_RMA_VEC_MAX_IOV];
+    ucp_rma_basic_vec_pack_ctx_t pack_ctx;
+    size_t nblocks, iovcnt, length;
+    uint64_t remote_addr;
+    ucs_status_t status;
+    ssize_t packed_len;
+
+    ucs_assert(rkey->cache.ep_cfg_index == ep->cfg_index);
+    ucs_assert(rkey->cache.rma_lane == lane);
+
+    while (req->send.state.dt.offset < req->send.length) {
+        if (ucp_rma_basic_vec_block_length(req) >=
+            rma_config->put_zcopy_thresh) {
+            nblocks = ucp_rma_basic_vec_collect(req, iov,
+                                                ucs_min(rma_config->max_put_iov,
+                                                        UCP_RMA_VEC_MAX_IOV),
+                                                rma_config->max_put_zcopy,
+                                                &iovcnt, &remote_addr, &length);
+            status  = UCS_PROFILE_CALL(uct_ep_put_zcopy, ep->uct_eps[lane],
+                                       iov, iovcnt, remote_addr,
+                                       rkey->cache.rma_rkey,
+                                       &req->send.state.uct_comp);
+        } else {
+            nblocks = ucp_rma_basic_vec_collect(req, iov, UCP_RMA_VEC_MAX_IOV,
+                                                rma_config->max_put_bcopy,
+                                                &iovcnt, &remote_addr, &length);
+            if (iovcnt == 0) {
+                status = UCS_OK;
+            } else if ((iovcnt == 1) &&
+                       ((ssize_t)length <= rma_config->max_put_short)) {
+                status = UCS_PROFILE_CALL(uct_ep_put_short, ep->uct_eps[lane],
+                                          iov[0].buffer, length, remote_addr,
+                                          rkey->cache.rma_rkey);
+            } else {
+                pack_ctx.iov    = iov;
+                pack_ctx.iovcnt = iovcnt;
+                packed_len      = UCS_PROFILE_CALL(uct_ep_put_bcopy,
+                                                   ep->uct_eps[lane],
+                                                   ucp_rma_basic_vec_pack,
+                                                   &pack_ctx, remote_addr,
+                                                   rkey->cache.rma_rkey);
+                status = (packed_len > 0) ? UCS_OK : (ucs_status_t)packed_len;
+            }
+        }
+
+        if (status == UCS_INPROGRESS) {
+            ++req->send.state.uct_comp.count;
+        } else if (status == UCS_ERR_NO_RESOURCE) {
+            return UCS_ERR_NO_RESOURCE;
+        } else if (ucs_unlikely(status != UCS_OK)) {
+            return ucp_rma_vec_request_posted(req, status);
+        }
+
+        req->send.state.dt.offset += nblocks;
+    }
+
+    return ucp_rma_vec_request_posted(req, UCS_OK);
+}
+
+static ucs_status_t ucp_rma_basic_progress_get_vec(uct_pending_req_t *self)
+{
+    ucp_request_t *req              = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_t *ep                    = req->send.ep;
+    ucp_rkey_h rkey                 = req->send.rma_vec.rkey;
+    ucp_lane_index_t lane           = req->send.lane;
+    ucp_ep_rma_config_t *rma_config = &ucp_ep_config(ep)->rma[lane];
+    uct_iov_t iov[UCP_RMA_VEC_MAX_IOV];
+    size_t nblocks, iovcnt, length;
+    uint64_t remote_addr;
+    ucs_status_t status;
+    void *buffer;
+
+    ucs_assert(rkey->cache.ep_cfg_index == ep->cfg_index);
+    ucs_assert(rkey->cache.rma_lane == lane);
+
+    while (req->send.state.dt.offset < req->send.length) {
+        if (ucp_rma_basic_vec_block_length(req) >=
+            rma_config->get_zcopy_thresh) {
+            nblocks = ucp_rma_basic_vec_collect(req, iov,
+                                                ucs_min(rma_config->max_get_iov,
+                                                        UCP_RMA_VEC_MAX_IOV),
+                                                rma_config->max_get_zcopy,
+                                                &iovcnt, &remote_addr, &length);
+            status  = UCS_PROFILE_CALL(uct_ep_get_zcopy, ep->uct_eps[lane],
+                                       iov, iovcnt, remote_addr,
+                                       rkey->cache.rma_rkey,
+                                       &req->send.state.uct_comp);
+        } else {
+            /* bcopy get has no scatter callback, post the blocks one by one */
+            nblocks = 1;
+            ucp_rma_vec_block(req, req->send.state.dt.offset, &buffer,
+                              &remote_addr, &length);
+            if (length == 0) {
+                status = UCS_OK;
+            } else {
+                status = UCS_PROFILE_CALL(uct_ep_get_bcopy, ep->uct_eps[lane],
+                                          (uct_unpack_callback_t)memcpy,
+                                          buffer, length, remote_addr,
+                                          rkey->cache.rma_rkey,
+                                          &req->send.state.uct_comp);
+            }
+        }
+
+        if (status == UCS_INPROGRESS) {
+            ++req->send.state.uct_comp.count;
+        } else if (status == UCS_ERR_NO_RESOURCE) {
+            return UCS_ERR_NO_RESOURCE;
+        } else if (ucs_unlikely(status != UCS_OK)) {
+            return ucp_rma_vec_request_posted(req, status);
+        }
+
+        req->send.state.dt.offset += nblocks;
+    }
+
+    return ucp_rma_vec_request_posted(req, UCS_OK);
+}
+
 ucp_rma_proto_t ucp_rma_basic_proto = {
-    .name         = "basic_rma",
-    .progress_put = ucp_rma_basic_progress_put,
-    .progress_get = ucp_rma_basic_progress_get
+    .name             = "basic_rma",
+    .progress_put     = ucp_rma_basic_progress_put,
+    .progress_get     = ucp_rma_basic_progress_get,
+    .progress_put_vec = ucp_rma_basic_progress_put_vec,
+    .progress_get_vec = ucp_rma_basic_progress_get_vec
 };
@@ -118,6 +118,18 @@ static void ucp_rma_request_zcopy_completion(uct_completion_t *self,
     }
 }
 
+void ucp_rma_vec_request_completion(uct_completion_t *self,
+                                    ucs_status_t status)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t,
+                                          send.state.uct_comp);
+
+    if (ucs_likely(req->send.length == req->send.state.dt.offset)) {
+        ucs_free(req->send.rma_vec.iov_copy);
+        ucp_request_complete_send(req, status);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_t
 ucp_rma_request_init(ucp_request_t *req, ucp_ep_h ep, const void *buffer,
                      size_t length, uint64_t remote_addr, ucp_rkey_h rkey,
@@ -195,10 +207,69 @@ ucp_rma_nonblocking_cb(ucp_ep_h ep, const void *buffer, size_t length,
     return ucp_rma_send_request_cb(req, (ucp_send_nbx_callback_t)cb);
 }
 
+/* Keep the batched small puts ordered before a non-batched operation */
+static UCS_F_ALWAYS_INLINE void
+ucp_rma_sw_aggr_flush_rkey(ucp_ep_h ep, ucp_rkey_h rkey)
+{
+    if (rkey->cache.rma_proto == &ucp_rma_sw_proto) {
+        ucp_rma_sw_aggr_flush(ep);
+    }
+}
+
+/* Post a put with a resolved rkey, the worker lock must be held */
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_rma_put_nbi_nolock(ucp_ep_h ep, const void *buffer, size_t length,
+                       uint64_t remote_addr, ucp_rkey_h rkey)
+{
+    ucp_ep_rma_config_t *rma_config;
+    ucs_status_t status;
+
+    /* Fast path for a single short message */
+    if (ucs_likely((ssize_t)length <= rkey->cache.max_put_short)) {
+        status = UCS_PROFILE_CALL(uct_ep_put_short, ep->uct_eps[rkey->cache.rma_lane],
+                                  buffer, length, remote_addr, rkey->cache.rma_rkey);
+        if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+            return status;
+        }
+    }
+
+    if (rkey->cache.rma_proto == &ucp_rma_sw_proto) {
+        /* Batch small puts to a single active message */
+        if (length <= ep->worker->context->config.ext.rma_aggr_thresh) {
+            status = ucp_rma_sw_aggr_put(ep, buffer, length, remote_addr);
+            if (status != UCS_ERR_UNSUPPORTED) {
+                rkey->flush.flags |= UCP_RKEY_FLUSH_FLAG_SW_AGGR;
+                return status;
+            }
+        }
+
+        ucp_rma_sw_aggr_flush(ep);
+    }
+
+    rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
+    return ucp_rma_nonblocking(ep, buffer, length, remote_addr, rkey,
+                               rkey->cache.rma_proto->progress_put,
+                               rma_config->put_zcopy_thresh);
+}
+
+/* Post a get with a resolved rkey, the worker lock must be held */
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_rma_get_nbi_nolock(ucp_ep_h ep, void *buffer, size_t length,
+                       uint64_t remote_addr, ucp_rkey_h rkey)
+{
+    ucp_ep_rma_config_t *rma_config;
+
+    ucp_rma_sw_aggr_flush_rkey(ep, rkey);
+
+    rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
+    return ucp_rma_nonblocking(ep, buffer, length, remote_addr, rkey,
+                               rkey->cache.rma_proto->progress_get,
+                               rma_config->get_zcopy_thresh);
+}
+
 ucs_status_t ucp_put_nbi(ucp_ep_h ep, const void *buffer, size_t length,
                          uint64_t remote_addr, ucp_rkey_h rkey)
 {
-    ucp_ep_rma_config_t *rma_config;
     ucs_status_t status;
 
     UCP_RMA_CHECK(ep->worker->context, buffer, length);
@@ -213,19 +284,7 @@ ucs_status_t ucp_put_nbi(ucp_ep_h ep, const void *buffer, size_t length,
         goto out_unlock;
     }
 
-    /* Fast path for a single short message */
-    if (ucs_likely((ssize_t)length <= rkey->cache.max_put_short)) {
-        status = UCS_PROFILE_CALL(uct_ep_put_short, ep->uct_eps[rkey->cache.rma_lane],
-                                  buffer, length, remote_addr, rkey->cache.rma_rkey);
-        if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
-            goto out_unlock;
-        }
-    }
-
-    rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
-    status = ucp_rma_nonblocking(ep, buffer, length, remote_addr, rkey,
-                                 rkey->cache.rma_proto->progress_put,
-                                 rma_config->put_zcopy_thresh);
+    status = ucp_rma_put_nbi_nolock(ep, buffer, length, remote_addr, rkey);
 out_unlock:
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
     return status;
@@ -251,6 +310,8 @@ ucs_status_ptr_t ucp_put_nb(ucp_ep_h ep, const void *buffer, size_t length,
         goto out_unlock;
     }
 
+    ucp_rma_sw_aggr_flush_rkey(ep, rkey);
+
     /* Fast path for a single short message */
     if (ucs_likely((ssize_t)length <= (int)rkey->cache.max_put_short)) {
         status = UCS_PROFILE_CALL(uct_ep_put_short, ep->uct_eps[rkey->cache.rma_lane],
@@ -280,7 +341,6 @@ ucs_status_ptr_t ucp_put_nbx(ucp_ep_h ep, const void *buffer, size_t length,
 ucs_status_t ucp_get_nbi(ucp_ep_h ep, void *buffer, size_t length,
                          uint64_t remote_addr, ucp_rkey_h rkey)
 {
-    ucp_ep_rma_config_t *rma_config;
     ucs_status_t status;
 
     UCP_RMA_CHECK(ep->worker->context, buffer, length);
@@ -294,10 +354,7 @@ ucs_status_t ucp_get_nbi(ucp_ep_h ep, void *buffer, size_t length,
         goto out_unlock;
     }
 
-    rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
-    status = ucp_rma_nonblocking(ep, buffer, length, remote_addr, rkey,
-                                 rkey->cache.rma_proto->progress_get,
-                                 rma_config->get_zcopy_thresh);
+    status = ucp_rma_get_nbi_nolock(ep, buffer, length, remote_addr, rkey);
 out_unlock:
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
     return status;
@@ -323,6 +380,8 @@ ucs_status_ptr_t ucp_get_nb(ucp_ep_h ep, void *buffer, size_t length,
         goto out_unlock;
     }
 
+    ucp_rma_sw_aggr_flush_rkey(ep, rkey);
+
     rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
     ptr_status = ucp_rma_nonblocking_cb(ep, buffer, length, remote_addr, rkey,
                                         rkey->cache.rma_proto->progress_get,
@@ -339,6 +398,236 @@ ucs_status_ptr_t ucp_get_nbx(ucp_ep_h ep, void *buffer, size_t length,
     return UCS_STATUS_PTR(UCS_ERR_NOT_IMPLEMENTED);
 }
 
+/* Check if a block of a strided or indexed RMA can be posted without memory
+ * registration and without fragmentation */
+static UCS_F_ALWAYS_INLINE int
+ucp_rma_vec_block_is_supported(size_t length, size_t zcopy_thresh,
+                               size_t max_bcopy, size_t max_zcopy,
+                               size_t max_iov)
+{
+    if (length < zcopy_thresh) {
+        return length <= max_bcopy;
+    }
+
+    return (max_iov > 0) && (length <= max_zcopy);
+}
+
+static int ucp_rma_vec_is_supported(ucp_request_t *req, int is_get)
+{
+    ucp_ep_rma_config_t *rma_config = &ucp_ep_config(req->send.ep)->rma[req->send.lane];
+    uint64_t remote_addr;
+    size_t i, length;
+    void *buffer;
+    int supported;
+
+    for (i = 0; i < req->send.length; ++i) {
+        ucp_rma_vec_block(req, i, &buffer, &remote_addr, &length);
+        if (is_get) {
+            supported = ucp_rma_vec_block_is_supported(length,
+                                                       rma_config->get_zcopy_thresh,
+                                                       rma_config->max_get_bcopy,
+                                                       rma_config->max_get_zcopy,
+                                                       rma_config->max_get_iov);
+        } else {
+            supported = ucp_rma_vec_block_is_supported(length,
+                                                       rma_config->put_zcopy_thresh,
+                                                       rma_config->max_put_bcopy,
+                                                       rma_config->max_put_zcopy,
+                                                       rma_config->max_put_iov);
+        }
+
+        if (!supported) {
+            return 0;
+        }
+
+        if (req->send.rma_vec.iov == NULL) {
+            /* all strided blocks have the same length */
+            break;
+        }
+    }
+
+    return 1;
+}
+
+/* Post the blocks one by one with the contiguous protocol */
+static ucs_status_t ucp_rma_vec_post_blocks(ucp_request_t *req, int is_get)
+{
+    ucs_status_t status = UCS_OK;
+    ucs_status_t block_status;
+    uint64_t remote_addr;
+    size_t i, length;
+    void *buffer;
+
+    for (i = 0; i < req->send.length; ++i) {
+        ucp_rma_vec_block(req, i, &buffer, &remote_addr, &length);
+        if (length == 0) {
+            continue;
+        }
+
+        if (is_get) {
+            block_status = ucp_rma_get_nbi_nolock(req->send.ep, buffer, length,
+                                                  remote_addr,
+                                                  req->send.rma_vec.rkey);
+        } else {
+            block_status = ucp_rma_put_nbi_nolock(req->send.ep, buffer, length,
+                                                  remote_addr,
+                                                  req->send.rma_vec.rkey);
+        }
+
+        if (UCS_STATUS_IS_ERR(block_status)) {
+            return block_status;
+        } else if (block_status == UCS_INPROGRESS) {
+            status = UCS_INPROGRESS;
+        }
+    }
+
+    return status;
+}
+
+static ucs_status_t
+ucp_rma_vec_nbi(ucp_ep_h ep, void *buffer, ptrdiff_t stride,
+                uint64_t remote_addr, ptrdiff_t remote_stride,
+                size_t block_size, const ucp_rma_iov_t *iov, size_t count,
+                ucp_rkey_h rkey, int is_get)
+{
+    uct_pending_callback_t progress_cb;
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    status = UCP_RKEY_RESOLVE(rkey, ep, rma);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    req = ucp_request_get(ep->worker, "rma_vec");
+    if (req == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    progress_cb = is_get ? rkey->cache.rma_proto->progress_get_vec :
+                           rkey->cache.rma_proto->progress_put_vec;
+
+    req->flags                      = UCP_REQUEST_FLAG_RELEASED;
+    req->send.ep                    = ep;
+    req->send.buffer                = buffer;
+    req->send.datatype              = ucp_dt_make_contig(1);
+    req->send.mem_type              = UCS_MEMORY_TYPE_HOST;
+    req->send.length                = count;
+    req->send.rma_vec.rkey          = rkey;
+    req->send.rma_vec.iov           = iov;
+    req->send.rma_vec.iov_copy      = NULL;
+    req->send.rma_vec.remote_addr   = remote_addr;
+    req->send.rma_vec.stride        = stride;
+    req->send.rma_vec.remote_stride = remote_stride;
+    req->send.rma_vec.block_size    = block_size;
+    req->send.uct.func              = progress_cb;
+    req->send.lane                  = rkey->cache.rma_lane;
+    ucp_request_send_state_reset(req, ucp_rma_vec_request_completion,
+                                 UCP_REQUEST_SEND_PROTO_RMA);
+#if UCS_ENABLE_ASSERT
+    req->send.cb                    = NULL;
+#endif
+
+    if ((progress_cb == NULL) || !ucp_rma_vec_is_supported(req, is_get)) {
+        /* Blocks need memory registration, fragmentation or software
+         * emulation - use the contiguous protocol for each one */
+        status = ucp_rma_vec_post_blocks(req, is_get);
+        ucp_request_put(req);
+        return status;
+    }
+
+    status = ucp_request_send(req, 0);
+    if ((status == UCS_INPROGRESS) && (iov != NULL)) {
+        /* The request is pending, while the user may release the array */
+        req->send.rma_vec.iov_copy = ucs_malloc(count * sizeof(*iov),
+                                                "ucp_rma_iov");
+        ucs_assertv_always(req->send.rma_vec.iov_copy != NULL,
+                           "failed to allocate %zu rma iov entries", count);
+        memcpy(req->send.rma_vec.iov_copy, iov, count * sizeof(*iov));
+        req->send.rma_vec.iov = req->send.rma_vec.iov_copy;
+    }
+
+    return status;
+}
+
+ucs_status_t ucp_put_strided_nbi(ucp_ep_h ep, const void *buffer,
+                                 ptrdiff_t stride, uint64_t remote_addr,
+                                 ptrdiff_t remote_stride, size_t block_size,
+                                 size_t count, ucp_rkey_h rkey)
+{
+    ucs_status_t status;
+
+    UCP_RMA_CHECK(ep->worker->context, buffer, block_size * count);
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ucs_trace_req("put_strided_nbi buffer %p stride %td remote_addr %"PRIx64
+                  " remote_stride %td block_size %zu count %zu rkey %p to %s",
+                  buffer, stride, remote_addr, remote_stride, block_size,
+                  count, rkey, ucp_ep_peer_name(ep));
+
+    status = ucp_rma_vec_nbi(ep, (void*)buffer, stride, remote_addr,
+                             remote_stride, block_size, NULL, count, rkey, 0);
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
+ucs_status_t ucp_get_strided_nbi(ucp_ep_h ep, void *buffer, ptrdiff_t stride,
+                                 uint64_t remote_addr, ptrdiff_t remote_stride,
+                                 size_t block_size, size_t count,
+                                 ucp_rkey_h rkey)
+{
+    ucs_status_t status;
+
+    UCP_RMA_CHECK(ep->worker->context, buffer, block_size * count);
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ucs_trace_req("get_strided_nbi buffer %p stride %td remote_addr %"PRIx64
+                  " remote_stride %td block_size %zu count %zu rkey %p from %s",
+                  buffer, stride, remote_addr, remote_stride, block_size,
+                  count, rkey, ucp_ep_peer_name(ep));
+
+    status = ucp_rma_vec_nbi(ep, buffer, stride, remote_addr, remote_stride,
+                             block_size, NULL, count, rkey, 1);
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
+ucs_status_t ucp_put_iov_nbi(ucp_ep_h ep, const ucp_rma_iov_t *iov,
+                             size_t iovcnt, ucp_rkey_h rkey)
+{
+    ucs_status_t status;
+
+    UCP_RMA_CHECK(ep->worker->context, iov, iovcnt);
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ucs_trace_req("put_iov_nbi iov %p iovcnt %zu rkey %p to %s", iov, iovcnt,
+                  rkey, ucp_ep_peer_name(ep));
+
+    status = ucp_rma_vec_nbi(ep, NULL, 0, 0, 0, 0, iov, iovcnt, rkey, 0);
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
+ucs_status_t ucp_get_iov_nbi(ucp_ep_h ep, const ucp_rma_iov_t *iov,
+                             size_t iovcnt, ucp_rkey_h rkey)
+{
+    ucs_status_t status;
+
+    UCP_RMA_CHECK(ep->worker->context, iov, iovcnt);
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ucs_trace_req("get_iov_nbi iov %p iovcnt %zu rkey %p from %s", iov, iovcnt,
+                  rkey, ucp_ep_peer_name(ep));
+
+    status = ucp_rma_vec_nbi(ep, NULL, 0, 0, 0, 0, iov, iovcnt, rkey, 1);
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_put, (ep, buffer, length, remote_addr, rkey),
                  ucp_ep_h ep, const void *buffer, size_t length,
                  uint64_t remote_addr, ucp_rkey_h rkey)
@@ -46,7 +46,7 @@ static ucs_status_t ucp_rma_sw_progress_put(uct_pending_req_t *self)
                                      ucp_rma_sw_put_pack_cb, req, 0);
     if (packed_len > 0) {
         status = UCS_OK;
-        ucp_ep_rma_remote_request_sent(ep);
+        ucp_ep_rma_remote_request_sent(ep, req->send.rma.rkey);
     } else {
         status = (ucs_status_t)packed_len;
     }
@@ -55,6 +55,139 @@ static ucs_status_t ucp_rma_sw_progress_put(uct_pending_req_t *self)
                                    status);
 }
 
+static size_t ucp_rma_sw_put_batch_pack_cb(void *dest, void *arg)
+{
+    ucp_request_t *req         = arg;
+    ucp_put_batch_hdr_t *hdr   = dest;
+
+    memcpy(dest, req->send.rma_aggr.mdesc + 1, req->send.length);
+    hdr->ep_ptr = ucp_ep_dest_ep_ptr(req->send.ep);
+    ucs_assert(hdr->ep_ptr != 0);
+
+    return req->send.length;
+}
+
+static ucs_status_t ucp_rma_sw_progress_put_batch(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_t *ep       = req->send.ep;
+    ssize_t packed_len;
+
+    req->send.lane = ucp_ep_get_am_lane(ep);
+    packed_len     = uct_ep_am_bcopy(ep->uct_eps[req->send.lane],
+                                     UCP_AM_ID_PUT_BATCH,
+                                     ucp_rma_sw_put_batch_pack_cb, req, 0);
+    if (packed_len < 0) {
+        if (packed_len != UCS_ERR_NO_RESOURCE) {
+            /* the request itself is released by the caller */
+            ucs_mpool_put_inline(req->send.rma_aggr.mdesc);
+        }
+        return (ucs_status_t)packed_len;
+    }
+
+    ucs_assert(packed_len == req->send.length);
+    ucp_ep_rma_remote_request_sent(ep, NULL);
+    ucs_mpool_put_inline(req->send.rma_aggr.mdesc);
+    ucp_request_put(req);
+    return UCS_OK;
+}
+
+/*
+ * Add a small put to the batch of the endpoint. The batch is sent as a single
+ * active message, and acknowledged by a single completion message.
+ */
+ucs_status_t ucp_rma_sw_aggr_put(ucp_ep_h ep, const void *buffer,
+                                 size_t length, uint64_t remote_addr)
+{
+    ucp_worker_h worker   = ep->worker;
+    size_t max_length     = ucs_min(worker->context->config.ext.seg_size,
+                                    ucp_ep_config(ep)->am.max_bcopy);
+    size_t entry_length   = sizeof(ucp_put_batch_entry_t) + length;
+    ucp_request_t *req    = ucp_ep_ext_gen(ep)->rma_aggr_req;
+    ucp_put_batch_entry_t *entry;
+    ucp_mem_desc_t *mdesc;
+
+    if (ucs_unlikely(sizeof(ucp_put_batch_hdr_t) + entry_length > max_length)) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    if ((req != NULL) && ((req->send.length + entry_length) > max_length)) {
+        ucp_rma_sw_aggr_send(ep);
+        req = NULL;
+    }
+
+    if (req == NULL) {
+        req = ucp_request_get(worker, "rma_sw_aggr");
+        if (req == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        mdesc = ucp_worker_mpool_get(&worker->reg_mp);
+        if (mdesc == NULL) {
+            ucp_request_put(req);
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        req->flags                = UCP_REQUEST_FLAG_RELEASED;
+        req->send.ep              = ep;
+        req->send.length          = sizeof(ucp_put_batch_hdr_t);
+        req->send.rma_aggr.mdesc  = mdesc;
+        req->send.uct.func        = ucp_rma_sw_progress_put_batch;
+#if UCS_ENABLE_ASSERT
+        req->send.cb              = NULL;
+#endif
+        ucs_list_add_tail(&worker->rma_aggr_reqs, &req->send.rma_aggr.list);
+        ucp_ep_ext_gen(ep)->rma_aggr_req = req;
+    }
+
+    entry          = UCS_PTR_BYTE_OFFSET(req->send.rma_aggr.mdesc + 1,
+                                         req->send.length);
+    entry->address = remote_addr;
+    entry->length  = length;
+    memcpy(entry + 1, buffer, length);
+    req->send.length += entry_length;
+    return UCS_OK;
+}
+
+void ucp_rma_sw_aggr_send(ucp_ep_h ep)
+{
+    ucp_request_t *req = ucp_ep_ext_gen(ep)->rma_aggr_req;
+
+    ucs_assert(req != NULL);
+    ucs_trace_req("ep %p: sending batch of puts %p length %zu", ep, req,
+                  req->send.length);
+
+    ucp_ep_ext_gen(ep)->rma_aggr_req = NULL;
+    ucs_list_del(&req->send.rma_aggr.list);
+    ucp_request_send(req, 0);
+}
+
+void ucp_rma_sw_aggr_send_all(ucp_worker_h worker)
+{
+    ucp_request_t *req, *tmp;
+
+    ucs_list_for_each_safe(req, tmp, &worker->rma_aggr_reqs,
+                           send.rma_aggr.list) {
+        ucp_rma_sw_aggr_send(req->send.ep);
+    }
+}
+
+void ucp_rma_sw_aggr_cleanup(ucp_ep_h ep)
+{
+    ucp_request_t *req = ucp_ep_ext_gen(ep)->rma_aggr_req;
+
+    if (req == NULL) {
+        return;
+    }
+
+    ucs_debug("ep %p: dropping %zu bytes of batched puts", ep,
+              req->send.length);
+    ucp_ep_ext_gen(ep)->rma_aggr_req = NULL;
+    ucs_list_del(&req->send.rma_aggr.list);
+    ucs_mpool_put_inline(req->send.rma_aggr.mdesc);
+    ucp_request_put(req);
+}
+
 static size_t ucp_rma_sw_get_req_pack_cb(void *dest, void *arg)
 {
     ucp_request_t *req         = arg;
@@ -90,14 +223,16 @@ static ucs_status_t ucp_rma_sw_progress_get(uct_pending_req_t *self)
 
     /* get request packet sent, complete the request object when all data arrives */
     ucs_assert(packed_len == sizeof(ucp_get_req_hdr_t));
-    ucp_ep_rma_remote_request_sent(ep);
+    ucp_ep_rma_remote_request_sent(ep, req->send.rma.rkey);
     return UCS_OK;
 }
 
 ucp_rma_proto_t ucp_rma_sw_proto = {
-    .name         = "sw_rma",
-    .progress_put = ucp_rma_sw_progress_put,
-    .progress_get = ucp_rma_sw_progress_get
+    .name             = "sw_rma",
+    .progress_put     = ucp_rma_sw_progress_put,
+    .progress_get     = ucp_rma_sw_progress_get,
+    .progress_put_vec = NULL,
+    .progress_get_vec = NULL
 };
 
 static size_t ucp_rma_sw_pack_rma_ack(void *dest, void *arg)
@@ -161,6 +296,29 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_put_handler, (arg, data, length, am_flags),
     return UCS_OK;
 }
 
+UCS_PROFILE_FUNC(ucs_status_t, ucp_put_batch_handler, (arg, data, length, am_flags),
+                 void *arg, void *data, size_t length, unsigned am_flags)
+{
+    ucp_put_batch_hdr_t *hdr     = data;
+    void *end                    = UCS_PTR_BYTE_OFFSET(data, length);
+    ucp_put_batch_entry_t *entry = (ucp_put_batch_entry_t*)(hdr + 1);
+    ucp_worker_h worker          = arg;
+    ucp_ep_h ep;
+
+    while ((void*)entry < end) {
+        memcpy((void*)entry->address, entry + 1, entry->length);
+        entry = UCS_PTR_BYTE_OFFSET(entry + 1, entry->length);
+    }
+
+    ep = ucp_worker_get_ep_by_ptr(worker, hdr->ep_ptr);
+    if (ep == NULL) {
+        return UCS_OK;
+    }
+
+    ucp_rma_sw_send_cmpl(ep);
+    return UCS_OK;
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_rma_cmpl_handler, (arg, data, length, am_flags),
                  void *arg, void *data, size_t length, unsigned am_flags)
 {
@@ -269,6 +427,7 @@ static void ucp_rma_sw_dump_packet(ucp_worker_h worker, uct_am_trace_type_t type
                                    uint8_t id, const void *data, size_t length,
                                    char *buffer, size_t max)
 {
+    const ucp_put_batch_hdr_t *batchh;
     const ucp_get_req_hdr_t *geth;
     const ucp_rma_rep_hdr_t *reph;
     const ucp_cmpl_hdr_t *cmplh;
@@ -283,6 +442,11 @@ static void ucp_rma_sw_dump_packet(ucp_worker_h worker, uct_am_trace_type_t type
                  puth->ep_ptr);
         header_len = sizeof(*puth);
         break;
+    case UCP_AM_ID_PUT_BATCH:
+        batchh = data;
+        snprintf(buffer, max, "PUT_BATCH [ep_ptr 0x%lx len %zu]",
+                 batchh->ep_ptr, length);
+        return;
     case UCP_AM_ID_GET_REQ:
         geth = data;
         snprintf(buffer, max, "GET_REQ [addr 0x%lx len %zu reqptr 0x%lx ep 0x%lx]",
@@ -309,6 +473,8 @@ static void ucp_rma_sw_dump_packet(ucp_worker_h worker, uct_am_trace_type_t type
 
 UCP_DEFINE_AM(UCP_FEATURE_RMA, UCP_AM_ID_PUT, ucp_put_handler,
               ucp_rma_sw_dump_packet, 0);
+UCP_DEFINE_AM(UCP_FEATURE_RMA, UCP_AM_ID_PUT_BATCH, ucp_put_batch_handler,
+              ucp_rma_sw_dump_packet, 0);
 UCP_DEFINE_AM(UCP_FEATURE_RMA, UCP_AM_ID_GET_REQ, ucp_get_req_handler,
               ucp_rma_sw_dump_packet, 0);
 UCP_DEFINE_AM(UCP_FEATURE_RMA, UCP_AM_ID_GET_REP, ucp_get_rep_handler,
@@ -317,4 +483,5 @@ UCP_DEFINE_AM(UCP_FEATURE_RMA|UCP_FEATURE_AMO, UCP_AM_ID_CMPL,
               ucp_rma_cmpl_handler, ucp_rma_sw_dump_packet, 0);
 
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_PUT);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_PUT_BATCH);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_GET_REQ);
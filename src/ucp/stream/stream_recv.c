@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_request.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/profile/profile.h>
@@ -60,6 +61,34 @@
     ((ucp_stream_am_data_t *)_data - 1)->rdesc
 
 
+/* Offset of the payload in a descriptor allocated for rendezvous data */
+#define UCP_STREAM_RNDV_PAYLOAD_OFFSET                                        \
+    (sizeof(ucp_recv_desc_t) + sizeof(ucp_stream_am_data_t))
+
+
+static void ucp_stream_ep_process_deferred(ucp_worker_h worker,
+                                           ucp_ep_ext_proto_t *ep_ext);
+
+
+/*
+ * Check if the arriving data must be deferred to keep the order with a
+ * preceding rendezvous message.
+ */
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_ep_is_rndv_blocked(ucp_ep_ext_proto_t *ep_ext)
+{
+    return (ep_ext->stream.rndv_req != NULL) ||
+           !ucs_queue_is_empty(&ep_ext->stream.rndv_q);
+}
+
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_ep_has_expected(ucp_ep_ext_proto_t *ep_ext)
+{
+    return !ucp_stream_ep_has_data(ep_ext) &&
+           !ucs_queue_is_empty(&ep_ext->stream.match_q);
+}
+
+
 static UCS_F_ALWAYS_INLINE ucp_recv_desc_t *
 ucp_stream_rdesc_dequeue(ucp_ep_ext_proto_t *ep_ext)
 {
@@ -68,7 +97,8 @@ ucp_stream_rdesc_dequeue(ucp_ep_ext_proto_t *ep_ext)
                                                            stream_queue);
     ucs_assert(ucp_stream_ep_has_data(ep_ext));
     if (ucs_unlikely(ucs_queue_is_empty(&ep_ext->stream.match_q))) {
-        ucp_ep_from_ext_proto(ep_ext)->flags &= ~UCP_EP_FLAG_STREAM_HAS_DATA;
+        ucp_ep_from_ext_proto(ep_ext)->flags &= ~(UCP_EP_FLAG_STREAM_HAS_DATA |
+                                                  UCP_EP_FLAG_STREAM_NOTIFIED);
         if (ucp_stream_ep_is_queued(ep_ext)) {
             ucp_stream_ep_dequeue(ep_ext);
         }
@@ -125,6 +155,30 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_recv_data_nb, (ep, length),
     return status_ptr;
 }
 
+UCS_PROFILE_FUNC(ssize_t, ucp_stream_recv_data_nb_batch, (ep, iov, max_iov),
+                 ucp_ep_h ep, ucp_dt_iov_t *iov, size_t max_iov)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    size_t             count;
+    ucs_status_ptr_t   data;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_STREAM,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    for (count = 0; (count < max_iov) && ucp_stream_ep_has_data(ep_ext);
+         ++count) {
+        data = ucp_stream_recv_data_nb_nolock(ep, &iov[count].length);
+        ucs_assert(data != NULL);
+        iov[count].buffer = data;
+    }
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+
+    return count;
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_stream_rdesc_dequeue_and_release(ucp_recv_desc_t *rdesc,
                                      ucp_ep_ext_proto_t *ep_ext)
@@ -345,74 +399,295 @@ out:
     return req;
 }
 
-static UCS_F_ALWAYS_INLINE ucs_status_t
-ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
-                           ucp_stream_am_data_t *am_data, size_t length,
-                           unsigned am_flags)
+/*
+ * Unpack the data described by rdesc, relatively to base, to the expected
+ * requests.
+ *
+ * @return Nonzero if all data was unpacked.
+ */
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_rdesc_process_expected(ucp_ep_ext_proto_t *ep_ext, void *base,
+                                  ucp_recv_desc_t *rdesc)
 {
-    ucp_recv_desc_t  rdesc_tmp;
-    void            *payload;
-    ucp_recv_desc_t *rdesc;
-    ucp_request_t   *req;
-    ssize_t          unpacked;
-
-    rdesc_tmp.length         = length;
-    rdesc_tmp.payload_offset = sizeof(*am_data); /* add sizeof(*rdesc) only if
-                                                    am_data wont be handled in
-                                                    place */
+    void          *payload;
+    ucp_request_t *req;
+    ssize_t        unpacked;
 
-    /* First, process expected requests */
-    if (!ucp_stream_ep_has_data(ep_ext)) {
-        while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
-            req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
-                                                     ucp_request_t, recv.queue);
-            payload  = UCS_PTR_BYTE_OFFSET(am_data, rdesc_tmp.payload_offset);
-            unpacked = ucp_stream_rdata_unpack(payload, rdesc_tmp.length, req);
-            if (ucs_unlikely(unpacked < 0)) {
-                ucs_fatal("failed to unpack from am_data %p with offset %u to request %p",
-                          am_data, rdesc_tmp.payload_offset, req);
-            } else if (unpacked == rdesc_tmp.length) {
-                if (ucp_request_can_complete_stream_recv(req)) {
-                    ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
-                }
-                return UCS_OK;
+    while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
+        req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                                 ucp_request_t, recv.queue);
+        payload  = UCS_PTR_BYTE_OFFSET(base, rdesc->payload_offset);
+        unpacked = ucp_stream_rdata_unpack(payload, rdesc->length, req);
+        if (ucs_unlikely(unpacked < 0)) {
+            ucs_fatal("failed to unpack from %p with offset %u to request %p",
+                      base, rdesc->payload_offset, req);
+        } else if (unpacked == rdesc->length) {
+            if (ucp_request_can_complete_stream_recv(req)) {
+                ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
             }
-            ucp_stream_rdesc_advance(&rdesc_tmp, unpacked, ep_ext);
-            /* This request is full, try next one */
-            ucs_assert(ucp_request_can_complete_stream_recv(req));
-            ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
+            return 1;
         }
+        ucp_stream_rdesc_advance(rdesc, unpacked, ep_ext);
+        /* This request is full, try next one */
+        ucs_assert(ucp_request_can_complete_stream_recv(req));
+        ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
     }
 
-    ucs_assert(rdesc_tmp.length > 0);
+    return 0;
+}
+
+static UCS_F_ALWAYS_INLINE ucp_recv_desc_t*
+ucp_stream_rdesc_init(ucp_worker_t *worker, ucp_stream_am_data_t *am_data,
+                      const ucp_recv_desc_t *rdesc_tmp, unsigned am_flags)
+{
+    ucp_recv_desc_t *rdesc;
 
-    /* Now, enqueue the rest of data */
     if (ucs_likely(!(am_flags & UCT_CB_PARAM_FLAG_DESC))) {
         rdesc = (ucp_recv_desc_t*)ucs_mpool_get_inline(&worker->am_mp);
         ucs_assertv_always(rdesc != NULL,
                            "ucp recv descriptor is not allocated");
-        rdesc->length         = rdesc_tmp.length;
+        rdesc->length         = rdesc_tmp->length;
         /* reset offset to improve locality */
         rdesc->payload_offset = sizeof(*rdesc) + sizeof(*am_data);
         rdesc->flags          = 0;
         memcpy(ucp_stream_rdesc_payload(rdesc),
-               UCS_PTR_BYTE_OFFSET(am_data, rdesc_tmp.payload_offset),
-               rdesc_tmp.length);
+               UCS_PTR_BYTE_OFFSET(am_data, rdesc_tmp->payload_offset),
+               rdesc_tmp->length);
     } else {
         /* slowpath */
         rdesc                 = (ucp_recv_desc_t *)am_data - 1;
-        rdesc->length         = rdesc_tmp.length;
-        rdesc->payload_offset = rdesc_tmp.payload_offset + sizeof(*rdesc);
+        rdesc->length         = rdesc_tmp->length;
+        rdesc->payload_offset = rdesc_tmp->payload_offset + sizeof(*rdesc);
         rdesc->priv_length    = 0;
         rdesc->flags          = UCP_RECV_DESC_FLAG_UCT_DESC;
     }
 
-    ucp_ep_from_ext_proto(ep_ext)->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
+    return rdesc;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_rdesc_enqueue(ucp_worker_h worker, ucp_ep_ext_proto_t *ep_ext,
+                         ucp_recv_desc_t *rdesc)
+{
+    ucp_ep_h ep = ucp_ep_from_ext_proto(ep_ext);
+
+    ep->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
     ucs_queue_push(&ep_ext->stream.match_q, &rdesc->stream_queue);
 
+    /* Coalesce the notifications: the endpoint is reported once until it is
+     * polled, and once until it is drained in edge-triggered mode */
+    if (!ucp_stream_ep_is_queued(ep_ext) &&
+        ((ep->flags & (UCP_EP_FLAG_USED | UCP_EP_FLAG_STREAM_NOTIFIED)) ==
+         UCP_EP_FLAG_USED)) {
+        ucp_stream_ep_enqueue(ep_ext, worker);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
+                           ucp_stream_am_data_t *am_data, size_t length,
+                           unsigned am_flags)
+{
+    ucp_recv_desc_t  rdesc_tmp;
+    ucp_recv_desc_t *rdesc;
+
+    rdesc_tmp.length         = length;
+    rdesc_tmp.payload_offset = sizeof(*am_data); /* add sizeof(*rdesc) only if
+                                                    am_data wont be handled in
+                                                    place */
+
+    /* First, process expected requests */
+    if (!ucp_stream_ep_has_data(ep_ext) &&
+        ucp_stream_rdesc_process_expected(ep_ext, am_data, &rdesc_tmp)) {
+        return UCS_OK;
+    }
+
+    ucs_assert(rdesc_tmp.length > 0);
+
+    /* Now, enqueue the rest of data */
+    rdesc = ucp_stream_rdesc_init(worker, am_data, &rdesc_tmp, am_flags);
+    ucp_stream_rdesc_enqueue(worker, ep_ext, rdesc);
     return UCS_INPROGRESS;
 }
 
+/*
+ * Process data which was deferred behind a rendezvous message, or fetched by
+ * rendezvous to an internal buffer.
+ */
+static void ucp_stream_rdesc_arrived(ucp_worker_h worker,
+                                     ucp_ep_ext_proto_t *ep_ext,
+                                     ucp_recv_desc_t *rdesc)
+{
+    if (!ucp_stream_ep_has_data(ep_ext) &&
+        ucp_stream_rdesc_process_expected(ep_ext, rdesc, rdesc)) {
+        ucp_recv_desc_release(rdesc);
+        return;
+    }
+
+    ucp_stream_rdesc_enqueue(worker, ep_ext, rdesc);
+}
+
+static void
+ucp_stream_rndv_recv_start(ucp_worker_h worker, ucp_request_t *rreq,
+                           const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                           uint64_t rts_seq, void *buffer,
+                           ucs_memory_type_t mem_type,
+                           ucp_am_recv_data_nbx_callback_t cb)
+{
+    /* the request is released upon completion */
+    rreq->flags             = UCP_REQUEST_FLAG_RECV | UCP_REQUEST_FLAG_RECV_AM |
+                              UCP_REQUEST_FLAG_CALLBACK |
+                              UCP_REQUEST_FLAG_RELEASED;
+    rreq->status            = UCS_OK;
+    rreq->recv.worker       = worker;
+    rreq->recv.buffer       = buffer;
+    rreq->recv.datatype     = ucp_dt_make_contig(1);
+    rreq->recv.length       = rndv_rts_hdr->size;
+    rreq->recv.mem_type     = mem_type;
+    rreq->recv.req_id       = worker->rndv_req_id++;
+    rreq->recv.tag.am_cb    = cb;
+    rreq->recv.tag.rndv_req = NULL;
+
+    ucp_dt_recv_state_init(&rreq->recv.state, buffer, rreq->recv.datatype,
+                           rndv_rts_hdr->size);
+    ucp_rndv_matched(worker, rreq, rndv_rts_hdr, rts_seq);
+}
+
+static void ucp_stream_rndv_recv_completion(void *request, ucs_status_t status,
+                                            size_t length, void *user_data)
+{
+    ucp_request_t *req = user_data; /* user's stream receive request */
+
+    if (ucs_likely(status == UCS_OK)) {
+        req->recv.stream.offset += length;
+    }
+
+    ucp_request_complete_stream_recv_dequeued(req, status);
+}
+
+static void
+ucp_stream_rndv_recv_internal_completion(void *request, ucs_status_t status,
+                                         size_t length, void *user_data)
+{
+    ucp_request_t *rreq        = (ucp_request_t*)request - 1;
+    ucp_ep_ext_proto_t *ep_ext = user_data;
+    ucp_worker_h worker        = rreq->recv.worker;
+    ucp_recv_desc_t *rdesc;
+
+    rdesc = UCS_PTR_BYTE_OFFSET(rreq->recv.buffer,
+                                -UCP_STREAM_RNDV_PAYLOAD_OFFSET);
+    if (ep_ext == NULL) {
+        /* the endpoint was destroyed, drop the data */
+        ucs_free(rdesc);
+        return;
+    }
+
+    ucs_assert(ep_ext->stream.rndv_req == rreq);
+    ep_ext->stream.rndv_req = NULL;
+
+    if (ucs_likely(status == UCS_OK)) {
+        rdesc->length = length;
+        ucp_stream_rdesc_arrived(worker, ep_ext, rdesc);
+    } else {
+        ucs_error("ep %p: failed to receive stream rendezvous data: %s",
+                  ucp_ep_from_ext_proto(ep_ext), ucs_status_string(status));
+        ucs_free(rdesc);
+    }
+
+    ucp_stream_ep_process_deferred(worker, ep_ext);
+}
+
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_rndv_is_inplace(const ucp_request_t *req, size_t length)
+{
+    size_t offset = req->recv.stream.offset + length;
+
+    /* The request is completed by the rendezvous, so it has to be completed
+     * with exactly this data, see ucp_request_can_complete_stream_recv() */
+    return UCP_DT_IS_CONTIG(req->recv.datatype) &&
+           (offset <= req->recv.length) &&
+           ((offset == req->recv.length) ||
+            (!(req->flags & UCP_REQUEST_FLAG_STREAM_RECV_WAITALL) &&
+             ((offset % ucp_contig_dt_elem_size(req->recv.datatype)) == 0)));
+}
+
+static void ucp_stream_rndv_start(ucp_worker_h worker,
+                                  ucp_ep_ext_proto_t *ep_ext,
+                                  const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                                  uint64_t rts_seq)
+{
+    ucp_request_t *rreq, *req;
+    ucp_recv_desc_t *rdesc;
+
+    rreq = ucp_request_get(worker, "stream_rndv_recv");
+    if (ucs_unlikely(rreq == NULL)) {
+        ucs_error("failed to allocate stream rendezvous receive request");
+        goto err;
+    }
+
+    if (ucp_stream_ep_has_expected(ep_ext)) {
+        req = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                            ucp_request_t, recv.queue);
+        if (ucp_stream_rndv_is_inplace(req, rndv_rts_hdr->size)) {
+            /* The data lands directly in the user buffer, and the data which
+             * follows goes to the next requests */
+            ucs_queue_pull_non_empty(&ep_ext->stream.match_q);
+            rreq->user_data = req;
+            ucp_stream_rndv_recv_start(worker, rreq, rndv_rts_hdr, rts_seq,
+                                       UCS_PTR_BYTE_OFFSET(req->recv.buffer,
+                                                           req->recv.stream.offset),
+                                       req->recv.mem_type,
+                                       ucp_stream_rndv_recv_completion);
+            return;
+        }
+    }
+
+    /* Receive to an internal buffer, which becomes a regular data descriptor
+     * once it is complete. Until then, any arriving data is deferred. */
+    rdesc = ucs_malloc(UCP_STREAM_RNDV_PAYLOAD_OFFSET + rndv_rts_hdr->size,
+                       "ucp recv desc for stream rndv");
+    if (ucs_unlikely(rdesc == NULL)) {
+        ucs_error("failed to allocate stream rendezvous buffer of %zu bytes",
+                  rndv_rts_hdr->size);
+        ucp_request_put(rreq);
+        goto err;
+    }
+
+    rdesc->flags            = UCP_RECV_DESC_FLAG_MALLOC;
+    rdesc->length           = rndv_rts_hdr->size;
+    rdesc->payload_offset   = UCP_STREAM_RNDV_PAYLOAD_OFFSET;
+    rreq->user_data         = ep_ext;
+    ep_ext->stream.rndv_req = rreq;
+    ucp_stream_rndv_recv_start(worker, rreq, rndv_rts_hdr, rts_seq,
+                               ucp_stream_rdesc_payload(rdesc),
+                               UCS_MEMORY_TYPE_HOST,
+                               ucp_stream_rndv_recv_internal_completion);
+    return;
+
+err:
+    ucp_rndv_send_ats(worker, rndv_rts_hdr, UCS_ERR_NO_MEMORY);
+}
+
+static void ucp_stream_ep_process_deferred(ucp_worker_h worker,
+                                           ucp_ep_ext_proto_t *ep_ext)
+{
+    ucp_recv_desc_t *rdesc;
+
+    while ((ep_ext->stream.rndv_req == NULL) &&
+           !ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+        rdesc = ucs_queue_pull_elem_non_empty(&ep_ext->stream.rndv_q,
+                                              ucp_recv_desc_t, stream_queue);
+        if (rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) {
+            ucp_stream_rndv_start(worker, ep_ext,
+                                  (ucp_rndv_rts_hdr_t*)(rdesc + 1),
+                                  rdesc->rndv_rts_seq);
+            ucp_recv_desc_release(rdesc);
+        } else {
+            ucp_stream_rdesc_arrived(worker, ep_ext, rdesc);
+        }
+    }
+}
+
 void ucp_stream_ep_init(ucp_ep_h ep)
 {
     ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
@@ -421,12 +696,15 @@ void ucp_stream_ep_init(ucp_ep_h ep)
         ep_ext->stream.ready_list.prev = NULL;
         ep_ext->stream.ready_list.next = NULL;
         ucs_queue_head_init(&ep_ext->stream.match_q);
+        ucs_queue_head_init(&ep_ext->stream.rndv_q);
+        ep_ext->stream.rndv_req = NULL;
     }
 }
 
 void ucp_stream_ep_cleanup(ucp_ep_h ep, ucs_status_t status)
 {
     ucp_ep_ext_proto_t* ep_ext;
+    ucp_recv_desc_t *rdesc;
     ucp_request_t *req;
     size_t length;
     void *data;
@@ -443,6 +721,18 @@ void ucp_stream_ep_cleanup(ucp_ep_h ep, ucs_status_t status)
 
     ep_ext = ucp_ep_ext_proto(ep);
 
+    /* drop the data which was not received yet */
+    if (ep_ext->stream.rndv_req != NULL) {
+        ep_ext->stream.rndv_req->user_data = NULL;
+        ep_ext->stream.rndv_req            = NULL;
+    }
+
+    while (!ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+        rdesc = ucs_queue_pull_elem_non_empty(&ep_ext->stream.rndv_q,
+                                              ucp_recv_desc_t, stream_queue);
+        ucp_recv_desc_release(rdesc);
+    }
+
     if (ucp_stream_ep_is_queued(ep_ext)) {
         ucp_stream_ep_dequeue(ep_ext);
     }
@@ -474,6 +764,8 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
     ucp_stream_am_data_t *data      = am_data;
     ucp_ep_h              ep;
     ucp_ep_ext_proto_t    *ep_ext;
+    ucp_recv_desc_t       rdesc_tmp;
+    ucp_recv_desc_t       *rdesc;
     ucs_status_t          status;
 
     ucs_assert(am_length >= sizeof(ucp_stream_am_hdr_t));
@@ -487,21 +779,65 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
     }
 
     ep_ext = ucp_ep_ext_proto(ep);
-    status = ucp_stream_am_data_process(worker, ep_ext, data,
-                                        am_length - sizeof(data->hdr),
-                                        am_flags);
-    if (status == UCS_OK) {
-        /* rdesc was processed in place */
+    if (ucs_unlikely(ucp_stream_ep_is_rndv_blocked(ep_ext))) {
+        /* keep the order with a preceding rendezvous message */
+        rdesc_tmp.length         = am_length - sizeof(data->hdr);
+        rdesc_tmp.payload_offset = sizeof(*data);
+        rdesc = ucp_stream_rdesc_init(worker, data, &rdesc_tmp, am_flags);
+        ucs_queue_push(&ep_ext->stream.rndv_q, &rdesc->stream_queue);
+    } else {
+        status = ucp_stream_am_data_process(worker, ep_ext, data,
+                                            am_length - sizeof(data->hdr),
+                                            am_flags);
+        if (status == UCS_OK) {
+            /* rdesc was processed in place */
+            return UCS_OK;
+        }
+
+        ucs_assert(status == UCS_INPROGRESS);
+    }
+
+    return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
+}
+
+static ucs_status_t
+ucp_stream_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                            unsigned am_flags)
+{
+    ucp_worker_h worker              = am_arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = am_data;
+    uint64_t rts_seq                 = worker->rndv_rts_recv_seq++;
+    ucp_ep_ext_proto_t *ep_ext;
+    ucp_recv_desc_t *rdesc;
+    ucs_status_t status;
+    ucp_ep_h ep;
+
+    ep = ucp_worker_get_ep_by_ptr(worker, rndv_rts_hdr->sreq.ep_ptr);
+    if (ucs_unlikely((ep == NULL) || (ep->flags & UCP_EP_FLAG_CLOSED))) {
+        ucs_trace_data("ep %p: stream is invalid, flags=0x%x", ep,
+                       ep == NULL ? 0u : ep->flags);
+        /* drop the data, and let the sender complete */
+        ucp_rndv_send_ats(worker, rndv_rts_hdr, UCS_ERR_CANCELED);
         return UCS_OK;
     }
 
-    ucs_assert(status == UCS_INPROGRESS);
+    ep_ext = ucp_ep_ext_proto(ep);
+    if (ucs_likely(!ucp_stream_ep_is_rndv_blocked(ep_ext))) {
+        ucp_stream_rndv_start(worker, ep_ext, rndv_rts_hdr, rts_seq);
+        return UCS_OK;
+    }
 
-    if (!ucp_stream_ep_is_queued(ep_ext) && (ep->flags & UCP_EP_FLAG_USED)) {
-        ucp_stream_ep_enqueue(ep_ext, worker);
+    /* keep the order with a preceding rendezvous message */
+    status = ucp_recv_desc_init(worker, am_data, am_length, 0, am_flags, 0,
+                                UCP_RECV_DESC_FLAG_RNDV, 0, &rdesc);
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
+        ucp_rndv_send_ats(worker, rndv_rts_hdr, status);
+        return UCS_OK;
     }
 
-    return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
+    rdesc->rndv_rts_seq = rts_seq;
+    ucs_queue_push(&ep_ext->stream.rndv_q, &rdesc->stream_queue);
+    return status;
 }
 
 static void ucp_stream_am_dump(ucp_worker_h worker, uct_am_trace_type_t type,
@@ -523,4 +859,8 @@ static void ucp_stream_am_dump(ucp_worker_h worker, uct_am_trace_type_t type,
 UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_DATA, ucp_stream_am_handler,
               ucp_stream_am_dump, 0);
 
+UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_RNDV_RTS,
+              ucp_stream_rndv_rts_handler, NULL, 0);
+
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_DATA);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_RNDV_RTS);
@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
 
@@ -47,19 +48,84 @@ static void ucp_stream_send_req_init(ucp_request_t* req, ucp_ep_h ep,
                                 sizeof(req->send.msg_proto.tag));
 }
 
+static size_t ucp_stream_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+
+    /* the receiver finds the stream by the endpoint in the request header */
+    rndv_rts_hdr->super.tag = 0;
+    return ucp_rndv_rts_pack(sreq, rndv_rts_hdr);
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_stream_progress_rndv_rts, (self),
+                 uct_pending_req_t *self)
+{
+    return ucp_rndv_progress_rts(self, UCP_AM_ID_STREAM_RNDV_RTS,
+                                 ucp_stream_rndv_rts_pack, 0);
+}
+
+static ucs_status_t ucp_stream_send_start_rndv(ucp_request_t *sreq)
+{
+    ucp_worker_h worker = sreq->send.ep->worker;
+    ucs_status_t status;
+
+    ucp_trace_req(sreq, "stream start_rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(sreq->send.ep), sreq->send.buffer,
+                  sreq->send.length);
+    UCS_PROFILE_REQUEST_EVENT(sreq, "stream_start_rndv", sreq->send.length);
+
+    sreq->flags            |= UCP_REQUEST_FLAG_SEND_RNDV;
+    sreq->send.rndv_req_id  = worker->rndv_req_id++;
+    sreq->send.uct.func     = ucp_stream_progress_rndv_rts;
+
+    /* the remote side refers to the request by its ID */
+    ucp_request_id_alloc(worker, sreq);
+
+    status = ucp_tag_rndv_reg_send_buffer(sreq);
+    if (status != UCS_OK) {
+        ucp_request_id_release(worker, sreq);
+    }
+
+    return status;
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_stream_get_rndv_threshold(const ucp_request_t *req)
+{
+    const ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+
+    /* Same as tag rendezvous: RMA can be used for contiguous buffers only */
+    if (UCP_DT_IS_GENERIC(req->send.datatype)) {
+        return config->tag.rndv.am_thresh;
+    }
+
+    return ucs_min(config->tag.rndv.rma_thresh, config->tag.rndv.am_thresh);
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
 ucp_stream_send_req(ucp_request_t *req, size_t count,
                     const ucp_ep_msg_config_t* msg_config,
                     ucp_send_callback_t cb, const ucp_request_send_proto_t *proto)
 {
+    size_t rndv_thresh  = ucp_stream_get_rndv_threshold(req);
     size_t zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
-                                                        count, SIZE_MAX);
+                                                        count, rndv_thresh);
     ssize_t max_short   = ucp_proto_get_short_max(req, msg_config);
 
     ucs_status_t status = ucp_request_send_start(req, max_short, zcopy_thresh,
-                                                 SIZE_MAX, count, msg_config,
+                                                 rndv_thresh, count, msg_config,
                                                  proto);
-    if (status != UCS_OK) {
+    if (status == UCS_ERR_NO_PROGRESS) {
+        /* RMA/AM rendezvous, the data lands in the posted receive buffer */
+        ucs_assert(req->send.length >= rndv_thresh);
+        status = ucp_stream_send_start_rndv(req);
+        if (status != UCS_OK) {
+            return UCS_STATUS_PTR(status);
+        }
+
+        UCP_EP_STAT_TAG_OP(req->send.ep, RNDV);
+    } else if (status != UCS_OK) {
         return UCS_STATUS_PTR(status);
     }
 
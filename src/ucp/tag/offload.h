@@ -23,7 +23,7 @@ enum {
  */
 typedef struct {
     uintptr_t      ep_ptr;
-    uintptr_t      reqptr;       /* Request pointer */
+    uintptr_t      reqptr;       /* Request ID */
     uint8_t        md_index;     /* md index */
 } UCS_S_PACKED ucp_tag_offload_unexp_rndv_hdr_t;
 
@@ -0,0 +1,345 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "offload_sw.h"
+#include "tag_match.inl"
+
+#include <ucp/core/ucp_worker.h>
+#include <ucp/core/ucp_request.inl>
+#include <ucs/arch/atomic.h>
+#include <ucs/debug/memtrack_int.h>
+#include <sched.h>
+
+
+/* Number of empty polls before the helper thread starts yielding the CPU */
+#define UCP_TAG_OFFLOAD_SW_SPIN_COUNT   1024
+
+
+static void ucp_tag_offload_sw_complete(ucp_tag_offload_sw_t *sw,
+                                        ucp_request_t *req,
+                                        ucp_recv_desc_t *rdesc)
+{
+    uint64_t head;
+
+    req->recv.tag.sw_rdesc = rdesc;
+    do {
+        head                 = sw->results;
+        req->recv.queue.next = (ucs_queue_elem_t*)head;
+    } while (ucs_atomic_cswap64(&sw->results, head,
+                                (uintptr_t)&req->recv.queue) != head);
+
+    /* Wake up the worker if it may be waiting for events */
+    if ((head == 0) &&
+        (sw->worker->context->config.features & UCP_FEATURE_WAKEUP)) {
+        ucp_worker_signal(sw->worker);
+    }
+}
+
+static void ucp_tag_offload_sw_post(ucp_tag_offload_sw_t *sw,
+                                    ucp_request_t *req)
+{
+    ucp_tag_match_t *tm = &sw->tm;
+    ucp_request_queue_t *req_queue;
+    ucp_recv_desc_t *rdesc;
+
+    rdesc = ucp_tag_unexp_search(tm, req->recv.tag.tag, req->recv.tag.tag_mask,
+                                 1, "sw_offload");
+    if (rdesc != NULL) {
+        ucp_tag_offload_sw_complete(sw, req, rdesc);
+        return;
+    }
+
+    req_queue = ucp_tag_exp_get_req_queue(tm, req);
+    ++tm->expected.sw_all_count;
+    ++req_queue->sw_count;
+    req_queue->block_count += !!(req->flags & UCP_REQUEST_FLAG_BLOCK_OFFLOAD);
+    ucp_tag_exp_push(tm, req_queue, req);
+}
+
+static void ucp_tag_offload_sw_arrive(ucp_tag_offload_sw_t *sw,
+                                      ucp_recv_desc_t *rdesc)
+{
+    ucp_tag_t tag = ucp_rdesc_get_tag(rdesc);
+    ucp_request_t *req;
+
+    req = ucp_tag_exp_search(&sw->tm, tag);
+    if (req != NULL) {
+        ucp_tag_offload_sw_complete(sw, req, rdesc);
+    } else {
+        ucp_tag_unexp_recv(&sw->tm, rdesc, tag);
+    }
+}
+
+static void ucp_tag_offload_sw_cancel(ucp_tag_offload_sw_t *sw,
+                                      ucp_request_t *req)
+{
+    ucp_request_queue_t *req_queue = ucp_tag_exp_get_req_queue(&sw->tm, req);
+    ucs_queue_iter_t iter;
+    ucp_request_t *qreq;
+
+    /* The request could be already matched, then just ignore the event */
+    ucs_queue_for_each_safe(qreq, iter, &req_queue->queue, recv.queue) {
+        if (qreq == req) {
+            ucp_tag_exp_delete(req, &sw->tm, req_queue, iter);
+            ucp_tag_offload_sw_complete(sw, req, NULL);
+            return;
+        }
+    }
+}
+
+static unsigned ucp_tag_offload_sw_match_batch(ucp_tag_offload_sw_t *sw)
+{
+    uint32_t tail = sw->tail;
+    uint32_t head = sw->head;
+    ucp_tag_offload_sw_ev_t *ev;
+    unsigned count;
+
+    ucs_memory_cpu_load_fence();
+
+    for (count = 0; (tail != head) && (count < UCP_TAG_OFFLOAD_SW_BATCH);
+         ++count, ++tail) {
+        ev = &sw->ring[tail & (UCP_TAG_OFFLOAD_SW_RING_SIZE - 1)];
+        switch (ev->type) {
+        case UCP_TAG_OFFLOAD_SW_EV_POST:
+            ucp_tag_offload_sw_post(sw, ev->arg);
+            break;
+        case UCP_TAG_OFFLOAD_SW_EV_ARRIVE:
+            ucp_tag_offload_sw_arrive(sw, ev->arg);
+            break;
+        case UCP_TAG_OFFLOAD_SW_EV_CANCEL:
+            ucp_tag_offload_sw_cancel(sw, ev->arg);
+            break;
+        case UCP_TAG_OFFLOAD_SW_EV_PAUSE:
+            /* Hand over the private context until the worker resumes us */
+            ucs_memory_cpu_store_fence();
+            sw->paused = 1;
+            while (sw->paused) {
+                ucs_arch_wait_mem((void*)&sw->paused);
+            }
+            ucs_memory_cpu_load_fence();
+            break;
+        }
+    }
+
+    ucs_memory_cpu_fence();
+    sw->tail = tail;
+    return count;
+}
+
+static void *ucp_tag_offload_sw_thread_func(void *arg)
+{
+    ucp_tag_offload_sw_t *sw = arg;
+    unsigned idle            = 0;
+
+    ucs_debug("worker %p: tag matching thread started", sw->worker);
+
+    while (!sw->stop) {
+        if (ucp_tag_offload_sw_match_batch(sw) > 0) {
+            idle = 0;
+        } else if (++idle >= UCP_TAG_OFFLOAD_SW_SPIN_COUNT) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static unsigned ucp_tag_offload_sw_progress(void *arg)
+{
+    ucp_tag_offload_sw_t *sw = arg;
+    ucs_queue_elem_t *elem, *next, *list;
+    ucp_recv_desc_t *rdesc;
+    ucp_request_t *req;
+    unsigned count;
+
+    if (ucs_likely(sw->results == 0)) {
+        return 0;
+    }
+
+    /* Detach all results and restore the order of matching */
+    elem = (ucs_queue_elem_t*)ucs_atomic_swap64(&sw->results, 0);
+    list = NULL;
+    while (elem != NULL) {
+        next       = elem->next;
+        elem->next = list;
+        list       = elem;
+        elem       = next;
+    }
+
+    count = 0;
+    while (list != NULL) {
+        req   = ucs_container_of(list, ucp_request_t, recv.queue);
+        list  = list->next;
+        rdesc = req->recv.tag.sw_rdesc;
+
+        req->flags &= ~UCP_REQUEST_FLAG_SW_OFFLOADED;
+        if (rdesc == NULL) {
+            ucp_request_complete_tag_recv(sw->worker, req, UCS_ERR_CANCELED,
+                                          "user_cancel");
+        } else {
+            ucp_tag_recv_unexp_matched(sw->worker, req, rdesc);
+        }
+        ++count;
+    }
+
+    return count;
+}
+
+static int ucp_tag_offload_sw_is_needed(ucp_worker_h worker)
+{
+    ucp_context_h context = worker->context;
+    ucp_rsc_index_t iface_id;
+
+    if (!context->config.ext.tm_sw_offload ||
+        !(context->config.features & UCP_FEATURE_TAG)) {
+        return 0;
+    }
+
+    /* Hardware tag matching is preferred when available */
+    for (iface_id = 0; iface_id < worker->num_ifaces; ++iface_id) {
+        if (worker->ifaces[iface_id]->attr.cap.flags &
+            (UCT_IFACE_FLAG_TAG_EAGER_BCOPY | UCT_IFACE_FLAG_TAG_RNDV_ZCOPY)) {
+            ucs_debug("worker %p: not using software tag offload since "
+                      "interface %d supports tag matching", worker, iface_id);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+ucs_status_t ucp_tag_offload_sw_init(ucp_worker_h worker)
+{
+    ucp_tag_offload_sw_t *sw;
+    ucs_status_t status;
+    int ret;
+
+    if (!ucp_tag_offload_sw_is_needed(worker)) {
+        return UCS_OK;
+    }
+
+    ret = ucs_posix_memalign((void**)&sw, UCS_SYS_CACHE_LINE_SIZE,
+                             sizeof(*sw), "ucp_tag_offload_sw");
+    if (ret != 0) {
+        ucs_error("failed to allocate software tag offload context");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    status = ucp_tag_match_init(worker->context, &sw->tm);
+    if (status != UCS_OK) {
+        goto err_free;
+    }
+
+    sw->worker  = worker;
+    sw->stop    = 0;
+    sw->paused  = 0;
+    sw->head    = 0;
+    sw->tail    = 0;
+    sw->results = 0;
+    sw->prog_id = UCS_CALLBACKQ_ID_NULL;
+
+    ret = pthread_create(&sw->thread, NULL, ucp_tag_offload_sw_thread_func, sw);
+    if (ret != 0) {
+        ucs_error("pthread_create() returned %d: %m", ret);
+        status = UCS_ERR_IO_ERROR;
+        goto err_tm_cleanup;
+    }
+
+    uct_worker_progress_register_safe(worker->uct, ucp_tag_offload_sw_progress,
+                                      sw, 0, &sw->prog_id);
+    worker->tm.offload.sw = sw;
+    ucs_debug("worker %p: using software tag offload", worker);
+    return UCS_OK;
+
+err_tm_cleanup:
+    ucp_tag_match_cleanup(&sw->tm);
+err_free:
+    ucs_free(sw);
+    return status;
+}
+
+void ucp_tag_offload_sw_cleanup(ucp_worker_h worker)
+{
+    ucp_tag_offload_sw_t *sw = worker->tm.offload.sw;
+    ucs_queue_elem_t *elem;
+    ucp_recv_desc_t *rdesc, *tmp;
+    ucp_request_t *req;
+
+    if (sw == NULL) {
+        return;
+    }
+
+    /* Let the helper thread process all pending events, then stop it */
+    while (sw->tail != sw->head) {
+        sched_yield();
+    }
+    sw->stop = 1;
+    pthread_join(sw->thread, NULL);
+
+    uct_worker_progress_unregister_safe(worker->uct, &sw->prog_id);
+    worker->tm.offload.sw = NULL;
+
+    /* Release descriptors of matches which were not completed */
+    elem = (ucs_queue_elem_t*)sw->results;
+    while (elem != NULL) {
+        req  = ucs_container_of(elem, ucp_request_t, recv.queue);
+        elem = elem->next;
+        if (req->recv.tag.sw_rdesc != NULL) {
+            ucp_recv_desc_release(req->recv.tag.sw_rdesc);
+        }
+    }
+
+    ucs_list_for_each_safe(rdesc, tmp, &sw->tm.unexpected.all,
+                           tag_list[UCP_RDESC_ALL_LIST]) {
+        ucp_tag_unexp_remove(rdesc);
+        ucp_recv_desc_release(rdesc);
+    }
+
+    ucp_tag_match_cleanup(&sw->tm);
+    ucs_free(sw);
+}
+
+void ucp_tag_offload_sw_push(ucp_tag_offload_sw_t *sw,
+                             ucp_tag_offload_sw_ev_type_t type, void *arg)
+{
+    uint32_t head = sw->head;
+    ucp_tag_offload_sw_ev_t *ev;
+
+    /* The ring is full, wait for the helper thread to catch up */
+    while (ucs_unlikely((uint32_t)(head - sw->tail) >=
+                        UCP_TAG_OFFLOAD_SW_RING_SIZE)) {
+        sched_yield();
+    }
+
+    ev       = &sw->ring[head & (UCP_TAG_OFFLOAD_SW_RING_SIZE - 1)];
+    ev->type = type;
+    ev->arg  = arg;
+
+    ucs_memory_cpu_store_fence();
+    sw->head = head + 1;
+}
+
+ucp_tag_match_t *ucp_tag_offload_sw_pause(ucp_tag_offload_sw_t *sw)
+{
+    ucp_tag_offload_sw_push(sw, UCP_TAG_OFFLOAD_SW_EV_PAUSE, NULL);
+    while (!sw->paused) {
+        ucs_arch_wait_mem((void*)&sw->paused);
+    }
+
+    ucs_memory_cpu_load_fence();
+    return &sw->tm;
+}
+
+void ucp_tag_offload_sw_resume(ucp_tag_offload_sw_t *sw)
+{
+    ucs_assert(sw->paused);
+    ucs_memory_cpu_store_fence();
+    sw->paused = 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCP_TAG_OFFLOAD_SW_H_
+#define UCP_TAG_OFFLOAD_SW_H_
+
+#include <ucp/tag/tag_match.h>
+#include <ucp/core/ucp_worker.h>
+#include <ucs/arch/cpu.h>
+#include <pthread.h>
+
+
+/* Size of the worker-to-helper event ring, must be a power of 2 */
+#define UCP_TAG_OFFLOAD_SW_RING_SIZE    4096
+
+/* Maximal number of events the helper thread matches in one batch */
+#define UCP_TAG_OFFLOAD_SW_BATCH        64
+
+
+/**
+ * Events passed from the worker to the matching thread
+ */
+typedef enum {
+    UCP_TAG_OFFLOAD_SW_EV_POST,      /* Expected receive was posted */
+    UCP_TAG_OFFLOAD_SW_EV_ARRIVE,    /* Message header arrived */
+    UCP_TAG_OFFLOAD_SW_EV_CANCEL,    /* Expected receive was canceled */
+    UCP_TAG_OFFLOAD_SW_EV_PAUSE      /* Worker needs the unexpected queue */
+} ucp_tag_offload_sw_ev_type_t;
+
+
+/**
+ * Worker-to-helper event
+ */
+typedef struct {
+    ucp_tag_offload_sw_ev_type_t  type;
+    void                          *arg;  /* Request or receive descriptor */
+} ucp_tag_offload_sw_ev_t;
+
+
+/**
+ * Software tag matching engine, used when the transports have no tag matching
+ * offload. Expected receives and arrived headers are handed off to a helper
+ * thread through a single-producer/single-consumer ring, and matched there
+ * against a private tag-matching context. Matches are returned through a
+ * lock-free list, which is drained from the worker progress, so the worker
+ * thread only completes the matched requests.
+ */
+typedef struct ucp_tag_offload_sw {
+    ucp_worker_h              worker;
+    pthread_t                 thread;
+    volatile int              stop;
+    volatile int              paused;    /* Helper thread is parked */
+    uct_worker_cb_id_t        prog_id;
+
+    /* Worker-to-helper ring; head is written by the worker only, tail is
+     * written by the helper thread only */
+    volatile uint32_t         head UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+    volatile uint32_t         tail UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+    ucp_tag_offload_sw_ev_t   ring[UCP_TAG_OFFLOAD_SW_RING_SIZE];
+
+    /* Helper-to-worker stack of matched requests, linked through recv.queue.
+     * The matched descriptor is in recv.tag.sw_rdesc, NULL if canceled. */
+    volatile uint64_t         results UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+
+    /* Private tag matching context, owned by the helper thread */
+    ucp_tag_match_t           tm UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+} ucp_tag_offload_sw_t;
+
+
+ucs_status_t ucp_tag_offload_sw_init(ucp_worker_h worker);
+
+void ucp_tag_offload_sw_cleanup(ucp_worker_h worker);
+
+void ucp_tag_offload_sw_push(ucp_tag_offload_sw_t *sw,
+                             ucp_tag_offload_sw_ev_type_t type, void *arg);
+
+ucp_tag_match_t *ucp_tag_offload_sw_pause(ucp_tag_offload_sw_t *sw);
+
+void ucp_tag_offload_sw_resume(ucp_tag_offload_sw_t *sw);
+
+
+/**
+ * @brief Get exclusive access to the unexpected queue of the worker
+ *
+ * If software tag offload is enabled, the unexpected messages are kept by the
+ * helper thread, so it is parked until @ref ucp_tag_offload_sw_unexp_put is
+ * called.
+ *
+ * @param [in]  worker   UCP worker.
+ *
+ * @return Tag matching context which holds the unexpected queue.
+ */
+static UCS_F_ALWAYS_INLINE ucp_tag_match_t*
+ucp_tag_offload_sw_unexp_get(ucp_worker_h worker)
+{
+    if (ucs_likely(worker->tm.offload.sw == NULL)) {
+        return &worker->tm;
+    }
+
+    return ucp_tag_offload_sw_pause(worker->tm.offload.sw);
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_offload_sw_unexp_put(ucp_worker_h worker)
+{
+    if (ucs_unlikely(worker->tm.offload.sw != NULL)) {
+        ucp_tag_offload_sw_resume(worker->tm.offload.sw);
+    }
+}
+
+#endif
@@ -23,6 +23,7 @@ UCS_PROFILE_FUNC(ucp_tag_message_h, ucp_tag_probe_nb,
 {
     ucp_context_h UCS_V_UNUSED context = worker->context;
     ucp_recv_desc_t *rdesc;
+    ucp_tag_match_t *tm;
     uint16_t flags;
 
     UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
@@ -32,7 +33,8 @@ UCS_PROFILE_FUNC(ucp_tag_message_h, ucp_tag_probe_nb,
     ucs_trace_req("probe_nb tag %"PRIx64"/%"PRIx64" remove=%d", tag, tag_mask,
                   rem);
 
-    rdesc = ucp_tag_unexp_search(&worker->tm, tag, tag_mask, rem, "probe");
+    tm    = ucp_tag_offload_sw_unexp_get(worker);
+    rdesc = ucp_tag_unexp_search(tm, tag, tag_mask, rem, "probe");
     if (rdesc != NULL) {
         flags            = rdesc->flags;
         info->sender_tag = ucp_rdesc_get_tag(rdesc);
@@ -47,6 +49,8 @@ UCS_PROFILE_FUNC(ucp_tag_message_h, ucp_tag_probe_nb,
         }
     }
 
+    ucp_tag_offload_sw_unexp_put(worker);
+
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
 
     return rdesc;
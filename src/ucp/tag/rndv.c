@@ -41,28 +41,12 @@ static int ucp_rndv_is_recv_pipeline_needed(ucp_request_t *rndv_req,
 void ucp_rndv_complete_send(ucp_request_t *sreq, ucs_status_t status,
                             const char *debug_status)
 {
-    ucp_worker_h worker;
-    khiter_t iter;
-
     ucp_request_send_generic_dt_finish(sreq);
     ucp_request_send_buffer_dereg(sreq);
     if (sreq->flags & UCP_REQUEST_FLAG_CANCELED) {
         ucs_list_del(&sreq->send.list);
     }
 
-    /* remove from rndv sreqs hash */
-    worker = sreq->send.ep->worker;
-    iter = kh_get(ucp_worker_rndv_req_ptrs, &worker->rndv_req_ptrs,
-                  sreq->send.rndv_req_id);
-    if (iter != kh_end(&worker->rndv_req_ptrs)) {
-        kh_del(ucp_worker_rndv_req_ptrs, &worker->rndv_req_ptrs, iter);
-        ucs_debug("removed sreq %p, key %zu, worker %p",
-                  sreq, sreq->send.rndv_req_id, worker);
-    } else {
-        ucs_warn("sreq %p (req_id = %zu) does not exist on worker %p",
-                 sreq, sreq->send.rndv_req_id, worker);
-    }
-
     ucp_send_request_update_data(sreq, debug_status);
     ucp_request_complete_send(sreq, status);
 }
@@ -163,15 +147,12 @@ void ucp_rndv_print_debug_data(ucp_worker_h worker, const char *filename,
     }
 }
 
-size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
+size_t ucp_rndv_rts_pack(ucp_request_t *sreq, ucp_rndv_rts_hdr_t *rndv_rts_hdr)
 {
-    ucp_request_t *sreq              = arg;   /* send request */
-    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
-    ucp_worker_h worker              = sreq->send.ep->worker;
+    ucp_worker_h worker = sreq->send.ep->worker;
     ssize_t packed_rkey_size;
 
-    rndv_rts_hdr->super.tag        = sreq->send.msg_proto.tag.tag;
-    rndv_rts_hdr->sreq.reqptr      = sreq->send.rndv_req_id;
+    rndv_rts_hdr->sreq.reqptr      = sreq->id;
     rndv_rts_hdr->sreq.ep_ptr      = ucp_request_get_dest_ep_ptr(sreq);
     rndv_rts_hdr->size             = sreq->send.length;
     rndv_rts_hdr->status           = UCS_OK;
@@ -202,8 +183,18 @@ size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
     return sizeof(*rndv_rts_hdr) + packed_rkey_size;
 }
 
-UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rts, (self),
-                 uct_pending_req_t *self)
+size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;   /* send request */
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+
+    rndv_rts_hdr->super.tag = sreq->send.msg_proto.tag.tag;
+    return ucp_rndv_rts_pack(sreq, rndv_rts_hdr);
+}
+
+ucs_status_t ucp_rndv_progress_rts(uct_pending_req_t *self, uint8_t am_id,
+                                   uct_pack_callback_t pack_cb,
+                                   size_t priv_size)
 {
     ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
     ucp_ep_h         ep = sreq->send.ep;
@@ -211,10 +202,12 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rts, (self),
     size_t packed_rkey_size;
     ucs_status_t status;
 
-    /* send the RTS. the pack_cb will pack all the necessary fields in the RTS */
+    /* send the RTS. the pack_cb will pack all the necessary fields in the RTS,
+     * followed by priv_size bytes of protocol-specific data */
     packed_rkey_size = ucp_ep_config(ep)->tag.rndv.rkey_size;
-    status = ucp_do_am_single(self, UCP_AM_ID_RNDV_RTS, ucp_tag_rndv_rts_pack,
-                              sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+    status = ucp_do_am_single(self, am_id, pack_cb,
+                              sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size +
+                              priv_size);
     if (status == UCS_OK) {
         sreq->send.msg_proto.tag.rts_send_seq = worker->rndv_rts_send_seq++;
         if (ucs_unlikely(worker->tm.rndv_debug.queue_length > 0)) {
@@ -239,6 +232,13 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rts, (self),
     }
 }
 
+UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rts, (self),
+                 uct_pending_req_t *self)
+{
+    return ucp_rndv_progress_rts(self, UCP_AM_ID_RNDV_RTS,
+                                 ucp_tag_rndv_rts_pack, 0);
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_cancel, (self),
                  uct_pending_req_t *self)
 {
@@ -251,7 +251,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_cancel, (self),
     sreq->send.lane = ucp_ep_get_am_lane(ep);
 
     rndv_rts_hdr.super.tag   = sreq->send.msg_proto.tag.tag;
-    rndv_rts_hdr.sreq.reqptr = sreq->send.rndv_req_id;
+    rndv_rts_hdr.sreq.reqptr = sreq->id;
     rndv_rts_hdr.sreq.ep_ptr = ucp_request_get_dest_ep_ptr(sreq);
     rndv_rts_hdr.size        = sreq->send.length;
     rndv_rts_hdr.status      = UCS_ERR_CANCELED;
@@ -359,8 +359,6 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
     ucp_ep_h ep = sreq->send.ep;
     ucp_worker_h worker = ep->worker;
     ucs_status_t status;
-    khiter_t khiter;
-    int ret;
 
     ucp_trace_req(sreq, "start_rndv to %s buffer %p length %zu",
                   ucp_ep_peer_name(ep), sreq->send.buffer,
@@ -374,6 +372,9 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
         return status;
     }
 
+    /* the remote side refers to the request by its ID */
+    ucp_request_id_alloc(worker, sreq);
+
     if (ucp_ep_is_tag_offload_enabled(ucp_ep_config(ep))) {
         status = ucp_tag_offload_start_rndv(sreq);
     } else {
@@ -382,21 +383,10 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
         status              = ucp_tag_rndv_reg_send_buffer(sreq);
     }
 
-    /* add the rndv send request to a hash on the worker. the key is a unique
-     * value on the worker */
-    khiter = kh_put(ucp_worker_rndv_req_ptrs, &worker->rndv_req_ptrs,
-                    sreq->send.rndv_req_id, &ret);
-    if (ret < 1 ) {
-        ucs_warn("failed to add rndv req id (%zu) to worker %p rndv req ptrs hash",
-                 sreq->send.rndv_req_id, worker);
+    if (status != UCS_OK) {
+        ucp_request_id_release(worker, sreq);
     }
 
-    kh_value(&worker->rndv_req_ptrs, khiter) = (uintptr_t)sreq;
-
-    ucs_debug("added sreq %p to hash with key %zu. worker %p",
-              sreq, sreq->send.rndv_req_id, worker);
-
-
     return status;
 }
 
@@ -1206,24 +1196,29 @@ out:
     UCS_ASYNC_UNBLOCK(&worker->async);
 }
 
-static void ucp_rndv_send_cancel_ack(ucp_worker_h worker,
-                                     ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+void ucp_rndv_send_ats(ucp_worker_h worker,
+                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                       ucs_status_t status)
 {
     ucp_request_t *req;
+    ucp_ep_h ep;
 
-    req = ucp_request_get(worker, "rndv_send_cancel_ack");
+    ep = ucp_worker_get_ep_by_ptr(worker, rndv_rts_hdr->sreq.ep_ptr);
+    if (ep == NULL) {
+        return;
+    }
+
+    req = ucp_request_get(worker, "rndv_send_ats");
     if (req == NULL) {
         return;
     }
 
-    req->send.ep           = ucp_worker_get_ep_by_ptr(worker,
-                                                      rndv_rts_hdr->sreq.ep_ptr);
+    req->send.ep           = ep;
     req->flags             = 0;
     req->send.mdesc        = NULL;
     req->send.pending_lane = UCP_NULL_LANE;
 
-    ucp_rndv_req_send_ats(req, NULL, rndv_rts_hdr->sreq.reqptr,
-                          UCS_ERR_CANCELED);
+    ucp_rndv_req_send_ats(req, NULL, rndv_rts_hdr->sreq.reqptr, status);
 }
 
 static void ucp_rndv_unexp_cancel(ucp_worker_h worker,
@@ -1234,6 +1229,7 @@ static void ucp_rndv_unexp_cancel(ucp_worker_h worker,
     ucp_tag_rndv_debug_entry_t *entry;
     ucp_recv_desc_t *rdesc;
     ucs_list_link_t *list;
+    ucp_tag_match_t *tm;
     uint64_t req_id;
 
     req_id = worker->rndv_req_id++;
@@ -1250,7 +1246,8 @@ static void ucp_rndv_unexp_cancel(ucp_worker_h worker,
          entry->size           = rndv_rts_hdr->size;
     }
 
-    list = ucp_tag_unexp_get_list_for_tag(&worker->tm, rndv_rts_hdr->super.tag);
+    tm   = ucp_tag_offload_sw_unexp_get(worker);
+    list = ucp_tag_unexp_get_list_for_tag(tm, rndv_rts_hdr->super.tag);
     ucs_list_for_each(rdesc, list, tag_list[UCP_RDESC_HASH_LIST]) {
         rdesc_rts_hdr = (const void*)(rdesc + 1);
          if ((rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) &&
@@ -1262,11 +1259,13 @@ static void ucp_rndv_unexp_cancel(ucp_worker_h worker,
                            "tag %"PRIx64, UCP_RECV_DESC_ARG(rdesc),
                            ucp_rdesc_get_tag(rdesc));
              ucp_tag_unexp_remove(rdesc);
-             ucp_rndv_send_cancel_ack(worker, rndv_rts_hdr);
+             ucp_rndv_send_ats(worker, rndv_rts_hdr, UCS_ERR_CANCELED);
              ucp_recv_desc_release(rdesc);
-             return;
+             break;
          }
      }
+
+    ucp_tag_offload_sw_unexp_put(worker);
 }
 
 ucs_status_t ucp_rndv_process_rts(void *arg, void *data, size_t length,
@@ -1325,22 +1324,17 @@ ucs_status_t ucp_rndv_process_rts(void *arg, void *data, size_t length,
     return status;
 }
 
-static inline ucp_request_t *ucp_rndv_get_sreq_by_reqptr(ucp_worker_h worker,
-                                                         uintptr_t reqid)
+static UCS_F_ALWAYS_INLINE ucp_request_t*
+ucp_rndv_get_sreq_by_id(ucp_worker_h worker, uint64_t sreq_id)
 {
-    uintptr_t sreq;
-    khiter_t iter;
+    ucp_request_t *sreq = ucp_request_get_by_id(worker, sreq_id);
 
-    /* FIXME rndv offload operations will get here too but their reqptr
-     * will not be found in the hash since their req_id was not used */
-    iter = kh_get(ucp_worker_rndv_req_ptrs, &worker->rndv_req_ptrs, reqid);
-    if (iter == kh_end(&worker->rndv_req_ptrs)) {
-        ucs_warn("reqid %zu does not exist on worker %p", reqid, worker);
-        return NULL;
+    if (ucs_unlikely(sreq == NULL)) {
+        ucs_warn("sreq id 0x%"PRIx64" does not exist on worker %p", sreq_id,
+                 worker);
     }
 
-    sreq = kh_value(&worker->rndv_req_ptrs, iter);
-    return (ucp_request_t*) sreq;
+    return sreq;
 }
 
 UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rts_handler,
@@ -1358,7 +1352,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_ats_handler,
     ucp_worker_h worker = arg;
     ucp_request_t *sreq;
 
-    sreq = ucp_rndv_get_sreq_by_reqptr(worker, rep_hdr->reqptr);
+    sreq = ucp_rndv_get_sreq_by_id(worker, rep_hdr->reqptr);
     if (sreq == NULL) {
         return UCS_OK;
     }
@@ -1735,10 +1729,8 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_atp_handler,
     ucp_ep_h mem_type_ep;
     size_t frag_size, frag_offset;
 
-    req = ucp_rndv_get_sreq_by_reqptr((ucp_worker_h)arg, rep_hdr->reqptr);
-    if (req == NULL) {
-        return UCS_OK;
-    }
+    /* ATP carries the pointer of the receive request, like the rndv data */
+    req = (ucp_request_t*)rep_hdr->reqptr;
 
     if (req->recv.frag.rreq) {
         /* atp for fragmented rndv request */
@@ -1798,7 +1790,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
     ucs_status_t status;
     int is_pipeline_rndv;
 
-    sreq = ucp_rndv_get_sreq_by_reqptr((ucp_worker_h)arg, rndv_rtr_hdr->sreq_ptr);
+    sreq = ucp_rndv_get_sreq_by_id((ucp_worker_h)arg, rndv_rtr_hdr->sreq_ptr);
     if (sreq == NULL) {
         return UCS_OK;
     }
@@ -1983,14 +1975,14 @@ static void ucp_rndv_dump(ucp_worker_h worker, uct_am_trace_type_t type,
 
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTS, ucp_rndv_rts_handler,
               ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATS, ucp_rndv_ats_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATP, ucp_rndv_atp_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTR, ucp_rndv_rtr_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_DATA, ucp_rndv_data_handler,
-              ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_ATS, ucp_rndv_ats_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_ATP, ucp_rndv_atp_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_RTR, ucp_rndv_rtr_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_DATA, ucp_rndv_data_handler, ucp_rndv_dump, 0);
 
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_RTS);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_ATS);
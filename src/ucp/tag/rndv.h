@@ -10,6 +10,7 @@
 #include "tag_match.h"
 
 #include <ucp/api/ucp.h>
+#include <ucp/core/ucp_am.h>
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_ep.inl>
 
@@ -18,7 +19,10 @@
  * Rendezvous RTS
  */
 typedef struct {
-    ucp_tag_hdr_t             super;
+    union {
+        ucp_tag_hdr_t         super;    /* tag, if sent by tag send */
+        ucp_am_hdr_t          am;       /* AM id and flags, if sent by AM send */
+    };
     ucp_request_hdr_t         sreq;     /* send request on the rndv initiator side */
     uint64_t                  address;  /* holds the address of the data buffer on the sender's side */
     size_t                    size;     /* size of the data for sending */
@@ -63,8 +67,18 @@ ucs_status_t ucp_rndv_progress_rma_get_zcopy(uct_pending_req_t *self);
 ucs_status_t ucp_rndv_process_rts(void *arg, void *data, size_t length,
                                   unsigned tl_flags);
 
+size_t ucp_rndv_rts_pack(ucp_request_t *sreq, ucp_rndv_rts_hdr_t *rndv_rts_hdr);
+
 size_t ucp_tag_rndv_rts_pack(void *dest, void *arg);
 
+ucs_status_t ucp_rndv_progress_rts(uct_pending_req_t *self, uint8_t am_id,
+                                   uct_pack_callback_t pack_cb,
+                                   size_t priv_size);
+
+void ucp_rndv_send_ats(ucp_worker_h worker,
+                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                       ucs_status_t status);
+
 ucs_status_t ucp_tag_rndv_reg_send_buffer(ucp_request_t *sreq);
 
 void ucp_ep_complete_rndv_reqs(ucp_ep_h ep);
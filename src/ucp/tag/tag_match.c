@@ -59,6 +59,7 @@ ucs_status_t ucp_tag_match_init(ucp_context_h context, ucp_tag_match_t *tm)
     tm->offload.thresh       = SIZE_MAX;
     tm->offload.zcopy_thresh = SIZE_MAX;
     tm->offload.iface        = NULL;
+    tm->offload.sw           = NULL;
     return UCS_OK;
 }
 
@@ -73,15 +74,33 @@ void ucp_tag_match_cleanup(ucp_tag_match_t *tm)
 
 int ucp_tag_unexp_is_empty(ucp_tag_match_t *tm)
 {
-    return ucs_list_is_empty(&tm->unexpected.all);
+    ucp_tag_offload_sw_t *sw = tm->offload.sw;
+    int is_empty;
+
+    if (sw == NULL) {
+        return ucs_list_is_empty(&tm->unexpected.all);
+    }
+
+    is_empty = ucs_list_is_empty(&ucp_tag_offload_sw_pause(sw)->unexpected.all);
+    ucp_tag_offload_sw_resume(sw);
+    return is_empty;
 }
 
 int ucp_tag_exp_remove(ucp_tag_match_t *tm, ucp_request_t *req)
 {
-    ucp_request_queue_t *req_queue = ucp_tag_exp_get_req_queue(tm, req);
+    ucp_request_queue_t *req_queue;
     ucs_queue_iter_t iter;
     ucp_request_t *qreq;
 
+    if (req->flags & UCP_REQUEST_FLAG_SW_OFFLOADED) {
+        /* The request is owned by the matching thread, which will report
+         * cancellation completion */
+        ucp_tag_offload_sw_push(tm->offload.sw, UCP_TAG_OFFLOAD_SW_EV_CANCEL,
+                                req);
+        return 0;
+    }
+
+    req_queue = ucp_tag_exp_get_req_queue(tm, req);
     ucs_queue_for_each_safe(qreq, iter, &req_queue->queue, recv.queue) {
         if (qreq == req) {
             ucp_tag_offload_try_cancel(req->recv.worker, req, 0);
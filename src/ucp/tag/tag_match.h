@@ -119,6 +119,8 @@ typedef struct ucp_tag_match {
                                                    or not be used with tag-matching
                                                    offload at all, according to
                                                    'thresh' configuration. */
+        struct ucp_tag_offload_sw *sw;          /* Software tag matching engine,
+                                                   NULL if not used */
     } offload;
 
     struct {
@@ -145,4 +147,11 @@ void ucp_tag_frag_list_process_queue(ucp_tag_match_t *tm, ucp_request_t *req,
                                      uint64_t msg_id, uintptr_t ep_ptr
                                      UCS_STATS_ARG(int counter_idx));
 
+ucs_status_t ucp_tag_send_persistent_start(ucp_request_t *req);
+
+ucs_status_t ucp_tag_recv_persistent_start(ucp_request_t *req);
+
+void ucp_tag_recv_unexp_matched(ucp_worker_h worker, ucp_request_t *req,
+                                ucp_recv_desc_t *rdesc);
+
 #endif
@@ -9,6 +9,7 @@
 
 #include "tag_match.h"
 #include "eager.h"
+#include "offload_sw.h"
 
 #include <ucp/tag/offload.h>
 #include <ucp/core/ucp_request.h>
@@ -149,6 +150,12 @@ ucp_tag_unexp_recv(ucp_tag_match_t *tm, ucp_recv_desc_t *rdesc, ucp_tag_t tag)
 {
     ucs_list_link_t *hash_list;
 
+    if (ucs_unlikely(tm->offload.sw != NULL)) {
+        ucp_tag_offload_sw_push(tm->offload.sw, UCP_TAG_OFFLOAD_SW_EV_ARRIVE,
+                                rdesc);
+        return;
+    }
+
     hash_list = ucp_tag_unexp_get_list_for_tag(tm, tag);
     ucs_list_add_tail(hash_list,           &rdesc->tag_list[UCP_RDESC_HASH_LIST]);
     ucs_list_add_tail(&tm->unexpected.all, &rdesc->tag_list[UCP_RDESC_ALL_LIST]);
@@ -65,24 +65,76 @@ ucp_tag_recv_add_debug_entry(ucp_worker_h worker, void *buffer, size_t length,
     entry->send_req       = NULL;
 }
 
+static UCS_F_ALWAYS_INLINE ucs_memory_type_t
+ucp_tag_recv_mem_type(ucp_worker_h worker, const ucp_request_t *req,
+                      uint32_t req_flags, uintptr_t datatype, void *buffer,
+                      size_t length)
+{
+    if (ucs_unlikely(req_flags & UCP_REQUEST_FLAG_PERSISTENT) &&
+        UCP_DT_IS_CONTIG(datatype)) {
+        /* detected once, when the persistent request was initialized */
+        return req->recv.persist.mem_type;
+    }
+
+    return ucp_memory_type_detect(worker->context, buffer, length);
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_recv_process_unexp(ucp_worker_h worker, ucp_request_t *req,
+                           ucp_recv_desc_t *rdesc)
+{
+    ucp_eager_first_hdr_t *eagerf_hdr;
+    ucs_status_t status;
+    uint64_t msg_id;
+
+    /* Check rendezvous case */
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV)) {
+        ucp_rndv_matched(worker, req, (void*)(rdesc + 1), rdesc->rndv_rts_seq);
+        UCP_WORKER_STAT_RNDV(worker, UNEXP);
+        ucp_recv_desc_release(rdesc);
+        return;
+    }
+
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_EAGER_SYNC)) {
+        ucp_tag_eager_sync_send_ack(worker, rdesc + 1, rdesc->flags);
+    }
+
+    UCP_WORKER_STAT_EAGER_MSG(worker, rdesc->flags);
+    ucs_assert(rdesc->flags & UCP_RECV_DESC_FLAG_EAGER);
+    eagerf_hdr                    = (void*)(rdesc + 1);
+    req->recv.tag.info.sender_tag = ucp_rdesc_get_tag(rdesc);
+    req->recv.tag.info.length     =
+    req->recv.tag.remaining       = eagerf_hdr->total_len;
+
+    /* process first fragment */
+    UCP_WORKER_STAT_EAGER_CHUNK(worker, UNEXP);
+    msg_id = eagerf_hdr->msg_id;
+    status = ucp_tag_recv_request_process_rdesc(req, rdesc, 0);
+    ucs_assert((status == UCS_OK) || (status == UCS_INPROGRESS));
+
+    /* process additional fragments */
+    ucp_tag_frag_list_process_queue(&worker->tm, req, msg_id, eagerf_hdr->super.ep_ptr
+                                    UCS_STATS_ARG(UCP_WORKER_STAT_TAG_RX_EAGER_CHUNK_UNEXP));
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_tag_recv_common(ucp_worker_h worker, void *buffer, size_t count,
                     uintptr_t datatype, ucp_tag_t tag, ucp_tag_t tag_mask,
-                    ucp_request_t *req, uint32_t req_flags, ucp_tag_recv_callback_t cb,
+                    ucp_request_t *req, uint32_t req_flags,
+                    ucp_tag_recv_nbx_callback_t cb, void *user_data,
                     ucp_recv_desc_t *rdesc, const char *debug_name)
 {
     unsigned common_flags = UCP_REQUEST_FLAG_RECV | UCP_REQUEST_FLAG_EXPECTED;
-    ucp_eager_first_hdr_t *eagerf_hdr;
     ucp_request_queue_t *req_queue;
     ucs_memory_type_t mem_type;
     size_t hdr_len, recv_len;
     ucs_status_t status;
-    uint64_t msg_id;
 
     ucp_trace_req(req, "%s buffer %p dt 0x%lx count %zu tag %"PRIx64"/%"PRIx64,
                   debug_name, buffer, datatype, count, tag, tag_mask);
 
     /* set request id */
+    req->user_data   = user_data;
     req->recv.req_id = worker->rndv_req_id;
     worker->rndv_req_id++;
 
@@ -110,8 +162,10 @@ ucp_tag_recv_common(ucp_worker_h worker, void *buffer, size_t count,
         recv_len                      = rdesc->length - hdr_len;
         req->recv.tag.info.sender_tag = ucp_rdesc_get_tag(rdesc);
         req->recv.tag.info.length     = recv_len;
-        mem_type                      = ucp_memory_type_detect(worker->context,
-                                                               buffer, recv_len);
+        mem_type                      = ucp_tag_recv_mem_type(worker, req,
+                                                              req_flags,
+                                                              datatype, buffer,
+                                                              recv_len);
 
         status = ucp_dt_unpack_only(worker, buffer, count, datatype, mem_type,
                                     UCS_PTR_BYTE_OFFSET(rdesc + 1, hdr_len),
@@ -119,7 +173,7 @@ ucp_tag_recv_common(ucp_worker_h worker, void *buffer, size_t count,
         ucp_recv_desc_release(rdesc);
 
         if (req_flags & UCP_REQUEST_FLAG_CALLBACK) {
-            cb(req + 1, status, &req->recv.tag.info);
+            cb(req + 1, status, &req->recv.tag.info, user_data);
         }
         ucp_tag_recv_request_completed(worker, req, buffer, status,
                                        &req->recv.tag.info, debug_name);
@@ -141,8 +195,9 @@ ucp_tag_recv_common(ucp_worker_h worker, void *buffer, size_t count,
     req->flags              = common_flags | req_flags;
     req->recv.length        = ucp_dt_length(datatype, count, buffer,
                                             &req->recv.state);
-    req->recv.mem_type      = ucp_memory_type_detect(worker->context, buffer,
-                                                     req->recv.length);
+    req->recv.mem_type      = ucp_tag_recv_mem_type(worker, req, req_flags,
+                                                    datatype, buffer,
+                                                    req->recv.length);
     req->recv.tag.tag       = tag;
     req->recv.tag.tag_mask  = tag_mask;
     req->recv.tag.cb        = cb;
@@ -152,6 +207,16 @@ ucp_tag_recv_common(ucp_worker_h worker, void *buffer, size_t count,
     }
 
     if (ucs_unlikely(rdesc == NULL)) {
+        if (ucs_unlikely(worker->tm.offload.sw != NULL)) {
+            /* Matching is done by the helper thread */
+            req->flags |= UCP_REQUEST_FLAG_SW_OFFLOADED;
+            ucp_tag_offload_sw_push(worker->tm.offload.sw,
+                                    UCP_TAG_OFFLOAD_SW_EV_POST, req);
+            ucs_trace_req("%s returning sw offloaded request %p (%p)",
+                          debug_name, req, req + 1);
+            return;
+        }
+
         /* If not found on unexpected, wait until it arrives.
          * If was found but need this receive request for later completion, save it */
         req_queue = ucp_tag_exp_get_queue(&worker->tm, tag, tag_mask);
@@ -167,34 +232,7 @@ ucp_tag_recv_common(ucp_worker_h worker, void *buffer, size_t count,
         return;
     }
 
-    /* Check rendezvous case */
-    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV)) {
-        ucp_rndv_matched(worker, req, (void*)(rdesc + 1), rdesc->rndv_rts_seq);
-        UCP_WORKER_STAT_RNDV(worker, UNEXP);
-        ucp_recv_desc_release(rdesc);
-        return;
-    }
-
-    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_EAGER_SYNC)) {
-        ucp_tag_eager_sync_send_ack(worker, rdesc + 1, rdesc->flags);
-    }
-
-    UCP_WORKER_STAT_EAGER_MSG(worker, rdesc->flags);
-    ucs_assert(rdesc->flags & UCP_RECV_DESC_FLAG_EAGER);
-    eagerf_hdr                    = (void*)(rdesc + 1);
-    req->recv.tag.info.sender_tag = ucp_rdesc_get_tag(rdesc);
-    req->recv.tag.info.length     =
-    req->recv.tag.remaining       = eagerf_hdr->total_len;
-
-    /* process first fragment */
-    UCP_WORKER_STAT_EAGER_CHUNK(worker, UNEXP);
-    msg_id = eagerf_hdr->msg_id;
-    status = ucp_tag_recv_request_process_rdesc(req, rdesc, 0);
-    ucs_assert((status == UCS_OK) || (status == UCS_INPROGRESS));
-
-    /* process additional fragments */
-    ucp_tag_frag_list_process_queue(&worker->tm, req, msg_id, eagerf_hdr->super.ep_ptr
-                                    UCS_STATS_ARG(UCP_WORKER_STAT_TAG_RX_EAGER_CHUNK_UNEXP));
+    ucp_tag_recv_process_unexp(worker, req, rdesc);
 }
 
 UCS_PROFILE_FUNC(ucs_status_t, ucp_tag_recv_nbr,
@@ -212,8 +250,8 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_tag_recv_nbr,
 
     rdesc = ucp_tag_unexp_search(&worker->tm, tag, tag_mask, 1, "recv_nbr");
     ucp_tag_recv_common(worker, buffer, count, datatype, tag, tag_mask,
-                        req, UCP_REQUEST_DEBUG_FLAG_EXTERNAL, NULL, rdesc,
-                        "recv_nbr");
+                        req, UCP_REQUEST_DEBUG_FLAG_EXTERNAL, NULL, NULL,
+                        rdesc, "recv_nbr");
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
     return UCS_OK;
@@ -237,7 +275,9 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_recv_nb,
     if (ucs_likely(req != NULL)) {
         rdesc = ucp_tag_unexp_search(&worker->tm, tag, tag_mask, 1, "recv_nb");
         ucp_tag_recv_common(worker, buffer, count, datatype, tag, tag_mask, req,
-                            UCP_REQUEST_FLAG_CALLBACK, cb, rdesc,"recv_nb");
+                            UCP_REQUEST_FLAG_CALLBACK,
+                            (ucp_tag_recv_nbx_callback_t)cb, NULL, rdesc,
+                            "recv_nb");
         ret = req + 1;
     } else {
         ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
@@ -265,7 +305,9 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_msg_recv_nb,
     if (ucs_likely(req != NULL)) {
         ucp_tag_recv_common(worker, buffer, count, datatype,
                             ucp_rdesc_get_tag(rdesc), UCP_TAG_MASK_FULL, req,
-                            UCP_REQUEST_FLAG_CALLBACK, cb, rdesc, "msg_recv_nb");
+                            UCP_REQUEST_FLAG_CALLBACK,
+                            (ucp_tag_recv_nbx_callback_t)cb, NULL, rdesc,
+                            "msg_recv_nb");
         ret = req + 1;
     } else {
         ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
@@ -275,11 +317,210 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_msg_recv_nb,
     return ret;
 }
 
+static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
+ucp_tag_recv_nbx_inner(ucp_worker_h worker, void *buffer, size_t count,
+                       ucp_tag_t tag, ucp_tag_t tag_mask,
+                       const ucp_request_param_t *param, ucp_request_t *req,
+                       const char *debug_name)
+{
+    ucp_tag_recv_nbx_callback_t cb;
+    ucp_recv_desc_t *rdesc;
+    uintptr_t datatype;
+    uint32_t req_flags;
+    void *user_data;
+
+    if (req == NULL) {
+        req = ucp_request_get(worker, debug_name);
+        if (ucs_unlikely(req == NULL)) {
+            return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        }
+        req_flags = 0;
+    } else {
+        req_flags = UCP_REQUEST_DEBUG_FLAG_EXTERNAL;
+    }
+
+    datatype = (param->op_attr_mask & UCP_OP_ATTR_FIELD_DATATYPE) ?
+               param->datatype : ucp_dt_make_contig(1);
+
+    if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
+        cb         = param->cb.recv;
+        user_data  = (param->op_attr_mask & UCP_OP_ATTR_FIELD_USER_DATA) ?
+                     param->user_data : NULL;
+        req_flags |= UCP_REQUEST_FLAG_CALLBACK;
+    } else {
+        cb         = NULL;
+        user_data  = NULL;
+    }
+
+    rdesc = ucp_tag_unexp_search(&worker->tm, tag, tag_mask, 1, debug_name);
+    ucp_tag_recv_common(worker, buffer, count, datatype, tag, tag_mask, req,
+                        req_flags, cb, user_data, rdesc, debug_name);
+    return req + 1;
+}
+
 UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_recv_nbx,
                  (worker, buffer, count, tag, tag_mask, param),
                  ucp_worker_h worker, void *buffer, size_t count,
                  ucp_tag_t tag, ucp_tag_t tag_mask,
                  const ucp_request_param_t *param)
 {
-    return UCS_STATUS_PTR(UCS_ERR_NOT_IMPLEMENTED);
+    ucp_request_t *req;
+    ucs_status_ptr_t ret;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    req = (param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST) ?
+          ((ucp_request_t*)param->request - 1) : NULL;
+    ret = ucp_tag_recv_nbx_inner(worker, buffer, count, tag, tag_mask, param,
+                                 req, "tag_recv_nbx");
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_tag_recv_nbx_batch,
+                 (worker, elems, num_elems, param, requests),
+                 ucp_worker_h worker, const ucp_tag_batch_elem_t *elems,
+                 size_t num_elems, const ucp_request_param_t *param,
+                 ucs_status_ptr_t *requests)
+{
+    size_t i;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
+                                    return UCS_ERR_INVALID_PARAM);
+    if (ENABLE_PARAMS_CHECK &&
+        (param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST)) {
+        /* a single user request cannot be shared by several operations */
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    for (i = 0; i < num_elems; ++i) {
+        requests[i] = ucp_tag_recv_nbx_inner(worker, elems[i].buffer,
+                                             elems[i].count, elems[i].tag,
+                                             elems[i].tag_mask, param, NULL,
+                                             "tag_recv_nbx_batch");
+    }
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return UCS_OK;
+}
+
+ucs_status_t ucp_tag_recv_persistent_start(ucp_request_t *req)
+{
+    ucp_worker_h worker = req->recv.worker;
+    ucp_tag_t tag       = req->recv.tag.tag;
+    ucp_tag_t tag_mask  = req->recv.tag.tag_mask;
+    ucp_recv_desc_t *rdesc;
+
+    rdesc = ucp_tag_unexp_search(&worker->tm, tag, tag_mask, 1,
+                                 "tag_recv_start");
+    ucp_tag_recv_common(worker, req->recv.buffer, req->recv.persist.dt_count,
+                        req->recv.datatype, tag, tag_mask, req,
+                        UCP_REQUEST_FLAG_PERSISTENT, req->recv.tag.cb,
+                        req->user_data, rdesc, "tag_recv_start");
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        return req->status;
+    }
+
+    if (req->recv.tag.cb != NULL) {
+        req->flags |= UCP_REQUEST_FLAG_CALLBACK;
+    }
+
+    return UCS_INPROGRESS;
+}
+
+void ucp_tag_recv_unexp_matched(ucp_worker_h worker, ucp_request_t *req,
+                                ucp_recv_desc_t *rdesc)
+{
+    size_t recv_len;
+
+    if (!(rdesc->flags & UCP_RECV_DESC_FLAG_EAGER_ONLY)) {
+        ucp_tag_recv_process_unexp(worker, req, rdesc);
+        return;
+    }
+
+    UCS_PROFILE_REQUEST_EVENT(req, "eager_only_match", 0);
+    UCP_WORKER_STAT_EAGER_MSG(worker, rdesc->flags);
+    UCP_WORKER_STAT_EAGER_CHUNK(worker, UNEXP);
+
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_EAGER_SYNC)) {
+        ucp_tag_eager_sync_send_ack(worker, rdesc + 1, rdesc->flags);
+    }
+
+    recv_len                      = rdesc->length - rdesc->payload_offset;
+    req->recv.tag.info.sender_tag = ucp_rdesc_get_tag(rdesc);
+    req->recv.tag.info.length     =
+    req->recv.tag.remaining       = recv_len;
+    ucp_tag_recv_request_process_rdesc(req, rdesc, 0);
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_recv_init_nbx,
+                 (worker, buffer, count, tag, tag_mask, param),
+                 ucp_worker_h worker, void *buffer, size_t count,
+                 ucp_tag_t tag, ucp_tag_t tag_mask,
+                 const ucp_request_param_t *param)
+{
+    ucs_status_ptr_t ret;
+    uintptr_t datatype;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+    if (ENABLE_PARAMS_CHECK &&
+        (param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST)) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    req = ucp_request_get(worker, "tag_recv_init_nbx");
+    if (req == NULL) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    datatype = (param->op_attr_mask & UCP_OP_ATTR_FIELD_DATATYPE) ?
+               param->datatype : ucp_dt_make_contig(1);
+
+    /* the request is created inactive, ucp_request_start() posts it */
+    req->flags                 = UCP_REQUEST_FLAG_PERSISTENT |
+                                 UCP_REQUEST_FLAG_RECV |
+                                 UCP_REQUEST_FLAG_COMPLETED;
+    req->status                = UCS_OK;
+    req->recv.worker           = worker;
+    req->recv.buffer           = buffer;
+    req->recv.datatype         = datatype;
+    req->recv.tag.tag          = tag;
+    req->recv.tag.tag_mask     = tag_mask;
+    req->recv.persist.dt_count = count;
+
+    if (UCP_DT_IS_CONTIG(datatype)) {
+        req->recv.persist.mem_type =
+                ucp_memory_type_detect(worker->context, buffer,
+                                       ucp_contig_dt_length(datatype, count));
+    } else {
+        /* detected on every start */
+        req->recv.persist.mem_type = UCS_MEMORY_TYPE_LAST;
+    }
+
+    if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
+        req->recv.tag.cb = param->cb.recv;
+        req->user_data   = (param->op_attr_mask & UCP_OP_ATTR_FIELD_USER_DATA) ?
+                           param->user_data : NULL;
+    } else {
+        req->recv.tag.cb = NULL;
+        req->user_data   = NULL;
+    }
+
+    ucs_trace_req("recv_init_nbx request %p buffer %p count %zu tag %"PRIx64
+                  "/%"PRIx64, req, buffer, count, tag, tag_mask);
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
 }
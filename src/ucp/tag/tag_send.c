@@ -17,6 +17,7 @@
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucs/datastruct/mpool.inl>
+#include <ucs/time/time.h>
 #include <string.h>
 
 
@@ -301,13 +302,45 @@ out:
     return ret;
 }
 
-UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_nbx,
-                 (ep, buffer, count, tag, param),
-                 ucp_ep_h ep, const void *buffer, size_t count,
-                 ucp_tag_t tag, const ucp_request_param_t *param)
+/* Sample the completion time of a message near the rendezvous threshold, and
+ * every few such messages send it with the other protocol, so the cost of both
+ * protocols keeps being measured */
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_send_rndv_tune(ucp_request_t *req, size_t *rndv_rma_thresh,
+                       size_t *rndv_am_thresh)
+{
+    ucp_ep_rndv_tune_t *tune = &ucp_ep_config(req->send.ep)->tag.rndv.tune;
+    size_t length            = req->send.length;
+    size_t thresh;
+
+    if (ucs_likely(!tune->enabled)) {
+        return;
+    }
+
+    thresh = ucs_min(*rndv_rma_thresh, *rndv_am_thresh);
+    if ((length < (thresh / UCP_EP_RNDV_TUNE_RANGE)) ||
+        ((length / UCP_EP_RNDV_TUNE_RANGE) >= thresh)) {
+        return;
+    }
+
+    if ((++tune->num_sends % UCP_EP_RNDV_TUNE_EXPLORE_INTERVAL) == 0) {
+        if (length >= thresh) {
+            *rndv_rma_thresh = *rndv_am_thresh = SIZE_MAX;
+        } else {
+            *rndv_rma_thresh = *rndv_am_thresh = 0;
+        }
+    }
+
+    req->flags          |= UCP_REQUEST_FLAG_RNDV_TUNE;
+    req->send.tune_start = ucs_get_time();
+}
+
+static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
+ucp_tag_send_nbx_inner(ucp_ep_h ep, const void *buffer, size_t count,
+                       ucp_tag_t tag, const ucp_request_param_t *param,
+                       uint32_t flags, const char *debug_name)
 {
     size_t contig_length = 0;
-    uint32_t flags       = ucp_request_param_flags(param);
     ucs_status_t status;
     ucp_request_t *req;
     ucs_status_ptr_t ret;
@@ -318,16 +351,6 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_nbx,
     size_t rndv_rma_thresh;
     size_t rndv_am_thresh;
 
-    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_TAG,
-                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
-    if (ENABLE_PARAMS_CHECK &&
-        ucs_test_all_flags(flags, UCP_EP_TAG_SEND_FLAG_EAGER |
-                                  UCP_EP_TAG_SEND_FLAG_RNDV)) {
-        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
-    }
-
-    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
-
     ucs_trace_req("send_nbx buffer %p count %zu tag %" PRIx64 " to %s",
                   buffer, count, tag, ucp_ep_peer_name(ep));
 
@@ -337,7 +360,7 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_nbx,
     if (ucs_likely(attr_mask == 0)) {
         status = UCS_PROFILE_CALL(ucp_tag_send_inline, ep, buffer, count, 
                                   ucp_dt_make_contig(1), tag);
-        ucp_request_send_check_status(status, ret, goto out);
+        ucp_request_send_check_status(status, ret, return ret);
         datatype = ucp_dt_make_contig(1);
         contig_length = count;
     } else if (attr_mask == UCP_OP_ATTR_FIELD_DATATYPE) {
@@ -346,22 +369,20 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_nbx,
             contig_length = ucp_contig_dt_length(datatype, count);
             status = UCS_PROFILE_CALL(ucp_tag_send_inline, ep, buffer,
                                       contig_length, datatype, tag);
-            ucp_request_send_check_status(status, ret, goto out);
+            ucp_request_send_check_status(status, ret, return ret);
         }
     } else {
         datatype = ucp_dt_make_contig(1);
     }
 
     if (ucs_unlikely(param->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
-        ret = UCS_STATUS_PTR(UCS_ERR_NO_RESOURCE);
-        goto out;
+        return UCS_STATUS_PTR(UCS_ERR_NO_RESOURCE);
     }
 
     worker = ep->worker;
-    req = ucp_request_get_param(worker, param, "tag_send_nbx",
+    req = ucp_request_get_param(worker, param, debug_name,
                                 {
-                                    ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
-                                    goto out;
+                                    return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
                                 });
 
     if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
@@ -382,16 +403,76 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_nbx,
     }
 
     ucp_tag_send_req_init(req, ep, buffer, datatype, count, tag, 0);
-    ret = ucp_tag_send_req(req, count, &ucp_ep_config(ep)->tag.eager,
-                           rndv_rma_thresh, rndv_am_thresh,
-                           cb, ucp_ep_config(ep)->tag.proto,
-                           !(param->op_attr_mask & UCP_OP_ATTR_FLAG_FAST_CMPL));
+    if (!(flags & (UCP_EP_TAG_SEND_FLAG_EAGER | UCP_EP_TAG_SEND_FLAG_RNDV))) {
+        ucp_tag_send_rndv_tune(req, &rndv_rma_thresh, &rndv_am_thresh);
+    }
 
-out:
+    return ucp_tag_send_req(req, count, &ucp_ep_config(ep)->tag.eager,
+                            rndv_rma_thresh, rndv_am_thresh,
+                            cb, ucp_ep_config(ep)->tag.proto,
+                            !(param->op_attr_mask & UCP_OP_ATTR_FLAG_FAST_CMPL));
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_nbx,
+                 (ep, buffer, count, tag, param),
+                 ucp_ep_h ep, const void *buffer, size_t count,
+                 ucp_tag_t tag, const ucp_request_param_t *param)
+{
+    uint32_t flags = ucp_request_param_flags(param);
+    ucs_status_ptr_t ret;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_TAG,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+    if (ENABLE_PARAMS_CHECK &&
+        ucs_test_all_flags(flags, UCP_EP_TAG_SEND_FLAG_EAGER |
+                                  UCP_EP_TAG_SEND_FLAG_RNDV)) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+    ret = ucp_tag_send_nbx_inner(ep, buffer, count, tag, param, flags,
+                                 "tag_send_nbx");
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
     return ret;
 }
 
+UCS_PROFILE_FUNC(ucs_status_t, ucp_tag_send_nbx_batch,
+                 (worker, elems, num_elems, param, requests),
+                 ucp_worker_h worker, const ucp_tag_batch_elem_t *elems,
+                 size_t num_elems, const ucp_request_param_t *param,
+                 ucs_status_ptr_t *requests)
+{
+    uint32_t flags = ucp_request_param_flags(param);
+    size_t i;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
+                                    return UCS_ERR_INVALID_PARAM);
+    if (ENABLE_PARAMS_CHECK &&
+        ((param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST) ||
+         ucs_test_all_flags(flags, UCP_EP_TAG_SEND_FLAG_EAGER |
+                                   UCP_EP_TAG_SEND_FLAG_RNDV))) {
+        /* a single user request cannot be shared by several operations */
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    /* Take the worker lock once for the whole batch. UCT has no vectored
+     * send interface, so the messages are handed to the transport back to
+     * back, sharing the request pool and ep config cache lines. */
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    for (i = 0; i < num_elems; ++i) {
+        ucs_assertv(elems[i].ep->worker == worker, "ep=%p worker=%p",
+                    elems[i].ep, worker);
+        requests[i] = ucp_tag_send_nbx_inner(elems[i].ep, elems[i].buffer,
+                                             elems[i].count, elems[i].tag,
+                                             param, flags,
+                                             "tag_send_nbx_batch");
+    }
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return UCS_OK;
+}
+
 UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_sync_nbx,
                  (ep, buffer, count, tag, param),
                  ucp_ep_h ep, const void *buffer, size_t count,
@@ -399,3 +480,176 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_sync_nbx,
 {
     return UCS_STATUS_PTR(UCS_ERR_NOT_IMPLEMENTED);
 }
+
+static void ucp_tag_send_persistent_config(ucp_request_t *req)
+{
+    ucp_ep_h ep                   = req->send.ep;
+    const ucp_ep_config_t *config = ucp_ep_config(ep);
+    size_t rndv_rma_thresh, rndv_am_thresh;
+
+    if (req->send.persist.flags & UCP_EP_TAG_SEND_FLAG_EAGER) {
+        rndv_am_thresh = rndv_rma_thresh = SIZE_MAX;
+    } else if (req->send.persist.flags & UCP_EP_TAG_SEND_FLAG_RNDV) {
+        rndv_am_thresh = rndv_rma_thresh = 0;
+    } else {
+        rndv_rma_thresh = config->tag.rndv.rma_thresh;
+        rndv_am_thresh  = config->tag.rndv.am_thresh;
+    }
+
+    req->send.persist.rndv_thresh  =
+            ucp_tag_get_rndv_threshold(req, req->send.persist.dt_count,
+                                       config->tag.eager.max_iov,
+                                       rndv_rma_thresh, rndv_am_thresh);
+    req->send.persist.zcopy_thresh =
+            ucp_proto_get_zcopy_threshold(req, &config->tag.eager,
+                                          req->send.persist.dt_count,
+                                          req->send.persist.rndv_thresh);
+    req->send.persist.cfg_index    = ep->cfg_index;
+
+    ucs_trace_req("persistent tag request(%p) buffer=%p length=%zu "
+                  "rndv_thresh=%zu zcopy_thresh=%zu", req, req->send.buffer,
+                  req->send.length, req->send.persist.rndv_thresh,
+                  req->send.persist.zcopy_thresh);
+}
+
+ucs_status_t ucp_tag_send_persistent_start(ucp_request_t *req)
+{
+    ucp_ep_h ep         = req->send.ep;
+    ucp_worker_h worker = ep->worker;
+    const ucp_ep_config_t *config;
+    ucs_status_t status;
+
+    /* thresholds are recalculated only if the endpoint was reconfigured */
+    if (ucs_unlikely(req->send.persist.cfg_index != ep->cfg_index)) {
+        ucp_tag_send_persistent_config(req);
+    }
+
+    config                      = ucp_ep_config(ep);
+    req->flags                  = UCP_REQUEST_FLAG_PERSISTENT |
+                                  UCP_REQUEST_FLAG_SEND_TAG;
+    req->send.msg_proto.tag.tag = req->send.persist.tag;
+    req->send.lane              = config->tag.lane;
+    req->send.pending_lane      = UCP_NULL_LANE;
+    req->send.rndv_req_id       = worker->rndv_req_id++;
+
+    if (ucs_likely(UCP_DT_IS_CONTIG(req->send.datatype))) {
+        /* keep the cached memory registration */
+        req->send.state.uct_comp.func = NULL;
+    } else {
+        ucp_request_send_state_init(req, req->send.datatype,
+                                    req->send.persist.dt_count);
+    }
+
+    if (ucs_unlikely(worker->tm.rndv_debug.queue_length > 0)) {
+        ucp_tag_send_add_debug_entry(req);
+    }
+
+    status = ucp_request_send_start(req, -1, req->send.persist.zcopy_thresh,
+                                    req->send.persist.rndv_thresh,
+                                    req->send.persist.dt_count,
+                                    &config->tag.eager, config->tag.proto);
+    if (ucs_unlikely(status != UCS_OK)) {
+        if (status == UCS_ERR_NO_PROGRESS) {
+            ucs_assert(req->send.length >= req->send.persist.rndv_thresh);
+            status = ucp_tag_send_start_rndv(req);
+            UCP_EP_STAT_TAG_OP(ep, RNDV);
+        }
+
+        if (status != UCS_OK) {
+            /* leave the request inactive, so it could be started again */
+            req->status  = status;
+            req->flags  |= UCP_REQUEST_FLAG_COMPLETED;
+            return status;
+        }
+    } else {
+        UCP_EP_STAT_TAG_OP(ep, EAGER);
+    }
+
+    status = ucp_request_send(req, 0);
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        ucs_trace_req("persistent send request %p completed, status %s", req,
+                      ucs_status_string(status));
+        return status;
+    }
+
+    if (req->send.cb != NULL) {
+        req->flags |= UCP_REQUEST_FLAG_CALLBACK;
+    }
+
+    return UCS_INPROGRESS;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_init_nbx,
+                 (ep, buffer, count, tag, param),
+                 ucp_ep_h ep, const void *buffer, size_t count,
+                 ucp_tag_t tag, const ucp_request_param_t *param)
+{
+    uint32_t flags = ucp_request_param_flags(param);
+    ucp_worker_h worker = ep->worker;
+    ucs_status_ptr_t ret;
+    uintptr_t datatype;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    datatype = (param->op_attr_mask & UCP_OP_ATTR_FIELD_DATATYPE) ?
+               param->datatype : ucp_dt_make_contig(1);
+
+    if (ENABLE_PARAMS_CHECK &&
+        ((param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST) ||
+         ucs_test_all_flags(flags, UCP_EP_TAG_SEND_FLAG_EAGER |
+                                   UCP_EP_TAG_SEND_FLAG_RNDV))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    if (UCP_DT_IS_GENERIC(datatype)) {
+        /* generic datatype pack state cannot be reused between sends */
+        return UCS_STATUS_PTR(UCS_ERR_UNSUPPORTED);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("send_init_nbx buffer %p count %zu tag %"PRIx64" to %s",
+                  buffer, count, tag, ucp_ep_peer_name(ep));
+
+    req = ucp_request_get(worker, "tag_send_init_nbx");
+    if (req == NULL) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    /* the request is created inactive, ucp_request_start() posts it */
+    req->flags                 = UCP_REQUEST_FLAG_PERSISTENT |
+                                 UCP_REQUEST_FLAG_SEND_TAG |
+                                 UCP_REQUEST_FLAG_COMPLETED;
+    req->status                = UCS_OK;
+    req->send.ep               = ep;
+    req->send.buffer           = (void*)buffer;
+    req->send.datatype         = datatype;
+    req->send.persist.tag      = tag;
+    req->send.persist.dt_count = count;
+    req->send.persist.flags    = flags;
+    ucp_request_send_state_init(req, datatype, count);
+    req->send.length           = ucp_dt_length(datatype, count, buffer,
+                                               &req->send.state.dt);
+    req->send.mem_type         = ucp_memory_type_detect(worker->context,
+                                                        (void*)buffer,
+                                                        req->send.length);
+
+    if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
+        req->send.cb   = param->cb.send;
+        req->user_data = (param->op_attr_mask & UCP_OP_ATTR_FIELD_USER_DATA) ?
+                         param->user_data : NULL;
+    } else {
+        req->send.cb   = NULL;
+        req->user_data = NULL;
+    }
+
+    ucp_tag_send_persistent_config(req);
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
@@ -50,4 +50,27 @@
         return prev; \
     }
 
+/*
+ * 128-bit compare-and-swap of two 64-bit words, ptr must be 16-byte aligned.
+ * The previous value is returned in prev.
+ */
+#define UCS_HAVE_ATOMIC_CSWAP128 1
+
+static inline void ucs_atomic_cswap128(volatile uint64_t *ptr,
+                                       const uint64_t *compare,
+                                       const uint64_t *swap, uint64_t *prev)
+{
+    uint64_t lo = compare[0];
+    uint64_t hi = compare[1];
+
+    asm volatile (
+          "lock cmpxchg16b %2"
+          : "+a" (lo), "+d" (hi), "+m" (*ptr)
+          : "b" (swap[0]), "c" (swap[1])
+          : "memory", "cc");
+
+    prev[0] = lo;
+    prev[1] = hi;
+}
+
 #endif
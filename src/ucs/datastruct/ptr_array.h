@@ -119,6 +119,58 @@ void *ucs_ptr_array_replace(ucs_ptr_array_t *ptr_array, unsigned index, void *ne
                     !__ucs_ptr_array_is_free(_var = (void*)((_ptr_array)->start[_index])))
 
 
+/**
+ * Generation-tagged identifiers of the array values.
+ *
+ * An identifier holds the index of the value in its lower 32 bits, and the
+ * generation of the slot in its upper 32 bits. The generation is kept in the
+ * placeholder of the free slot, and is advanced every time a value is removed,
+ * so an identifier which outlived its value does not refer to the next value
+ * in the same slot. The array must not use placeholders for anything else.
+ */
+#define UCS_PTR_ARRAY_ID_INDEX_BITS  32
+
+
+/**
+ * Insert a pointer to the array and return its identifier.
+ * Complexity: amortized O(1)
+ */
+static UCS_F_ALWAYS_INLINE uint64_t
+ucs_ptr_array_id_insert(ucs_ptr_array_t *ptr_array, void *value)
+{
+    uint32_t generation;
+    unsigned index;
+
+    index = ucs_ptr_array_insert(ptr_array, value, &generation);
+    return ((uint64_t)generation << UCS_PTR_ARRAY_ID_INDEX_BITS) | index;
+}
+
+
+/**
+ * Remove a pointer from the array by its identifier, and advance the
+ * generation of the slot.
+ * Complexity: O(1)
+ */
+static UCS_F_ALWAYS_INLINE void
+ucs_ptr_array_id_remove(ucs_ptr_array_t *ptr_array, uint64_t id)
+{
+    ucs_ptr_array_remove(ptr_array, (uint32_t)id,
+                         (uint32_t)(id >> UCS_PTR_ARRAY_ID_INDEX_BITS) + 1);
+}
+
+
+/**
+ * Retrieve a value from the array by its identifier.
+ * A used slot does not hold its generation, so the caller has to validate the
+ * value against the identifier, e.g. by comparing it with the identifier kept
+ * in the object.
+ * @return        Whether the slot of the identifier holds a value.
+ * Complexity: O(1)
+ */
+#define ucs_ptr_array_id_lookup(_ptr_array, _id, _var) \
+    ucs_ptr_array_lookup(_ptr_array, (uint32_t)(_id), _var)
+
+
 /**
  * Iterate over all valid elements in the array.
  */
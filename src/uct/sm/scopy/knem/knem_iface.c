@@ -49,6 +49,7 @@ static uct_scopy_iface_ops_t uct_knem_iface_ops = {
         .ep_pending_purge         = (uct_ep_pending_purge_func_t)ucs_empty_function,
         .ep_flush                 = uct_scopy_ep_flush,
         .ep_fence                 = uct_sm_ep_fence,
+        .ep_enable_keep_alive     = (uct_ep_enable_keep_alive_func_t)ucs_empty_function_return_unsupported,
         .ep_create                = UCS_CLASS_NEW_FUNC_NAME(uct_knem_ep_t),
         .ep_destroy               = UCS_CLASS_DELETE_FUNC_NAME(uct_knem_ep_t),
         .iface_flush              = uct_scopy_iface_flush,
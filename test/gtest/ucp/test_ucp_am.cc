@@ -123,6 +123,7 @@ protected:
     void do_send_process_data_test(int test_release, uint16_t am_id,
                                    int send_reply);
     void do_send_process_data_iov_test(size_t size);
+    void do_send_process_data_interleaved_test(int num_sends);
     void set_handlers(uint16_t am_id);
     void set_reply_handlers();
 };
@@ -244,6 +245,41 @@ void test_ucp_am::do_send_process_data_iov_test(size_t size)
     }
 }
 
+void test_ucp_am::do_send_process_data_interleaved_test(int num_sends)
+{
+    std::vector<std::vector<char> > bufs;
+    std::vector<ucs_status_ptr_t> sreqs;
+    size_t max_size;
+
+    recv_ams = 0;
+    release  = 0;
+
+    /* Post all messages at once, so fragments of different messages arrive
+     * interleaved; some of them are larger than the biggest pooled buffer */
+    bufs.reserve(num_sends);
+    for (int i = 0; i < num_sends; ++i) {
+        max_size = (i % 16) ? (256 * UCS_KBYTE) : (2 * UCS_MBYTE);
+        bufs.push_back(std::vector<char>(ucs::rand() % max_size + 1));
+        std::fill(bufs.back().begin(), bufs.back().end(),
+                  (char)bufs.back().size());
+
+        sreqs.push_back(ucp_am_send_nb(receiver().ep(), UCP_SEND_ID,
+                                       bufs.back().data(), bufs.back().size(),
+                                       ucp_dt_make_contig(1),
+                                       (ucp_send_callback_t)ucs_empty_function,
+                                       0));
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sreqs.back()));
+    }
+
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+
+    while (recv_ams != num_sends) {
+        progress();
+    }
+}
+
 void test_ucp_am::do_set_am_handler_realloc_test()
 {
     set_handlers(UCP_SEND_ID);
@@ -292,4 +328,376 @@ UCS_TEST_P(test_ucp_am, set_am_handler_realloc)
     do_set_am_handler_realloc_test();
 }
 
+UCS_TEST_P(test_ucp_am, send_process_am_interleaved)
+{
+    set_handlers(UCP_SEND_ID);
+
+    for (int iter = 0; iter < 3; ++iter) {
+        do_send_process_data_interleaved_test(
+                ucs_max(200 / ucs::test_time_multiplier(), 16));
+    }
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_am)
+
+
+class test_ucp_am_rndv : public test_ucp_am {
+public:
+    enum {
+        RNDV_RECV_IN_CB,  /* receive the data from the callback */
+        RNDV_RECV_LATER,  /* keep the descriptor and receive the data later */
+        RNDV_DROP         /* drop the data */
+    };
+
+    virtual void init() {
+        modify_config("RNDV_THRESH", "1024");
+        test_ucp_am::init();
+    }
+
+protected:
+    static ucs_status_t ucp_process_rndv_cb(void *arg, void *data,
+                                            size_t length, ucp_ep_h reply_ep,
+                                            unsigned flags);
+
+    static void recv_data_cb(void *request, ucs_status_t status,
+                             size_t length);
+
+    void recv_data(void *data_desc);
+
+    void do_send_rndv_test(int mode);
+
+    int               m_mode;
+    void              *m_desc;
+    size_t            m_length;
+    unsigned          m_flags;
+    std::vector<char> m_recv_buf;
+    int               m_recv_done;
+    std::vector<void*> m_pending_reqs;
+};
+
+ucs_status_t test_ucp_am_rndv::ucp_process_rndv_cb(void *arg, void *data,
+                                                   size_t length,
+                                                   ucp_ep_h reply_ep,
+                                                   unsigned flags)
+{
+    test_ucp_am_rndv *self = reinterpret_cast<test_ucp_am_rndv*>(arg);
+
+    self->m_desc   = data;
+    self->m_length = length;
+    self->m_flags  = flags;
+    self->recv_ams++;
+
+    if (!(flags & UCP_CB_PARAM_FLAG_RNDV)) {
+        /* eager message, the data is already here */
+        self->m_recv_buf.assign((char*)data, (char*)data + length);
+        self->m_recv_done = 1;
+        return UCS_OK;
+    }
+
+    switch (self->m_mode) {
+    case RNDV_RECV_IN_CB:
+        self->recv_data(data);
+        return UCS_OK;
+    case RNDV_RECV_LATER:
+        return UCS_INPROGRESS;
+    default:
+        return UCS_OK;
+    }
+}
+
+void test_ucp_am_rndv::recv_data_cb(void *request, ucs_status_t status,
+                                    size_t length)
+{
+    EXPECT_UCS_OK(status);
+}
+
+void test_ucp_am_rndv::recv_data(void *data_desc)
+{
+    ucs_status_ptr_t rstatus;
+
+    m_recv_buf.resize(m_length);
+    rstatus = ucp_am_recv_data_nb(receiver().worker(), data_desc,
+                                  m_recv_buf.data(), m_length,
+                                  ucp_dt_make_contig(1), recv_data_cb);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(rstatus));
+    if (rstatus != NULL) {
+        /* the request is completed from the progress of the test */
+        m_pending_reqs.push_back(rstatus);
+    }
+    m_recv_done = 1;
+}
+
+void test_ucp_am_rndv::do_send_rndv_test(int mode)
+{
+    ucs_status_ptr_t sstatus;
+
+    m_mode = mode;
+    ucp_worker_set_am_handler(receiver().worker(), UCP_SEND_ID,
+                              ucp_process_rndv_cb, this,
+                              UCP_AM_FLAG_WHOLE_MSG | UCP_AM_FLAG_RNDV);
+
+    for (size_t size = 1; size <= UCS_MBYTE; size *= 4) {
+        std::vector<char> sbuf(size);
+        ucs::fill_random(sbuf);
+
+        recv_ams    = 0;
+        m_recv_done = 0;
+        m_desc      = NULL;
+        m_recv_buf.clear();
+
+        sstatus = ucp_am_send_nb(sender().ep(), UCP_SEND_ID, sbuf.data(),
+                                 size, ucp_dt_make_contig(1),
+                                 (ucp_send_callback_t)ucs_empty_function, 0);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sstatus));
+
+        while (recv_ams == 0) {
+            progress();
+        }
+
+        EXPECT_EQ(size, m_length);
+        if (size >= (64 * UCS_KBYTE)) {
+            EXPECT_TRUE(m_flags & UCP_CB_PARAM_FLAG_RNDV) << "size " << size;
+        }
+
+        if (m_flags & UCP_CB_PARAM_FLAG_RNDV) {
+            EXPECT_LE(1024u, size);
+            if (mode == RNDV_RECV_LATER) {
+                recv_data(m_desc);
+            }
+        }
+
+        /* the sender completes also if the receiver drops the data */
+        wait(sstatus);
+        for (std::vector<void*>::iterator it = m_pending_reqs.begin();
+             it != m_pending_reqs.end(); ++it) {
+            wait(*it);
+        }
+        m_pending_reqs.clear();
+
+        if (m_recv_done) {
+            EXPECT_EQ(sbuf, m_recv_buf) << "size " << size;
+        } else {
+            EXPECT_EQ(RNDV_DROP, mode);
+        }
+    }
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_process_am)
+{
+    /* handlers without UCP_AM_FLAG_RNDV get the whole message */
+    set_handlers(UCP_SEND_ID);
+    do_send_process_data_test(0, UCP_SEND_ID, 0);
+
+    set_reply_handlers();
+    do_send_process_data_test(0, UCP_SEND_ID, UCP_AM_SEND_REPLY);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_process_am_release)
+{
+    set_handlers(UCP_SEND_ID);
+    do_send_process_data_test(UCP_RELEASE, 0, 0);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_data_in_cb)
+{
+    do_send_rndv_test(RNDV_RECV_IN_CB);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_data_later)
+{
+    do_send_rndv_test(RNDV_RECV_LATER);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, drop)
+{
+    do_send_rndv_test(RNDV_DROP);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_rndv)
+
+
+class test_ucp_am_nbx : public test_ucp_am {
+public:
+    virtual void init() {
+        modify_config("RNDV_THRESH", "65536");
+        test_ucp_am::init();
+    }
+
+protected:
+    static ucs_status_t am_recv_cb(void *arg, const void *header,
+                                   size_t header_length, void *data,
+                                   size_t length,
+                                   const ucp_am_recv_param_t *param);
+
+    static void recv_data_cb(void *request, ucs_status_t status,
+                             size_t length, void *user_data);
+
+    void recv_data(void *data_desc);
+
+    void do_send_nbx_test(size_t header_length, int recv_later,
+                          unsigned flags);
+
+    int               m_recv_later;
+    void              *m_desc;
+    size_t            m_length;
+    uint64_t          m_recv_attr;
+    ucp_ep_h          m_reply_ep;
+    std::vector<char> m_header;
+    std::vector<char> m_recv_buf;
+    size_t            m_recv_length;
+    int               m_recv_done;
+    void              *m_recv_req;
+};
+
+ucs_status_t test_ucp_am_nbx::am_recv_cb(void *arg, const void *header,
+                                         size_t header_length, void *data,
+                                         size_t length,
+                                         const ucp_am_recv_param_t *param)
+{
+    test_ucp_am_nbx *self = reinterpret_cast<test_ucp_am_nbx*>(arg);
+
+    self->m_header.assign((const char*)header,
+                          (const char*)header + header_length);
+    self->m_desc      = data;
+    self->m_length    = length;
+    self->m_recv_attr = param->recv_attr;
+    self->m_reply_ep  = (param->recv_attr & UCP_AM_RECV_ATTR_FIELD_REPLY_EP) ?
+                        param->reply_ep : NULL;
+    self->recv_ams++;
+
+    if (self->m_recv_later) {
+        /* keep the descriptor, both eager and rendezvous */
+        return UCS_INPROGRESS;
+    }
+
+    self->recv_data(data);
+    return UCS_OK;
+}
+
+void test_ucp_am_nbx::recv_data_cb(void *request, ucs_status_t status,
+                                   size_t length, void *user_data)
+{
+    test_ucp_am_nbx *self = reinterpret_cast<test_ucp_am_nbx*>(user_data);
+
+    EXPECT_UCS_OK(status);
+    self->m_recv_length = length;
+    self->m_recv_done   = 1;
+}
+
+void test_ucp_am_nbx::recv_data(void *data_desc)
+{
+    ucp_request_param_t param;
+    ucs_status_ptr_t rstatus;
+
+    param.op_attr_mask     = UCP_OP_ATTR_FIELD_CALLBACK |
+                             UCP_OP_ATTR_FIELD_USER_DATA |
+                             UCP_OP_ATTR_FIELD_RECV_INFO;
+    param.cb.recv_am       = recv_data_cb;
+    param.user_data        = this;
+    param.recv_info.length = &m_recv_length;
+
+    m_recv_buf.resize(m_length);
+    rstatus = ucp_am_recv_data_nbx(receiver().worker(), data_desc,
+                                   m_recv_buf.data(), m_length, &param);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(rstatus));
+    if (rstatus == NULL) {
+        m_recv_done = 1;
+    } else {
+        /* the request is completed from the progress of the test */
+        EXPECT_TRUE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV);
+        m_recv_req = rstatus;
+    }
+}
+
+void test_ucp_am_nbx::do_send_nbx_test(size_t header_length, int recv_later,
+                                       unsigned flags)
+{
+    std::vector<char> header(header_length);
+    ucp_am_handler_param_t hparam;
+    ucp_request_param_t param;
+    ucs_status_ptr_t sstatus;
+
+    m_recv_later = recv_later;
+
+    hparam.field_mask = UCP_AM_HANDLER_PARAM_FIELD_ID |
+                        UCP_AM_HANDLER_PARAM_FIELD_FLAGS |
+                        UCP_AM_HANDLER_PARAM_FIELD_CB |
+                        UCP_AM_HANDLER_PARAM_FIELD_ARG;
+    hparam.id         = UCP_SEND_ID;
+    hparam.flags      = UCP_AM_FLAG_WHOLE_MSG;
+    hparam.cb         = am_recv_cb;
+    hparam.arg        = this;
+    ASSERT_UCS_OK(ucp_worker_set_am_recv_handler(receiver().worker(),
+                                                 &hparam));
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_FLAGS;
+    param.flags        = flags;
+
+    /* short, bcopy, multi-fragment, zero-copy and rendezvous */
+    for (size_t size = 0; size <= UCS_MBYTE; size = (size + 1) * 7) {
+        std::vector<char> sbuf(size);
+        ucs::fill_random(sbuf);
+        ucs::fill_random(header);
+
+        recv_ams      = 0;
+        m_recv_done   = 0;
+        m_recv_length = 0;
+        m_desc        = NULL;
+        m_recv_req    = NULL;
+        m_recv_buf.clear();
+
+        sstatus = ucp_am_send_nbx(sender().ep(), UCP_SEND_ID, header.data(),
+                                  header_length, sbuf.data(), size, &param);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sstatus));
+
+        while (recv_ams == 0) {
+            progress();
+        }
+
+        EXPECT_EQ(header, m_header) << "size " << size;
+        EXPECT_EQ(size, m_length);
+        EXPECT_EQ(!!(flags & UCP_AM_SEND_REPLY), m_reply_ep != NULL);
+        if (size >= UCS_MBYTE) {
+            EXPECT_TRUE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV);
+        }
+
+        if (m_recv_later) {
+            recv_data(m_desc);
+        }
+
+        wait(sstatus);
+        while (!m_recv_done) {
+            progress();
+        }
+        if (m_recv_req != NULL) {
+            ucp_request_free(m_recv_req);
+        }
+
+
+        EXPECT_EQ(size, m_recv_length);
+        EXPECT_EQ(sbuf, m_recv_buf) << "size " << size;
+    }
+}
+
+UCS_TEST_P(test_ucp_am_nbx, send_no_header)
+{
+    do_send_nbx_test(0, 0, 0);
+}
+
+UCS_TEST_P(test_ucp_am_nbx, send_header)
+{
+    do_send_nbx_test(8, 0, 0);
+    do_send_nbx_test(100, 0, 0);
+}
+
+UCS_TEST_P(test_ucp_am_nbx, send_header_reply)
+{
+    do_send_nbx_test(32, 0, UCP_AM_SEND_REPLY);
+}
+
+UCS_TEST_P(test_ucp_am_nbx, recv_data_later)
+{
+    do_send_nbx_test(16, 1, 0);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_nbx)
@@ -183,6 +183,172 @@ void test_ucp_atomic::nb_cswap(entity *e,  size_t max_size, void *memheap_addr,
     }
 }
 
+template <typename T>
+void test_ucp_atomic::nb_vec(entity *e,  size_t max_size, void *memheap_addr,
+                             ucp_rkey_h rkey, std::string& expected_data)
+{
+    static const size_t num_ops = 256;
+    /* few counters, so that many operations hit the same one */
+    size_t num_counters         = ucs_min(max_size / sizeof(T), 16ul);
+    T *counters                 = (T*)memheap_addr;
+    std::vector<T> expected(counters, counters + num_counters);
+    std::vector<T> results(num_ops), expected_results(num_ops);
+    std::vector<ucp_atomic_vec_op_t> ops(num_ops);
+    void *amo_req;
+
+    /* mix of fetching and non-fetching operations on a few counters */
+    for (size_t i = 0; i < num_ops; ++i) {
+        size_t index        = ucs::rand() % num_counters;
+        T value             = (T)ucs::rand() * (T)ucs::rand();
+        T &counter          = expected[index];
+
+        ops[i].remote_addr  = (uintptr_t)&counters[index];
+        ops[i].value        = value;
+        ops[i].result       = &results[i];
+        expected_results[i] = counter;
+
+        switch (i % 4) {
+        case 0:
+            ops[i].opcode = UCP_ATOMIC_FETCH_OP_FADD;
+            counter      += value;
+            break;
+        case 1:
+            ops[i].opcode = UCP_ATOMIC_FETCH_OP_FADD;
+            ops[i].result = NULL;
+            counter      += value;
+            break;
+        case 2:
+            ops[i].opcode = UCP_ATOMIC_FETCH_OP_FXOR;
+            counter      ^= value;
+            break;
+        default:
+            ops[i].opcode = UCP_ATOMIC_FETCH_OP_CSWAP;
+            ops[i].value  = (ucs::rand() % 2) ? counter : ~counter;
+            results[i]    = value; /* swap value */
+            if (ops[i].value == counter) {
+                counter = value;
+            }
+            break;
+        }
+    }
+
+    amo_req = ucp_atomic_vec_nb(e->ep(), &ops[0], num_ops, sizeof(T), rkey,
+                                send_completion);
+    if (UCS_PTR_IS_PTR(amo_req)) {
+        wait(amo_req);
+    } else {
+        ASSERT_UCS_OK(UCS_PTR_STATUS(amo_req));
+    }
+
+    for (size_t i = 0; i < num_ops; ++i) {
+        if (ops[i].result != NULL) {
+            EXPECT_EQ(expected_results[i], results[i]) << "op " << i;
+        }
+    }
+
+    expected_data.assign((char*)&expected[0], num_counters * sizeof(T));
+}
+
+template <typename T>
+void test_ucp_atomic::nbx_bulk_add(entity *e,  size_t max_size,
+                                   void *memheap_addr, ucp_rkey_h rkey,
+                                   std::string& expected_data)
+{
+    size_t count = max_size / sizeof(T);
+    T *counters  = (T*)memheap_addr;
+    std::vector<T> values(count), prev(counters, counters + count);
+    std::vector<T> reply(count);
+    ucp_request_param_t param;
+    void *amo_req;
+
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = (T)ucs::rand() * (T)ucs::rand();
+    }
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_DATATYPE |
+                         UCP_OP_ATTR_FIELD_REPLY_BUFFER;
+    param.datatype     = ucp_dt_make_contig(sizeof(T));
+    param.reply_buffer = &reply[0];
+
+    amo_req = ucp_atomic_op_nbx(e->ep(), UCP_ATOMIC_OP_ADD, &values[0], count,
+                                (uintptr_t)memheap_addr, rkey, &param);
+    if (UCS_PTR_IS_PTR(amo_req)) {
+        wait(amo_req);
+    } else {
+        ASSERT_UCS_OK(UCS_PTR_STATUS(amo_req));
+    }
+
+    expected_data.resize(count * sizeof(T));
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(prev[i], reply[i]) << "counter " << i;
+        ((T*)&expected_data[0])[i] = prev[i] + values[i];
+    }
+}
+
+void test_ucp_atomic::nbx_cswap128(entity *e,  size_t max_size,
+                                   void *memheap_addr, ucp_rkey_h rkey,
+                                   std::string& expected_data)
+{
+    uint64_t *remote = (uint64_t*)memheap_addr;
+    uint64_t prev[2] = { remote[0], remote[1] };
+    uint64_t compare[2], swap[2], swap_in[2];
+    ucp_request_param_t param;
+    ucp_context_attr_t ctx_attr;
+    ucs_status_t status;
+    void *amo_req;
+
+    ASSERT_EQ(0ul, (uintptr_t)memheap_addr % sizeof(compare));
+
+    compare[0] = prev[0];
+    compare[1] = (ucs::rand() % 2) ? prev[1] : ~prev[1];
+    swap[0]    = (uint64_t)ucs::rand() * ucs::rand();
+    swap[1]    = (uint64_t)ucs::rand() * ucs::rand();
+    memcpy(swap_in, swap, sizeof(swap));
+
+    /* use request memory allocated by the user */
+    ctx_attr.field_mask = UCP_ATTR_FIELD_REQUEST_SIZE;
+    status = ucp_context_query(e->ucph(), &ctx_attr);
+    ASSERT_UCS_OK(status);
+    std::vector<char> request(ctx_attr.request_size);
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_DATATYPE |
+                         UCP_OP_ATTR_FIELD_REPLY_BUFFER |
+                         UCP_OP_ATTR_FIELD_REQUEST;
+    param.datatype     = ucp_dt_make_contig(sizeof(compare));
+    param.reply_buffer = swap;
+    param.request      = &request[0] + ctx_attr.request_size;
+
+    amo_req = ucp_atomic_op_nbx(e->ep(), UCP_ATOMIC_OP_CSWAP, compare, 1,
+                                (uintptr_t)memheap_addr, rkey, &param);
+    if (UCS_PTR_IS_PTR(amo_req)) {
+        EXPECT_EQ(param.request, amo_req);
+        while (ucp_request_check_status(amo_req) == UCS_INPROGRESS) {
+            progress();
+        }
+        status = ucp_request_check_status(amo_req);
+    } else {
+        status = UCS_PTR_STATUS(amo_req);
+    }
+
+    expected_data.resize(sizeof(compare));
+    if (status == UCS_ERR_UNSUPPORTED) {
+        /* no active message lane to execute the operation */
+        memcpy(&expected_data[0], prev, sizeof(prev));
+        return;
+    }
+
+    ASSERT_UCS_OK(status);
+    if (compare[1] == prev[1]) {
+        memcpy(&expected_data[0], swap_in, sizeof(swap_in));
+    } else {
+        memcpy(&expected_data[0], prev, sizeof(prev));
+    }
+
+    /* the reply buffer holds the previous value */
+    EXPECT_EQ(prev[0], swap[0]);
+    EXPECT_EQ(prev[1], swap[1]);
+}
+
 template <typename T, typename F>
 void test_ucp_atomic::test(F f, bool malloc_allocate) {
     test_blocking_xfer(static_cast<blocking_send_func_t>(f), 
@@ -256,6 +422,16 @@ UCS_TEST_P(test_ucp_atomic32, atomic_cswap_nb) {
     test<uint32_t>(&test_ucp_atomic32::nb_cswap<uint32_t>, true);
 }
 
+UCS_TEST_P(test_ucp_atomic32, atomic_vec_nb) {
+    test<uint32_t>(&test_ucp_atomic32::nb_vec<uint32_t>, false);
+    test<uint32_t>(&test_ucp_atomic32::nb_vec<uint32_t>, true);
+}
+
+UCS_TEST_P(test_ucp_atomic32, atomic_bulk_add_nbx) {
+    test<uint32_t>(&test_ucp_atomic32::nbx_bulk_add<uint32_t>, false);
+    test<uint32_t>(&test_ucp_atomic32::nbx_bulk_add<uint32_t>, true);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_atomic32)
 
 class test_ucp_atomic64 : public test_ucp_atomic {
@@ -322,6 +498,21 @@ UCS_TEST_P(test_ucp_atomic64, atomic_cswap_nb) {
     test<uint64_t>(&test_ucp_atomic64::nb_cswap<uint64_t>, true);
 }
 
+UCS_TEST_P(test_ucp_atomic64, atomic_vec_nb) {
+    test<uint64_t>(&test_ucp_atomic64::nb_vec<uint64_t>, false);
+    test<uint64_t>(&test_ucp_atomic64::nb_vec<uint64_t>, true);
+}
+
+UCS_TEST_P(test_ucp_atomic64, atomic_bulk_add_nbx) {
+    test<uint64_t>(&test_ucp_atomic64::nbx_bulk_add<uint64_t>, false);
+    test<uint64_t>(&test_ucp_atomic64::nbx_bulk_add<uint64_t>, true);
+}
+
+UCS_TEST_P(test_ucp_atomic64, atomic_cswap128_nbx) {
+    test<uint64_t>(&test_ucp_atomic64::nbx_cswap128, false);
+    test<uint64_t>(&test_ucp_atomic64::nbx_cswap128, true);
+}
+
 #if ENABLE_PARAMS_CHECK
 UCS_TEST_P(test_ucp_atomic64, unaligned_atomic_add) {
     test<uint64_t>(&test_ucp_atomic::unaligned_blocking_add64, false);
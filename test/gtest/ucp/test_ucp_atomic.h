@@ -38,6 +38,17 @@ public:
     void nb_cswap(entity *e,  size_t max_size, void *memheap_addr,
                   ucp_rkey_h rkey, std::string& expected_data);
     
+    template <typename T>
+    void nb_vec(entity *e,  size_t max_size, void *memheap_addr,
+                ucp_rkey_h rkey, std::string& expected_data);
+
+    template <typename T>
+    void nbx_bulk_add(entity *e,  size_t max_size, void *memheap_addr,
+                      ucp_rkey_h rkey, std::string& expected_data);
+
+    void nbx_cswap128(entity *e,  size_t max_size, void *memheap_addr,
+                      ucp_rkey_h rkey, std::string& expected_data);
+
     template <typename T, typename F>
     void test(F f, bool malloc_allocate);
 
@@ -10,7 +10,7 @@
 
 
 class test_ucp_rma : public test_ucp_memheap {
-private:
+protected:
     static void send_completion(void *request, ucs_status_t status){}
 public:
     static ucp_params_t get_ctx_params() {
@@ -89,8 +89,138 @@ public:
     }
 
     void test_message_sizes(blocking_send_func_t func, size_t *msizes, int iters, int is_nbi);
+
+    void map_remote(size_t length, ucp_mem_h *memh_p, uint64_t **address_p,
+                    ucp_rkey_h *rkey_p);
+
+    void unmap_remote(ucp_mem_h memh, ucp_rkey_h rkey);
+
+    void test_vec_xfer(size_t block_size, size_t count, ptrdiff_t remote_stride,
+                       bool is_get, bool is_iov);
 };
 
+void test_ucp_rma::test_vec_xfer(size_t block_size, size_t count,
+                                 ptrdiff_t remote_stride, bool is_get,
+                                 bool is_iov)
+{
+    ptrdiff_t stride = 2 * block_size + 8;
+    std::vector<char> local(stride * count);
+    std::vector<ucp_rma_iov_t> iov(count);
+    ucp_mem_map_params_t params;
+    ucp_mem_attr_t mem_attr;
+    ucs_status_t status;
+    ucp_mem_h memh;
+
+    sender().connect(&receiver(), get_ep_params());
+
+    params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+                        UCP_MEM_MAP_PARAM_FIELD_LENGTH |
+                        UCP_MEM_MAP_PARAM_FIELD_FLAGS;
+    params.address    = NULL;
+    params.length     = remote_stride * count;
+    params.flags      = GetParam().variant | UCP_MEM_MAP_ALLOCATE;
+    status = ucp_mem_map(receiver().ucph(), &params, &memh);
+    ASSERT_UCS_OK(status);
+
+    mem_attr.field_mask = UCP_MEM_ATTR_FIELD_ADDRESS;
+    status = ucp_mem_query(memh, &mem_attr);
+    ASSERT_UCS_OK(status);
+
+    char *remote = (char*)mem_attr.address;
+    ucs::fill_random(&local[0], local.size());
+    ucs::fill_random(remote, remote_stride * count);
+
+    void *rkey_buffer;
+    size_t rkey_buffer_size;
+    status = ucp_rkey_pack(receiver().ucph(), memh, &rkey_buffer,
+                           &rkey_buffer_size);
+    ASSERT_UCS_OK(status);
+
+    ucp_rkey_h rkey;
+    status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffer, &rkey);
+    ASSERT_UCS_OK(status);
+
+    if (is_iov) {
+        /* post the blocks in reverse order */
+        for (size_t i = 0; i < count; ++i) {
+            size_t block          = count - i - 1;
+            iov[i].buffer         = &local[block * stride];
+            iov[i].length         = block_size;
+            iov[i].remote_addr    = (uintptr_t)remote + block * remote_stride;
+        }
+
+        status = is_get ? ucp_get_iov_nbi(sender().ep(), &iov[0], count, rkey) :
+                          ucp_put_iov_nbi(sender().ep(), &iov[0], count, rkey);
+        /* the array may be released after the call returns */
+        memset(&iov[0], 0, iov.size() * sizeof(iov[0]));
+    } else if (is_get) {
+        status = ucp_get_strided_nbi(sender().ep(), &local[0], stride,
+                                     (uintptr_t)remote, remote_stride,
+                                     block_size, count, rkey);
+    } else {
+        status = ucp_put_strided_nbi(sender().ep(), &local[0], stride,
+                                     (uintptr_t)remote, remote_stride,
+                                     block_size, count, rkey);
+    }
+    ASSERT_UCS_OK_OR_INPROGRESS(status);
+
+    flush_worker(sender());
+
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(0, memcmp(&local[i * stride], remote + i * remote_stride,
+                            block_size)) << "block " << i;
+    }
+
+    ucp_rkey_destroy(rkey);
+
+    disconnect(sender());
+
+    ucp_rkey_buffer_release(rkey_buffer);
+    status = ucp_mem_unmap(receiver().ucph(), memh);
+    ASSERT_UCS_OK(status);
+}
+
+void test_ucp_rma::map_remote(size_t length, ucp_mem_h *memh_p,
+                              uint64_t **address_p, ucp_rkey_h *rkey_p)
+{
+    ucp_mem_map_params_t params;
+    ucp_mem_attr_t mem_attr;
+    size_t rkey_buffer_size;
+    void *rkey_buffer;
+    ucs_status_t status;
+
+    params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+                        UCP_MEM_MAP_PARAM_FIELD_LENGTH |
+                        UCP_MEM_MAP_PARAM_FIELD_FLAGS;
+    params.address    = NULL;
+    params.length     = length;
+    params.flags      = GetParam().variant | UCP_MEM_MAP_ALLOCATE;
+    status = ucp_mem_map(receiver().ucph(), &params, memh_p);
+    ASSERT_UCS_OK(status);
+
+    mem_attr.field_mask = UCP_MEM_ATTR_FIELD_ADDRESS;
+    status = ucp_mem_query(*memh_p, &mem_attr);
+    ASSERT_UCS_OK(status);
+
+    *address_p = (uint64_t*)mem_attr.address;
+    memset(*address_p, 0, length);
+
+    status = ucp_rkey_pack(receiver().ucph(), *memh_p, &rkey_buffer,
+                           &rkey_buffer_size);
+    ASSERT_UCS_OK(status);
+
+    status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffer, rkey_p);
+    ucp_rkey_buffer_release(rkey_buffer);
+    ASSERT_UCS_OK(status);
+}
+
+void test_ucp_rma::unmap_remote(ucp_mem_h memh, ucp_rkey_h rkey)
+{
+    ucp_rkey_destroy(rkey);
+    ucs_status_t status = ucp_mem_unmap(receiver().ucph(), memh);
+    ASSERT_UCS_OK(status);
+}
+
 void test_ucp_rma::test_message_sizes(blocking_send_func_t func, size_t *msizes, int iters, int is_nbi)
 {
    int i;
@@ -161,6 +291,153 @@ UCS_TEST_SKIP_COND_P(test_ucp_rma, nb_large, RUNNING_ON_VALGRIND) {
                        sizes, 3, 1);
 }
 
+UCS_TEST_P(test_ucp_rma, strided) {
+    size_t sizes[] = { 8, 100, 1000, 17300, 0};
+
+    for (int i = 0; sizes[i] > 0; i++) {
+        /* gaps in remote memory, and remote contiguous blocks */
+        test_vec_xfer(sizes[i], 50, 3 * sizes[i], false, false);
+        test_vec_xfer(sizes[i], 50, sizes[i], false, false);
+        test_vec_xfer(sizes[i], 50, 3 * sizes[i], true, false);
+        test_vec_xfer(sizes[i], 50, sizes[i], true, false);
+    }
+}
+
+UCS_TEST_P(test_ucp_rma, iov) {
+    size_t sizes[] = { 8, 100, 1000, 17300, 0};
+
+    for (int i = 0; sizes[i] > 0; i++) {
+        test_vec_xfer(sizes[i], 50, 3 * sizes[i], false, true);
+        test_vec_xfer(sizes[i], 50, sizes[i], false, true);
+        test_vec_xfer(sizes[i], 50, 3 * sizes[i], true, true);
+    }
+}
+
+UCS_TEST_P(test_ucp_rma, nbi_small_batch) {
+    const size_t count = 10000;
+    std::vector<uint64_t> values(count);
+    std::vector<uint64_t> fetched(count / 1000);
+    ucp_mem_map_params_t params;
+    ucp_mem_attr_t mem_attr;
+    ucs_status_t status;
+    ucp_mem_h memh;
+
+    sender().connect(&receiver(), get_ep_params());
+
+    params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+                        UCP_MEM_MAP_PARAM_FIELD_LENGTH |
+                        UCP_MEM_MAP_PARAM_FIELD_FLAGS;
+    params.address    = NULL;
+    params.length     = count * sizeof(uint64_t);
+    params.flags      = GetParam().variant | UCP_MEM_MAP_ALLOCATE;
+    status = ucp_mem_map(receiver().ucph(), &params, &memh);
+    ASSERT_UCS_OK(status);
+
+    mem_attr.field_mask = UCP_MEM_ATTR_FIELD_ADDRESS;
+    status = ucp_mem_query(memh, &mem_attr);
+    ASSERT_UCS_OK(status);
+
+    uint64_t *remote = (uint64_t*)mem_attr.address;
+    memset(remote, 0, count * sizeof(uint64_t));
+
+    void *rkey_buffer;
+    size_t rkey_buffer_size;
+    status = ucp_rkey_pack(receiver().ucph(), memh, &rkey_buffer,
+                           &rkey_buffer_size);
+    ASSERT_UCS_OK(status);
+
+    ucp_rkey_h rkey;
+    status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffer, &rkey);
+    ASSERT_UCS_OK(status);
+
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = i + 1;
+        status    = ucp_put_nbi(sender().ep(), &values[i], sizeof(uint64_t),
+                                (uintptr_t)&remote[i], rkey);
+        ASSERT_UCS_OK_OR_INPROGRESS(status);
+
+        if ((i % 1000) == 999) {
+            /* a get issued after a fence observes the preceding puts */
+            status = ucp_worker_fence(sender().worker());
+            ASSERT_UCS_OK(status);
+            status = ucp_get_nbi(sender().ep(), &fetched[i / 1000],
+                                 sizeof(uint64_t), (uintptr_t)&remote[i], rkey);
+            ASSERT_UCS_OK_OR_INPROGRESS(status);
+        }
+    }
+
+    flush_ep(sender());
+
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(i + 1, remote[i]) << "index " << i;
+        if ((i % 1000) == 999) {
+            EXPECT_EQ(i + 1, fetched[i / 1000]) << "index " << i;
+        }
+    }
+
+    ucp_rkey_destroy(rkey);
+
+    disconnect(sender());
+
+    ucp_rkey_buffer_release(rkey_buffer);
+    status = ucp_mem_unmap(receiver().ucph(), memh);
+    ASSERT_UCS_OK(status);
+}
+
+UCS_TEST_P(test_ucp_rma, rkey_flush) {
+    const size_t count   = 1000;
+    const size_t regions = 3;
+    std::vector<uint64_t> values(count);
+    ucp_mem_h memh[regions];
+    uint64_t *remote[regions];
+    ucp_rkey_h rkey[regions];
+    ucs_status_t status;
+    void *request;
+
+    sender().connect(&receiver(), get_ep_params());
+
+    for (size_t r = 0; r < regions; ++r) {
+        map_remote(count * sizeof(uint64_t), &memh[r], &remote[r], &rkey[r]);
+    }
+
+    /* interleave puts to the first two regions, the third one is not used */
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = i + 1;
+        for (size_t r = 0; r < 2; ++r) {
+            status = ucp_put_nbi(sender().ep(), &values[i], sizeof(uint64_t),
+                                 (uintptr_t)&remote[r][i], rkey[r]);
+            ASSERT_UCS_OK_OR_INPROGRESS(status);
+        }
+    }
+
+    request = ucp_ep_rkey_flush_nb(sender().ep(), rkey[2], send_completion);
+    EXPECT_TRUE(request == NULL);
+    EXPECT_UCS_OK(ucp_ep_rkey_flush_test(sender().ep(), rkey[2]));
+
+    request = ucp_ep_rkey_flush_nb(sender().ep(), rkey[0], send_completion);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(request));
+    wait(request);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(i + 1, remote[0][i]) << "index " << i;
+    }
+
+    ucs_time_t deadline = ucs::get_deadline();
+    while (((status = ucp_ep_rkey_flush_test(sender().ep(), rkey[1])) ==
+            UCS_INPROGRESS) && (ucs_get_time() < deadline)) {
+        progress();
+    }
+    ASSERT_UCS_OK(status);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(i + 1, remote[1][i]) << "index " << i;
+    }
+
+    for (size_t r = 0; r < regions; ++r) {
+        unmap_remote(memh[r], rkey[r]);
+    }
+
+    disconnect(sender());
+}
+
 UCS_TEST_P(test_ucp_rma, nonblocking_put_nbi_flush_worker) {
     test_blocking_xfer(static_cast<nonblocking_send_func_t>(&test_ucp_rma::nonblocking_put_nbi),
                        DEFAULT_SIZE, DEFAULT_ITERS,
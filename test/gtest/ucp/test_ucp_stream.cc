@@ -609,8 +609,199 @@ UCS_TEST_P(test_ucp_stream, send_zero_ending_iov_recv_data) {
     }
 }
 
+UCS_TEST_P(test_ucp_stream, worker_poll_edge_triggered) {
+    const unsigned       flags    = UCP_STREAM_POLL_FLAG_EDGE_TRIGGERED;
+    static const size_t  max_eps  = 2;
+    static const size_t  max_iov  = 4;
+    uint64_t             send_data = ucs::rand();
+    ucp_stream_poll_ep_t poll_eps[max_eps];
+    ucp_dt_iov_t         iov[max_iov];
+    ssize_t              count;
+
+    ucp::data_type_desc_t dt_desc(DATATYPE, &send_data, sizeof(send_data));
+
+    for (int iter = 0; iter < 2; ++iter) {
+        /* the endpoint is reported once it becomes ready */
+        wait(stream_send_nb(dt_desc));
+        ucs_time_t deadline = ucs::get_deadline();
+        do {
+            progress();
+            count = ucp_stream_worker_poll(receiver().worker(), poll_eps,
+                                           max_eps, flags);
+        } while ((count == 0) && (ucs_get_time() < deadline));
+        ASSERT_EQ(1l, count);
+        EXPECT_EQ(receiver().ep(), poll_eps[0].ep);
+
+        /* more data does not report it again until it is drained */
+        wait(stream_send_nb(dt_desc));
+        short_progress_loop();
+        count = ucp_stream_worker_poll(receiver().worker(), poll_eps, max_eps,
+                                       flags);
+        EXPECT_EQ(0l, count);
+
+        size_t length = 0;
+        deadline      = ucs::get_deadline();
+        do {
+            progress();
+            count = ucp_stream_recv_data_nb_batch(receiver().ep(), iov,
+                                                  max_iov);
+            ASSERT_LE(0l, count);
+            for (ssize_t i = 0; i < count; ++i) {
+                length += iov[i].length;
+                ucp_stream_data_release(receiver().ep(), iov[i].buffer);
+            }
+        } while ((length < (2 * sizeof(send_data))) &&
+                 (ucs_get_time() < deadline));
+        EXPECT_EQ(2 * sizeof(send_data), length);
+
+        /* drained, nothing to report until new data arrives */
+        count = ucp_stream_worker_poll(receiver().worker(), poll_eps, max_eps,
+                                       flags);
+        EXPECT_EQ(0l, count);
+    }
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_stream)
 
+class test_ucp_stream_rndv : public test_ucp_stream {
+public:
+    virtual void init() {
+        modify_config("RNDV_THRESH", "8192");
+        test_ucp_stream::init();
+
+        /* mix of eager and rendezvous messages */
+        m_msg_sizes.push_back(100);
+        m_msg_sizes.push_back(65536);
+        m_msg_sizes.push_back(10);
+        m_msg_sizes.push_back(65536);
+        m_msg_sizes.push_back(131072);
+
+        m_sbuf.resize(std::accumulate(m_msg_sizes.begin(), m_msg_sizes.end(),
+                                      size_t(0)));
+        for (size_t i = 0; i < m_sbuf.size(); ++i) {
+            m_sbuf[i] = (char)(i * 7 + 13);
+        }
+    }
+
+protected:
+    void send_all(std::vector<void*> &sreqs);
+    void wait_all(std::vector<void*> &sreqs);
+    void do_unexp_recv_test(size_t recv_size);
+
+    std::vector<size_t> m_msg_sizes;
+    std::vector<char>   m_sbuf;
+};
+
+void test_ucp_stream_rndv::send_all(std::vector<void*> &sreqs)
+{
+    size_t offset = 0;
+
+    for (size_t i = 0; i < m_msg_sizes.size(); ++i) {
+        ucp::data_type_desc_t dt_desc(DATATYPE, &m_sbuf[offset],
+                                      m_msg_sizes[i]);
+        void *sreq = stream_send_nb(dt_desc);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+        sreqs.push_back(sreq);
+        offset += m_msg_sizes[i];
+    }
+}
+
+void test_ucp_stream_rndv::wait_all(std::vector<void*> &sreqs)
+{
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+}
+
+void test_ucp_stream_rndv::do_unexp_recv_test(size_t recv_size)
+{
+    std::vector<char>  rbuf(m_sbuf.size(), 'r');
+    std::vector<void*> sreqs;
+    size_t             offset = 0;
+    size_t             length;
+    void               *rreq;
+
+    send_all(sreqs);
+
+    /* let the messages arrive before the receives are posted, so the
+     * rendezvous data is received to an internal buffer */
+    short_progress_loop();
+
+    while (offset < rbuf.size()) {
+        rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[offset],
+                                  ucs_min(recv_size, rbuf.size() - offset),
+                                  DATATYPE, ucp_recv_cb, &length, 0);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+        if (rreq != NULL) {
+            length = wait_stream_recv(rreq);
+        }
+        ASSERT_GT(length, 0ul);
+        offset += length;
+    }
+
+    wait_all(sreqs);
+    EXPECT_EQ(m_sbuf, rbuf);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, exp_recv) {
+    std::vector<char>  rbuf(m_sbuf.size(), 'r');
+    std::vector<void*> sreqs, rreqs;
+    size_t             offset = 0;
+    size_t             length;
+
+    /* every rendezvous lands directly in the posted buffer */
+    for (size_t i = 0; i < m_msg_sizes.size(); ++i) {
+        void *rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[offset],
+                                        m_msg_sizes[i], DATATYPE, ucp_recv_cb,
+                                        &length, UCP_STREAM_RECV_FLAG_WAITALL);
+        ASSERT_TRUE(UCS_PTR_IS_PTR(rreq));
+        rreqs.push_back(rreq);
+        offset += m_msg_sizes[i];
+    }
+
+    send_all(sreqs);
+
+    for (size_t i = 0; i < rreqs.size(); ++i) {
+        EXPECT_EQ(m_msg_sizes[i], wait_stream_recv(rreqs[i]));
+    }
+
+    wait_all(sreqs);
+    EXPECT_EQ(m_sbuf, rbuf);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, unexp_recv) {
+    do_unexp_recv_test(65536);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, unexp_recv_small) {
+    do_unexp_recv_test(1000);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, recv_data) {
+    std::vector<char>  rbuf;
+    std::vector<void*> sreqs;
+    ucs_time_t         deadline = ucs::get_deadline();
+    size_t             length;
+    void               *data;
+
+    send_all(sreqs);
+
+    while ((rbuf.size() < m_sbuf.size()) && (ucs_get_time() < deadline)) {
+        progress();
+        data = ucp_stream_recv_data_nb(receiver().ep(), &length);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(data));
+        if (data != NULL) {
+            rbuf.insert(rbuf.end(), (char*)data, (char*)data + length);
+            ucp_stream_data_release(receiver().ep(), data);
+        }
+    }
+
+    wait_all(sreqs);
+    EXPECT_EQ(m_sbuf, rbuf);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_stream_rndv)
+
 class test_ucp_stream_many2one : public test_ucp_stream_base {
 protected:
     struct request_wrapper_t {
@@ -634,7 +825,7 @@ public:
     static void ucp_send_cb(void *request, ucs_status_t status) {}
     static void ucp_recv_cb(void *request, ucs_status_t status, size_t length) {}
 
-    void do_send_worker_poll_test(ucp_datatype_t dt);
+    void do_send_worker_poll_test(ucp_datatype_t dt, unsigned poll_flags = 0);
     void do_send_recv_test(ucp_datatype_t dt);
 
 protected:
@@ -681,7 +872,8 @@ void test_ucp_stream_many2one::init()
     }
 }
 
-void test_ucp_stream_many2one::do_send_worker_poll_test(ucp_datatype_t dt)
+void test_ucp_stream_many2one::do_send_worker_poll_test(ucp_datatype_t dt,
+                                                        unsigned poll_flags)
 {
     const size_t                   niter = 2018;
     std::vector<request_wrapper_t> sreqs;
@@ -697,17 +889,38 @@ void test_ucp_stream_many2one::do_send_worker_poll_test(ucp_datatype_t dt)
             ucp_stream_poll_ep_t poll_eps[max_eps];
             progress();
             count = ucp_stream_worker_poll(e(m_receiver_idx).worker(),
-                                           poll_eps, max_eps, 0);
+                                           poll_eps, max_eps, poll_flags);
             EXPECT_LE(0, count);
 
             for (ssize_t i = 0; i < count; ++i) {
+                size_t senser_idx = uintptr_t(poll_eps[i].user_data);
+                std::vector<char> &dst = m_recv_data[senser_idx];
+
+                if (poll_flags & UCP_STREAM_POLL_FLAG_EDGE_TRIGGERED) {
+                    /* must drain the endpoint to get it reported again */
+                    const size_t max_iov = 8;
+                    ucp_dt_iov_t iov[max_iov];
+                    ssize_t      n_iov;
+                    while ((n_iov = ucp_stream_recv_data_nb_batch(poll_eps[i].ep,
+                                                                  iov,
+                                                                  max_iov)) > 0) {
+                        for (ssize_t j = 0; j < n_iov; ++j) {
+                            char *rdata = (char*)iov[j].buffer;
+                            dst.insert(dst.end(), rdata,
+                                       rdata + iov[j].length);
+                            total_len -= iov[j].length;
+                            ucp_stream_data_release(poll_eps[i].ep, rdata);
+                        }
+                    }
+                    ASSERT_EQ(0l, n_iov);
+                    continue;
+                }
+
                 char   *rdata;
                 size_t length;
                 while ((rdata = (char *)ucp_stream_recv_data_nb(poll_eps[i].ep,
                                                                 &length)) != NULL) {
                     ASSERT_FALSE(UCS_PTR_IS_ERR(rdata));
-                    size_t senser_idx = uintptr_t(poll_eps[i].user_data);
-                    std::vector<char> &dst = m_recv_data[senser_idx];
                     dst.insert(dst.end(), rdata, rdata + length);
                     total_len -= length;
                     ucp_stream_data_release(poll_eps[i].ep, rdata);
@@ -1022,6 +1235,10 @@ UCS_TEST_P(test_ucp_stream_many2one, send_worker_poll_generic) {
     ucp_dt_destroy(dt);
 }
 
+UCS_TEST_P(test_ucp_stream_many2one, send_worker_poll_edge_triggered) {
+    do_send_worker_poll_test(DATATYPE, UCP_STREAM_POLL_FLAG_EDGE_TRIGGERED);
+}
+
 UCS_TEST_P(test_ucp_stream_many2one, send_recv_nb) {
     do_send_recv_test(DATATYPE);
 }
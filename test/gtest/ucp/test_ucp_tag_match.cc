@@ -9,6 +9,7 @@
 
 #include <common/test_helpers.h>
 extern "C" {
+#include <ucp/core/ucp_ep.inl>
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_types.h>
 }
@@ -61,6 +62,27 @@ protected:
         m_req_status = status;
     }
 
+    static void send_nbx_callback(void *request, ucs_status_t status,
+                                  void *user_data)
+    {
+        send_callback(request, status);
+    }
+
+    static void recv_nbx_callback(void *request, ucs_status_t status,
+                                  const ucp_tag_recv_info_t *info,
+                                  void *user_data)
+    {
+        recv_callback(request, status, const_cast<ucp_tag_recv_info_t*>(info));
+        ++(*(size_t*)user_data);
+    }
+
+    static void counting_recv_nbx_callback(void *request, ucs_status_t status,
+                                           const ucp_tag_recv_info_t *info,
+                                           void *user_data)
+    {
+        ++(*(size_t*)user_data);
+    }
+
     static ucs_status_t m_req_status;
 };
 
@@ -450,6 +472,174 @@ UCS_TEST_P(test_ucp_tag_match, sync_send_unexp) {
     request_release(my_send_req);
 }
 
+UCS_TEST_P(test_ucp_tag_match, send_recv_batch) {
+    static const size_t num_elems = 64;
+    std::vector<uint64_t> send_data(num_elems), recv_data(num_elems, 0);
+    std::vector<ucp_tag_batch_elem_t> send_elems(num_elems);
+    std::vector<ucp_tag_batch_elem_t> recv_elems(num_elems);
+    std::vector<ucs_status_ptr_t> send_reqs(num_elems), recv_reqs(num_elems);
+    ucp_request_param_t param;
+    size_t recv_cb_count = 0;
+    ucs_status_t status;
+
+    for (size_t i = 0; i < num_elems; ++i) {
+        send_data[i]           = 0xdeadbeef00000000ul + i;
+        send_elems[i].ep       = sender().ep();
+        send_elems[i].buffer   = &send_data[i];
+        send_elems[i].count    = sizeof(send_data[i]);
+        send_elems[i].tag      = 0x1337 + i;
+        recv_elems[i].buffer   = &recv_data[i];
+        recv_elems[i].count    = sizeof(recv_data[i]);
+        recv_elems[i].tag      = 0x1337 + i;
+        recv_elems[i].tag_mask = (ucp_tag_t)-1;
+    }
+
+    /* user request memory cannot be shared by the whole batch */
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_REQUEST;
+    status = ucp_tag_recv_nbx_batch(receiver().worker(), &recv_elems[0],
+                                    num_elems, &param, &recv_reqs[0]);
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, status);
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                         UCP_OP_ATTR_FIELD_USER_DATA;
+    param.cb.recv      = recv_nbx_callback;
+    param.user_data    = &recv_cb_count;
+    status = ucp_tag_recv_nbx_batch(receiver().worker(), &recv_elems[0],
+                                    num_elems, &param, &recv_reqs[0]);
+    ASSERT_UCS_OK(status);
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK;
+    param.cb.send      = send_nbx_callback;
+    status = ucp_tag_send_nbx_batch(sender().worker(), &send_elems[0],
+                                    num_elems, &param, &send_reqs[0]);
+    ASSERT_UCS_OK(status);
+
+    for (size_t i = 0; i < num_elems; ++i) {
+        ASSERT_FALSE(UCS_PTR_IS_ERR(send_reqs[i]));
+        if (send_reqs[i] != NULL) {
+            wait((request*)send_reqs[i]);
+            EXPECT_EQ(UCS_OK, ((request*)send_reqs[i])->status);
+            request_release((request*)send_reqs[i]);
+        }
+    }
+
+    for (size_t i = 0; i < num_elems; ++i) {
+        ASSERT_TRUE(UCS_PTR_IS_PTR(recv_reqs[i]));
+        request *rreq = (request*)recv_reqs[i];
+        wait(rreq);
+        EXPECT_EQ(UCS_OK,                rreq->status);
+        EXPECT_EQ(sizeof(uint64_t),      rreq->info.length);
+        EXPECT_EQ(send_elems[i].tag,     rreq->info.sender_tag);
+        request_release(rreq);
+    }
+
+    EXPECT_EQ(num_elems, recv_cb_count);
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCS_TEST_P(test_ucp_tag_match, send_recv_persistent) {
+    static const size_t sizes[]   = { 8, 64 * UCS_KBYTE, 2 * UCS_MBYTE };
+    static const unsigned iters   = 10;
+    static const ucp_tag_t tag    = 0x1337a880u;
+
+    for (size_t s = 0; s < ucs_static_array_size(sizes); ++s) {
+        std::vector<char> send_data(sizes[s]), recv_data(sizes[s]);
+        ucp_request_param_t param;
+        size_t recv_cb_count = 0;
+        void *sreq, *rreq;
+
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                             UCP_OP_ATTR_FIELD_USER_DATA;
+        param.cb.recv      = counting_recv_nbx_callback;
+        param.user_data    = &recv_cb_count;
+        rreq = ucp_tag_recv_init_nbx(receiver().worker(), &recv_data[0],
+                                     recv_data.size(), tag, (ucp_tag_t)-1,
+                                     &param);
+        ASSERT_UCS_PTR_OK(rreq);
+
+        param.op_attr_mask = 0;
+        sreq = ucp_tag_send_init_nbx(sender().ep(), &send_data[0],
+                                     send_data.size(), tag, &param);
+        ASSERT_UCS_PTR_OK(sreq);
+
+        /* not started yet */
+        EXPECT_EQ(UCS_OK, ucp_request_check_status(sreq));
+        EXPECT_EQ(UCS_OK, ucp_request_check_status(rreq));
+
+        for (unsigned i = 0; i < iters; ++i) {
+            std::fill(send_data.begin(), send_data.end(), (char)('a' + i));
+            std::fill(recv_data.begin(), recv_data.end(), 0);
+
+            ucs_status_t rstatus = ucp_request_start(rreq);
+            ASSERT_TRUE((rstatus == UCS_OK) || (rstatus == UCS_INPROGRESS));
+            ucs_status_t sstatus = ucp_request_start(sreq);
+            ASSERT_TRUE((sstatus == UCS_OK) || (sstatus == UCS_INPROGRESS));
+            if (sstatus == UCS_INPROGRESS) {
+                EXPECT_EQ(UCS_ERR_BUSY, ucp_request_start(sreq));
+            }
+
+            while ((ucp_request_check_status(sreq) == UCS_INPROGRESS) ||
+                   (ucp_request_check_status(rreq) == UCS_INPROGRESS)) {
+                progress();
+            }
+
+            EXPECT_EQ(UCS_OK, ucp_request_check_status(sreq));
+            EXPECT_EQ(UCS_OK, ucp_request_check_status(rreq));
+            EXPECT_EQ(send_data, recv_data);
+        }
+
+        /* callback is invoked only for deferred completions */
+        EXPECT_LE(recv_cb_count, iters);
+
+        ucp_request_free(sreq);
+        ucp_request_free(rreq);
+    }
+}
+
+UCS_TEST_P(test_ucp_tag_match, rndv_thresh_adaptive, "RNDV_THRESH_ADAPTIVE=y") {
+    static const size_t max_thresh = UCS_MBYTE;
+    static const unsigned count    = 1000;
+    ucp_ep_config_t *config        = ucp_ep_config(sender().ep());
+    const ucp_ep_rndv_tune_t *tune = &config->tag.rndv.tune;
+    size_t thresh;
+
+    if (!tune->enabled) {
+        UCS_TEST_SKIP_R("rendezvous threshold tuning is disabled");
+    }
+
+    thresh = ucs_min(config->tag.rndv.rma_thresh, config->tag.rndv.am_thresh);
+    if (thresh > max_thresh) {
+        UCS_TEST_SKIP_R("rendezvous threshold is too large");
+    }
+
+    /* Send messages around the threshold, which is moved during the test */
+    for (unsigned i = 0; i < count; ++i) {
+        size_t size = thresh / 2 + ucs::rand() % (thresh * 2);
+        std::vector<char> sendbuf(size), recvbuf(size, 0);
+
+        ucs::fill_random(sendbuf);
+        request *rreq = recv_nb(&recvbuf[0], size, DATATYPE, i,
+                                UCP_TAG_MASK_FULL);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreq));
+        request *sreq = send_nb(&sendbuf[0], size, DATATYPE, i);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(sreq));
+
+        wait(rreq);
+        EXPECT_EQ(UCS_OK, rreq->status);
+        EXPECT_EQ(size, rreq->info.length);
+        EXPECT_EQ(sendbuf, recvbuf);
+        request_release(rreq);
+
+        if (sreq != NULL) {
+            wait_and_validate(sreq);
+        }
+    }
+
+    EXPECT_GT(tune->num_sends, 0u);
+    EXPECT_GE(config->tag.rndv.rma_thresh, tune->min_thresh);
+    EXPECT_GE(config->tag.rndv.am_thresh, tune->min_thresh);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_match)
 
 class test_ucp_tag_match_rndv : public test_ucp_tag_match {
@@ -798,3 +988,143 @@ UCS_TEST_P(test_ucp_tag_match_rndv, bidir_multi_exp_post, "RNDV_THRESH=0") {
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_match_rndv)
+
+class test_ucp_tag_match_sw_offload : public test_ucp_tag_match {
+public:
+    void init() {
+        modify_config("TM_SW_OFFLOAD", "y");
+        test_ucp_tag_match::init();
+    }
+
+protected:
+    ucp_tag_message_h probe_b(ucp_tag_t tag, ucp_tag_t tag_mask, int rem,
+                              ucp_tag_recv_info_t *info) {
+        ucs_time_t timeout = ucs_get_time() + ucs_time_from_sec(10.0);
+        ucp_tag_message_h message;
+
+        do {
+            progress();
+            message = ucp_tag_probe_nb(receiver().worker(), tag, tag_mask, rem,
+                                       info);
+        } while ((message == NULL) && (ucs_get_time() < timeout));
+
+        return message;
+    }
+};
+
+UCS_TEST_P(test_ucp_tag_match_sw_offload, unexp_burst) {
+    static const size_t count = 1000;
+    static const size_t ntags = 8;
+    std::vector<uint64_t> send_data(count);
+    std::vector<request*> sreqs;
+    ucp_tag_recv_info_t info;
+    uint64_t recv_data;
+    ucs_status_t status;
+
+    for (size_t i = 0; i < count; ++i) {
+        send_data[i] = i;
+        request *sreq = send_nb(&send_data[i], sizeof(send_data[i]), DATATYPE,
+                                i % ntags);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(sreq));
+        if (sreq != NULL) {
+            sreqs.push_back(sreq);
+        }
+    }
+
+    short_progress_loop(); /* Receive messages as unexpected */
+
+    /* Messages with the same tag are matched in order */
+    for (size_t t = 0; t < ntags; ++t) {
+        for (size_t i = t; i < count; i += ntags) {
+            recv_data = 0;
+            status    = recv_b(&recv_data, sizeof(recv_data), DATATYPE, t,
+                               UCP_TAG_MASK_FULL, &info);
+            ASSERT_UCS_OK(status);
+            EXPECT_EQ((ucp_tag_t)t, info.sender_tag);
+            EXPECT_EQ(i, recv_data);
+        }
+    }
+
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait_and_validate(sreqs[i]);
+    }
+}
+
+UCS_TEST_P(test_ucp_tag_match_sw_offload, exp_wildcard) {
+    static const size_t count = 100;
+    static const size_t size  = 50000;
+    std::vector<std::vector<char> > sendbufs(count), recvbufs(count);
+    std::vector<request*> rreqs;
+
+    /* Wildcard receives take the messages in order of posting */
+    for (size_t i = 0; i < count; ++i) {
+        sendbufs[i].resize(size);
+        recvbufs[i].resize(size, 0);
+        ucs::fill_random(sendbufs[i]);
+        rreqs.push_back(recv_nb(&recvbufs[i][0], size, DATATYPE, 0, 0));
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreqs.back()));
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        send_b(&sendbufs[i][0], size, DATATYPE, i);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        wait(rreqs[i]);
+        EXPECT_EQ(UCS_OK, rreqs[i]->status);
+        EXPECT_EQ((ucp_tag_t)i, rreqs[i]->info.sender_tag);
+        EXPECT_EQ(sendbufs[i], recvbufs[i]);
+        request_release(rreqs[i]);
+    }
+}
+
+UCS_TEST_P(test_ucp_tag_match_sw_offload, cancel) {
+    uint64_t recv_data = 0;
+    request *req;
+
+    req = recv_nb(&recv_data, sizeof(recv_data), DATATYPE, 1, 1);
+    ASSERT_TRUE(!UCS_PTR_IS_ERR(req));
+    ASSERT_TRUE(req != NULL);
+
+    ucp_request_cancel(receiver().worker(), req);
+    wait(req);
+
+    EXPECT_EQ(UCS_ERR_CANCELED, req->status);
+    EXPECT_EQ(0ul, recv_data);
+    request_release(req);
+}
+
+UCS_TEST_P(test_ucp_tag_match_sw_offload, probe) {
+    static const size_t size = 100000;
+    std::vector<char> sendbuf(size), recvbuf(size, 0);
+    ucp_tag_recv_info_t info;
+    ucp_tag_message_h message;
+    request *sreq, *rreq;
+
+    ucs::fill_random(sendbuf);
+    sreq = send_nb(&sendbuf[0], size, DATATYPE, 0x111337);
+    ASSERT_TRUE(!UCS_PTR_IS_ERR(sreq));
+
+    message = probe_b(0x1337, 0xffff, 0, &info);
+    ASSERT_TRUE(message != NULL);
+    EXPECT_EQ(size, info.length);
+    EXPECT_EQ((ucp_tag_t)0x111337, info.sender_tag);
+
+    message = probe_b(0x1337, 0xffff, 1, &info);
+    ASSERT_TRUE(message != NULL);
+
+    rreq = (request*)ucp_tag_msg_recv_nb(receiver().worker(), &recvbuf[0],
+                                         size, DATATYPE, message,
+                                         recv_callback);
+    ASSERT_TRUE(!UCS_PTR_IS_ERR(rreq));
+    wait(rreq);
+    EXPECT_EQ(UCS_OK, rreq->status);
+    EXPECT_EQ(sendbuf, recvbuf);
+    request_release(rreq);
+
+    if (sreq != NULL) {
+        wait_and_validate(sreq);
+    }
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_match_sw_offload)
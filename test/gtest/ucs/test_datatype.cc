@@ -6,6 +6,7 @@
 
 #include <common/test.h>
 extern "C" {
+#include <ucs/datastruct/khash.h>
 #include <ucs/datastruct/list.h>
 #include <ucs/datastruct/ptr_array.h>
 #include <ucs/datastruct/queue.h>
@@ -18,6 +19,8 @@ extern "C" {
 class test_datatype : public ucs::test {
 };
 
+KHASH_MAP_INIT_INT64(test_datatype_ids, uintptr_t)
+
 typedef struct {
     int               i;
     ucs_list_link_t   list;
@@ -513,6 +516,97 @@ UCS_TEST_SKIP_COND_F(test_datatype, ptr_array_perf,
     }
 }
 
+UCS_TEST_F(test_datatype, ptr_array_id) {
+    ucs_ptr_array_t pa;
+    uint64_t id1, id2;
+    void *ptr;
+    int a = 1, b = 2;
+
+    ucs_ptr_array_init(&pa, 0, "ptr_array test");
+
+    id1 = ucs_ptr_array_id_insert(&pa, &a);
+    EXPECT_TRUE(ucs_ptr_array_id_lookup(&pa, id1, ptr));
+    EXPECT_EQ(&a, ptr);
+    ucs_ptr_array_id_remove(&pa, id1);
+    EXPECT_FALSE(ucs_ptr_array_id_lookup(&pa, id1, ptr));
+
+    /* The slot is reused with another generation */
+    id2 = ucs_ptr_array_id_insert(&pa, &b);
+    EXPECT_NE(id1, id2);
+    EXPECT_EQ(id1 & UCS_MASK(UCS_PTR_ARRAY_ID_INDEX_BITS),
+              id2 & UCS_MASK(UCS_PTR_ARRAY_ID_INDEX_BITS));
+    EXPECT_TRUE(ucs_ptr_array_id_lookup(&pa, id2, ptr));
+    EXPECT_EQ(&b, ptr);
+
+    ucs_ptr_array_id_remove(&pa, id2);
+    ucs_ptr_array_cleanup(&pa);
+}
+
+/* Request ID pattern of rendezvous protocol: a window of outstanding IDs, each
+ * one is looked up by the reply and then released */
+UCS_TEST_SKIP_COND_F(test_datatype, ptr_array_id_perf,
+                     (ucs::test_time_multiplier() > 1)) {
+    const unsigned count  = 10000000;
+    const unsigned window = 1024;
+    std::vector<uint64_t> ids(window);
+    khash_t(test_datatype_ids) khash;
+    ucs_ptr_array_t pa;
+    uintptr_t dummy = 0;
+    khiter_t iter;
+    void *ptr;
+    int ret;
+
+    ucs_ptr_array_init(&pa, 0, "ptr_array test");
+    for (unsigned i = 0; i < window; ++i) {
+        ids[i] = ucs_ptr_array_id_insert(&pa, &dummy);
+    }
+
+    ucs_time_t start_time = ucs_get_time();
+    for (unsigned i = 0; i < count; ++i) {
+        uint64_t &id = ids[i % window];
+        int present  = ucs_ptr_array_id_lookup(&pa, id, ptr);
+        ASSERT_TRUE(present);
+        ucs_ptr_array_id_remove(&pa, id);
+        id = ucs_ptr_array_id_insert(&pa, &dummy);
+    }
+    ucs_time_t ptr_array_time = ucs_get_time() - start_time;
+
+    for (unsigned i = 0; i < window; ++i) {
+        ucs_ptr_array_id_remove(&pa, ids[i]);
+    }
+    ucs_ptr_array_cleanup(&pa);
+
+    kh_init_inplace(test_datatype_ids, &khash);
+    for (unsigned i = 0; i < window; ++i) {
+        iter = kh_put(test_datatype_ids, &khash, i, &ret);
+        kh_value(&khash, iter) = (uintptr_t)&dummy;
+    }
+
+    start_time = ucs_get_time();
+    for (unsigned i = 0; i < count; ++i) {
+        iter = kh_get(test_datatype_ids, &khash, i);
+        ASSERT_TRUE(iter != kh_end(&khash));
+        kh_del(test_datatype_ids, &khash, iter);
+        iter = kh_put(test_datatype_ids, &khash, i + window, &ret);
+        kh_value(&khash, iter) = (uintptr_t)&dummy;
+    }
+    ucs_time_t khash_time = ucs_get_time() - start_time;
+
+    kh_destroy_inplace(test_datatype_ids, &khash);
+
+    double ptr_array_ns = ucs_time_to_nsec(ptr_array_time) / count;
+    double khash_ns     = ucs_time_to_nsec(khash_time) / count;
+
+    UCS_TEST_MESSAGE << "lookup+remove+insert (nsec): ptr_array id "
+                     << ptr_array_ns << " khash " << khash_ns;
+
+    if (ucs::perf_retry_count) {
+        EXPECT_LT(ptr_array_ns, khash_ns);
+    } else {
+        UCS_TEST_MESSAGE << "not validating performance";
+    }
+}
+
 UCS_TEST_F(test_datatype, ptr_status) {
     void *ptr1 = (void*)(UCS_BIT(63) + 10);
     EXPECT_TRUE(UCS_PTR_IS_PTR(ptr1));